@@ -1,26 +1,60 @@
+
 #include <SoftwareSerial.h>
+#include "puente.h"
 
 #define BAUDRATE 38400
 
+// Flujo tipo RTS/CTS con la Raspberry (0 = sin cables extra). Del lado de la
+// Raspberry: CTS en GPIO16 y RTS en GPIO17 (ALT3) y `stty -F /dev/ttyAMA0 crtscts`.
+#define FLUJO    0
+#define PIN_RTS  8   // salida: HIGH = la Raspberry no debe mandar
+#define PIN_CTS  9   // entrada: HIGH = la Raspberry no puede recibir
+#define GUARDA_US 300 // un byte a 38400 más margen: lo que ya estaba saliendo
+
 SoftwareSerial SerialRaspi(10, 11); // pin 10 (RX) - pin 11 (TX)
 
+puente_t puente;
+
+// ---- Puerto de la PC (Serial por hardware) ----
+static int pcDisponibles(void *ctx) { return Serial.available(); }
+static int pcLeer(void *ctx)        { return Serial.read(); }
+static int pcEspacio(void *ctx)     { return Serial.availableForWrite(); }
+static void pcEscribir(void *ctx, const uint8_t *d, int n) { Serial.write(d, n); }
+
+// ---- Puerto de la Raspberry (SoftwareSerial: no recibe mientras transmite) ----
+static int raspiDisponibles(void *ctx) { return SerialRaspi.available(); }
+static int raspiLeer(void *ctx)        { return SerialRaspi.read(); }
+static int raspiEspacio(void *ctx)     { return PUENTE_RAFAGA; }   // write() bloquea: sin cola
+static void raspiEscribir(void *ctx, const uint8_t *d, int n) { SerialRaspi.write(d, n); }
+
+#if FLUJO
+static void raspiPausar(void *ctx, uint8_t pausa) {
+  digitalWrite(PIN_RTS, pausa ? HIGH : LOW);
+  if (pausa)
+    delayMicroseconds(GUARDA_US);
+}
+
+static int raspiDetenida(void *ctx) { return digitalRead(PIN_CTS) == HIGH; }
+#endif
+
 void setup() {
   Serial.begin(BAUDRATE);
   SerialRaspi.begin(BAUDRATE);     // UART hacia Raspberry
 
+  puertoPuente_t pc = { pcDisponibles, pcLeer, pcEspacio, pcEscribir, NULL, NULL, NULL, 0 };
+  puertoPuente_t raspi = { raspiDisponibles, raspiLeer, raspiEspacio, raspiEscribir, NULL, NULL, NULL, 1 };
+
+#if FLUJO
+  pinMode(PIN_RTS, OUTPUT);
+  pinMode(PIN_CTS, INPUT_PULLUP);
+  raspi.pausar = raspiPausar;
+  raspi.detenido = raspiDetenida;
+#endif
+  puente_iniciar(&puente, &pc, &raspi, FLUJO);
+
   Serial.println("Puente serie Arduino <-> Raspberry listo.");
 }
 
 void loop() {
-  // PC -> Raspberry
-  if (Serial.available()) {
-    char c = (char)Serial.read();
-    SerialRaspi.write(c);
-  }
-
-  // Raspberry -> PC
-  if (SerialRaspi.available()) {
-    char c = (char)SerialRaspi.read();
-    Serial.write(c);
-  }
+  puente_atender(&puente);
 }
@@ -0,0 +1,329 @@
+// adc.c
+// Hilo muestreador del potenciómetro (PCF8591): lee a ritmo fijo, filtra con
+// mediana de 5 + media exponencial + histéresis y publica el resultado en
+// atómicos y en un anillo sin locks. La interfaz ya no hace un analogRead()
+// (una transacción I2C) cada vez que redibuja.
+//
+// Con adc_iniciarRafaga() cada período es una sola transferencia por
+// i2c-dev con varios juegos de los cuatro canales (adc_i2c.h); los lotes van
+// a un segundo anillo con un seqlock por casillero.
+#include "adc.h"
+#include "reloj.h"
+#include "telemetria.h"
+
+#include <wiringPi.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#include <sys/eventfd.h>
+
+extern int map(int x, int in_min, int in_max, int out_min, int out_max);
+
+#define MEDIANA 5
+#define EMA_DESP 2   // alfa = 1/4
+#define FRAC 4       // la media se guarda con 4 bits de fracción
+
+static int pinAdc;
+static int periodoMs;
+static int rangoMin, rangoMax;
+
+static _Atomic uint64_t anillo[ADC_MUESTRAS];
+static _Atomic unsigned int escritas = 0;
+static _Atomic int ultimoCrudo = 0;
+static _Atomic int salida = 0;
+
+// Ráfagas (bus == NULL: analogRead de wiringPi)
+static busI2c_t busRafaga;
+static const busI2c_t *bus = NULL;
+static int juegosRafaga;
+static loteAdc_t lotes[ADC_LOTES];
+static _Atomic unsigned int secuenciaLote[ADC_LOTES];   // impar mientras se escribe
+static _Atomic unsigned int lotesEscritos = 0;
+
+static _Atomic int corriendo = 0;
+static pthread_t hilo;
+static int cambioFd = -1;
+
+// Estado del filtro (solo lo toca el hilo muestreador)
+static int ventana[MEDIANA];
+static int cantVentana = 0;
+static int ema = -1;   // con FRAC bits de fracción
+
+static uint64_t empaquetar(uint32_t t, int crudo, int filtrado) {
+    return (uint64_t)t << 32 | (uint64_t)(crudo & 0xFFFF) << 16 | (uint64_t)(filtrado & 0xFFFF);
+}
+
+static int mediana(void) {
+    int v[MEDIANA];
+    memcpy(v, ventana, sizeof(v));
+
+    // Inserción: son 5 valores
+    for (int i = 1; i < cantVentana; i++) {
+        int x = v[i], j = i - 1;
+        while (j >= 0 && v[j] > x) {
+            v[j + 1] = v[j];
+            j--;
+        }
+        v[j + 1] = x;
+    }
+    return v[cantVentana / 2];
+}
+
+// Devuelve 1 si la salida cambió
+static int filtrar(int crudo) {
+    if (cantVentana < MEDIANA) {
+        ventana[cantVentana++] = crudo;
+    } else {
+        memmove(ventana, ventana + 1, (MEDIANA - 1) * sizeof(int));
+        ventana[MEDIANA - 1] = crudo;
+    }
+
+    int m = mediana() << FRAC;
+    if (ema < 0)
+        ema = m;
+    else
+        ema += (m - ema) >> EMA_DESP;
+
+    int anterior = atomic_load_explicit(&salida, memory_order_relaxed);
+    int nuevo = (ema + (1 << (FRAC - 1))) >> FRAC;
+    int dif = nuevo - anterior;
+
+    // Histéresis: los extremos se alcanzan siempre para poder llegar a 0 y 255
+    if (dif >= ADC_HISTERESIS || dif <= -ADC_HISTERESIS ||
+        (nuevo != anterior && (nuevo == 0 || nuevo == 255))) {
+        atomic_store_explicit(&salida, nuevo, memory_order_relaxed);
+        return 1;
+    }
+    return 0;
+}
+
+static uint64_t monotonicoNs(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+static void publicarLote(const loteAdc_t *l) {
+    unsigned int n = atomic_load_explicit(&lotesEscritos, memory_order_relaxed);
+    unsigned int i = n & (ADC_LOTES - 1);
+    unsigned int s = atomic_load_explicit(&secuenciaLote[i], memory_order_relaxed);
+
+    atomic_store_explicit(&secuenciaLote[i], s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    lotes[i] = *l;
+    lotes[i].numero = n;
+    atomic_store_explicit(&secuenciaLote[i], s + 2, memory_order_release);
+    atomic_store_explicit(&lotesEscritos, n + 1, memory_order_release);
+}
+
+// Una ráfaga: publica el lote y devuelve el último canal 0 (-1 si falló el bus)
+static int leerRafaga(void) {
+    loteAdc_t l;
+    uint64_t dur;
+    uint64_t t0 = monotonicoNs();
+
+    if (pcf_rafaga(bus, l.valores, juegosRafaga, &dur) != 0)
+        return -1;
+
+    // Cada juego son 4 bytes de 9 bits; antes van el control, la dirección
+    // de lectura y el byte viejo, más o menos otros 4
+    uint64_t byteNs = dur / (uint64_t)(PCF_CANALES * juegosRafaga + PCF_CANALES);
+    l.juegos    = (uint16_t)juegosRafaga;
+    l.tNs       = t0 + PCF_CANALES * byteNs;
+    l.periodoNs = (uint32_t)(PCF_CANALES * byteNs);
+    publicarLote(&l);
+
+    tele_sumar(&tele->adc.muestras, juegosRafaga - 1);   // tomarMuestra() suma el último
+    return l.valores[juegosRafaga - 1][0];
+}
+
+static void tomarMuestra(void) {
+    uint64_t t0 = tele_ahoraNs();
+    int crudo = bus ? leerRafaga() : analogRead(pinAdc);
+    tele_registrar(&tele->adc.lectura, (long)((tele_ahoraNs() - t0) / 1000));
+    if (crudo < 0)
+        return;   // el próximo período lo vuelve a intentar
+
+    int cambio = filtrar(crudo);
+    tele_sumar(&tele->adc.muestras, 1);
+
+    unsigned int n = atomic_load_explicit(&escritas, memory_order_relaxed);
+    atomic_store_explicit(&anillo[n & (ADC_MUESTRAS - 1)],
+                          empaquetar(millis(), crudo, atomic_load_explicit(&salida, memory_order_relaxed)),
+                          memory_order_relaxed);
+    atomic_store_explicit(&escritas, n + 1, memory_order_release);
+    atomic_store_explicit(&ultimoCrudo, crudo, memory_order_relaxed);
+
+    if (cambio) {
+        uint64_t uno = 1;
+        tele_sumar(&tele->adc.cambios, 1);
+        if (write(cambioFd, &uno, sizeof(uno)) < 0) {
+            // el contador del eventfd no puede desbordar en la práctica
+        }
+    }
+}
+
+static void *hiloMuestreador(void *arg) {
+    (void)arg;
+    relojFrames_t reloj;
+    reloj_iniciar(&reloj);
+
+    while (atomic_load(&corriendo)) {
+        reloj_programar(&reloj, periodoMs);
+        while (!reloj_esperar(&reloj, periodoMs))
+            ;
+        tomarMuestra();
+    }
+    return NULL;
+}
+
+static void cerrarCambio(void) {
+    if (cambioFd >= 0)
+        close(cambioFd);
+    cambioFd = -1;
+}
+
+// Común a los dos modos; la primera muestra se toma acá
+static int arrancar(int hz, int delayMin, int delayMax) {
+    int primera;
+    loteAdc_t l;
+
+    periodoMs = 1000 / hz > 0 ? 1000 / hz : 1;
+    rangoMin  = delayMin;
+    rangoMax  = delayMax;
+
+    cambioFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (cambioFd < 0)
+        return 1;
+
+    // La primera fija la salida (sin lote: es un juego suelto)
+    if (bus) {
+        if (pcf_rafaga(bus, l.valores, 1, NULL) != 0) {
+            cerrarCambio();
+            return 1;
+        }
+        primera = l.valores[0][0];
+    } else {
+        primera = analogRead(pinAdc);
+    }
+
+    cantVentana = 0;
+    ema = -1;
+    filtrar(primera);
+    atomic_store(&salida, (ema + (1 << (FRAC - 1))) >> FRAC);
+    tomarMuestra();
+    adc_consumirCambio();
+
+    atomic_store(&corriendo, 1);
+    if (pthread_create(&hilo, NULL, hiloMuestreador, NULL) != 0) {
+        atomic_store(&corriendo, 0);
+        cerrarCambio();
+        return 1;
+    }
+    return 0;
+}
+
+// Arranca el muestreo de 'pin' a 'hz' muestras por segundo. La primera lectura
+// se hace acá mismo para que adc_delay() sea válido apenas vuelve.
+int adc_iniciar(int pin, int hz, int delayMin, int delayMax) {
+    if (atomic_load(&corriendo) || hz <= 0)
+        return 1;
+
+    bus    = NULL;
+    pinAdc = pin;
+    return arrancar(hz, delayMin, delayMax);
+}
+
+int adc_iniciarRafaga(const busI2c_t *b, int hz, int juegos, int delayMin, int delayMax) {
+    if (atomic_load(&corriendo) || hz <= 0 || juegos < 1 || juegos > PCF_JUEGOS_MAX)
+        return 1;
+
+    busRafaga    = *b;
+    bus          = &busRafaga;
+    juegosRafaga = juegos;
+    return arrancar(hz, delayMin, delayMax);
+}
+
+void adc_cerrar(void) {
+    if (!atomic_load(&corriendo))
+        return;
+    atomic_store(&corriendo, 0);
+    pthread_join(hilo, NULL);
+    cerrarCambio();
+    if (bus) {
+        i2c_cerrar(&busRafaga);
+        bus = NULL;
+    }
+}
+
+int adc_crudo(void) {
+    return atomic_load_explicit(&ultimoCrudo, memory_order_relaxed);
+}
+
+int adc_filtrado(void) {
+    return atomic_load_explicit(&salida, memory_order_relaxed);
+}
+
+// Delay correspondiente a la posición filtrada del potenciómetro
+int adc_delay(void) {
+    return map(adc_filtrado(), 0, 255, rangoMin, rangoMax);
+}
+
+// Copia hasta 'max' muestras, de la más nueva a la más vieja
+int adc_muestras(muestraAdc_t *dest, int max) {
+    unsigned int n = atomic_load_explicit(&escritas, memory_order_acquire);
+    int cant = 0;
+
+    if (max > ADC_MUESTRAS)
+        max = ADC_MUESTRAS;
+
+    while (cant < max && (unsigned int)cant < n) {
+        uint64_t m = atomic_load_explicit(&anillo[(n - 1 - cant) & (ADC_MUESTRAS - 1)], memory_order_relaxed);
+        dest[cant].t_ms     = (uint32_t)(m >> 32);
+        dest[cant].crudo    = (uint16_t)(m >> 16);
+        dest[cant].filtrado = (uint16_t)m;
+        cant++;
+    }
+    return cant;
+}
+
+int adc_lotes(unsigned int *cursor, loteAdc_t *dest, int max) {
+    unsigned int n = atomic_load_explicit(&lotesEscritos, memory_order_acquire);
+    int cant = 0;
+
+    if (n - *cursor > ADC_LOTES)
+        *cursor = n - ADC_LOTES;
+
+    while (cant < max && *cursor != n) {
+        unsigned int i = *cursor & (ADC_LOTES - 1);
+        unsigned int s = atomic_load_explicit(&secuenciaLote[i], memory_order_acquire);
+        if (!(s & 1)) {
+            dest[cant] = lotes[i];
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&secuenciaLote[i], memory_order_relaxed) == s &&
+                dest[cant].numero == *cursor) {
+                cant++;
+                (*cursor)++;
+                continue;
+            }
+        }
+        // Lo pisaron mientras se copiaba: se salta a lo que queda en el anillo
+        n = atomic_load_explicit(&lotesEscritos, memory_order_acquire);
+        if (n - *cursor >= ADC_LOTES)
+            *cursor = n - ADC_LOTES + 1;
+    }
+    return cant;
+}
+
+int adc_fdCambio(void) {
+    return cambioFd;
+}
+
+void adc_consumirCambio(void) {
+    uint64_t n;
+    if (read(cambioFd, &n, sizeof(n)) < 0) {
+        // EAGAIN: no había cambio pendiente
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef ADC_H
+#define ADC_H
+
+#include <stdint.h>
+
+#include "adc_i2c.h"
+
+#define ADC_MUESTRAS     64   // historial del anillo (potencia de 2)
+#define ADC_HISTERESIS    2   // cuentas del ADC que hay que moverse para cambiar la salida
+#define ADC_LOTES        16   // lotes de ráfaga que se guardan (potencia de 2)
+
+// Muestra empaquetada en 64 bits para leerla de forma atómica
+typedef struct {
+    uint32_t t_ms;       // millis() al tomarla
+    uint16_t crudo;      // lectura directa del PCF8591 (0..255)
+    uint16_t filtrado;   // salida filtrada (0..255)
+} muestraAdc_t;
+
+// Una ráfaga: 'juegos' lecturas de los cuatro canales hechas en una sola
+// transferencia. Las marcas se reparten según cuándo pasó cada byte por el bus.
+typedef struct {
+    uint32_t numero;                                  // correlativo: un salto = lotes perdidos
+    uint16_t juegos;
+    uint64_t tNs;                                     // CLOCK_MONOTONIC del juego 0
+    uint32_t periodoNs;                               // entre juegos
+    uint8_t  valores[PCF_JUEGOS_MAX][PCF_CANALES];
+} loteAdc_t;
+
+int  adc_iniciar(int pin, int hz, int delayMin, int delayMax);
+// Igual, pero leyendo el PCF8591 por 'bus' en ráfagas de 'juegos' juegos. El
+// canal 0 sigue siendo el potenciómetro (filtro, anillo y adc_delay()); los
+// cuatro canales quedan en lotes para los demás consumidores. Si arranca, el
+// bus pasa a ser del ADC y adc_cerrar() lo cierra.
+int  adc_iniciarRafaga(const busI2c_t *bus, int hz, int juegos, int delayMin, int delayMax);
+void adc_cerrar(void);
+
+// Lecturas sin I2C ni locks: devuelven lo último que dejó el hilo muestreador
+int  adc_crudo(void);
+int  adc_filtrado(void);
+int  adc_delay(void);
+int  adc_muestras(muestraAdc_t *dest, int max);
+
+// Lotes desde '*cursor' (arrancarlo en 0), sin locks y para cualquier cantidad
+// de lectores: cada uno lleva su cursor. Si se atrasa más de ADC_LOTES pierde
+// los viejos y se nota en 'numero'. Devuelve cuántos copió.
+int  adc_lotes(unsigned int *cursor, loteAdc_t *dest, int max);
+
+// eventfd que se marca cuando la salida filtrada cambia (pasó la histéresis)
+int  adc_fdCambio(void);
+void adc_consumirCambio(void);
+
+#endif
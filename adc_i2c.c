@@ -0,0 +1,133 @@
+// adc_i2c.c
+// Bus I2C por i2c-dev, el PCF8591 falso y las ráfagas (ver adc_i2c.h).
+#include "adc_i2c.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+// -------------------- Bus real --------------------
+typedef struct {
+    int fd;
+    uint16_t direccion;
+} i2cReal_t;
+
+// Escritura y lectura en un solo ioctl: un START, un repeated start y un STOP
+static int transferirReal(void *ctx, const uint8_t *esc, int nEsc, uint8_t *leer, int nLeer) {
+    i2cReal_t *r = ctx;
+    struct i2c_msg msgs[2];
+    int n = 0;
+
+    if (nEsc > 0)
+        msgs[n++] = (struct i2c_msg){ .addr = r->direccion, .flags = 0, .len = (uint16_t)nEsc, .buf = (uint8_t *)esc };
+    if (nLeer > 0)
+        msgs[n++] = (struct i2c_msg){ .addr = r->direccion, .flags = I2C_M_RD, .len = (uint16_t)nLeer, .buf = leer };
+    if (n == 0)
+        return 0;
+
+    struct i2c_rdwr_ioctl_data datos = { .msgs = msgs, .nmsgs = (uint32_t)n };
+    return ioctl(r->fd, I2C_RDWR, &datos) == n ? 0 : 1;
+}
+
+int i2c_abrir(busI2c_t *bus, const char *ruta, int direccion) {
+    i2cReal_t *r = malloc(sizeof(*r));
+    if (!r)
+        return 1;
+
+    r->fd = open(ruta, O_RDWR | O_CLOEXEC);
+    r->direccion = (uint16_t)direccion;
+    unsigned long funciones = 0;
+    if (r->fd < 0 || ioctl(r->fd, I2C_FUNCS, &funciones) < 0 || !(funciones & I2C_FUNC_I2C)) {
+        if (r->fd >= 0)
+            close(r->fd);
+        free(r);
+        return 1;   // sin I2C_RDWR (p.ej. un adaptador solo SMBus)
+    }
+
+    bus->transferir = transferirReal;
+    bus->ctx = r;
+    return 0;
+}
+
+void i2c_cerrar(busI2c_t *bus) {
+    i2cReal_t *r = bus->ctx;
+    if (bus->transferir != transferirReal || !r)
+        return;
+    close(r->fd);
+    free(r);
+    bus->ctx = NULL;
+}
+
+// -------------------- PCF8591 falso --------------------
+// Como el chip: cada byte leído trae la conversión anterior y dispara la
+// siguiente, del canal que corresponde; con autoincremento el canal avanza.
+static int transferirFalso(void *ctx, const uint8_t *esc, int nEsc, uint8_t *leer, int nLeer) {
+    pcfFalso_t *f = ctx;
+    long bits = 1;   // STOP
+
+    if (nEsc > 0) {
+        f->control = esc[0];   // los que siguen irían a la salida analógica
+        f->canal = esc[0] & 0x03;
+        bits += 1 + 9 + 9L * nEsc;   // START, dirección, datos
+    }
+    if (nLeer > 0)
+        bits += 1 + 9 + 9L * nLeer;
+
+    for (int i = 0; i < nLeer; i++) {
+        leer[i] = f->anterior;
+        int v = f->valor ? f->valor(f->ctxValor, f->canal) : 0;
+        f->anterior = (uint8_t)(v < 0 ? 0 : v > 255 ? 255 : v);
+        if (f->control & PCF_AUTOINC)
+            f->canal = (f->canal + 1) & 0x03;
+    }
+
+    f->transferencias++;
+    f->bits += bits;
+    if (f->busHz > 0) {
+        long ns = bits * 1000000000L / f->busHz;
+        struct timespec t = { .tv_sec = ns / 1000000000L, .tv_nsec = ns % 1000000000L };
+        while (nanosleep(&t, &t) != 0 && errno == EINTR)
+            ;
+    }
+    return 0;
+}
+
+void pcf_falso(pcfFalso_t *f, busI2c_t *bus, int (*valor)(void *ctx, int canal), void *ctx) {
+    memset(f, 0, sizeof(*f));
+    f->valor = valor;
+    f->ctxValor = ctx;
+    bus->transferir = transferirFalso;
+    bus->ctx = f;
+}
+
+// -------------------- Driver --------------------
+static uint64_t ahoraNs(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+int pcf_rafaga(const busI2c_t *bus, uint8_t (*valores)[PCF_CANALES], int juegos, uint64_t *duracionNs) {
+    uint8_t crudo[1 + PCF_CANALES * PCF_JUEGOS_MAX];
+    const uint8_t control = PCF_SALIDA | PCF_AUTOINC;   // cuatro entradas simples desde el canal 0
+
+    if (juegos < 1 || juegos > PCF_JUEGOS_MAX)
+        return 1;
+
+    int n = 1 + PCF_CANALES * juegos;
+    uint64_t t0 = ahoraNs();
+    if (bus->transferir(bus->ctx, &control, 1, crudo, n) != 0)
+        return 1;
+    if (duracionNs)
+        *duracionNs = ahoraNs() - t0;
+
+    // El primero es la última conversión de la transferencia anterior
+    memcpy(valores, crudo + 1, (size_t)(n - 1));
+    return 0;
+}
@@ -0,0 +1,51 @@
+#ifndef ADC_I2C_H
+#define ADC_I2C_H
+
+#include <stdint.h>
+
+// PCF8591 directo por /dev/i2c-N, sin la extensión de wiringPi. Allá cada
+// analogRead() son tres transacciones (byte de control, una lectura que se
+// tira y la buena) por un solo canal. Acá el chip queda en autoincremento y
+// una sola transferencia (control + lectura con repeated start, I2C_RDWR)
+// trae los cuatro canales tantas veces como se pida.
+//
+// El bus es un par de punteros a función: el real o un PCF8591 falso en el
+// mismo proceso, que responde como el chip (primer byte viejo, canal que
+// avanza con cada byte) para los benchmarks y las pruebas sin placa.
+#define PCF_CANALES     4
+#define PCF_JUEGOS_MAX  32   // juegos de 4 canales por transferencia
+
+#define PCF_SALIDA      0x40   // salida analógica encendida (como wiringPi: mantiene el oscilador)
+#define PCF_AUTOINC     0x04
+
+typedef struct {
+    // Escribe 'nEsc' bytes y lee 'nLeer' en una sola transacción (cualquiera
+    // de los dos puede ser 0). 0 = ok.
+    int (*transferir)(void *ctx, const uint8_t *esc, int nEsc, uint8_t *leer, int nLeer);
+    void *ctx;
+} busI2c_t;
+
+// -------------------- Bus real --------------------
+int  i2c_abrir(busI2c_t *bus, const char *ruta, int direccion);   // 1 si no se pudo
+void i2c_cerrar(busI2c_t *bus);
+
+// -------------------- PCF8591 falso --------------------
+typedef struct {
+    uint8_t control;
+    int canal;
+    uint8_t anterior;                      // última conversión: sale primero en la próxima lectura
+    int (*valor)(void *ctx, int canal);    // lo que mide cada canal (0..255)
+    void *ctxValor;
+    long busHz;                            // > 0: cada transferencia tarda lo que en el bus real
+    long transferencias;
+    long bits;                             // en el bus, con arranques, direcciones y ACKs
+} pcfFalso_t;
+
+void pcf_falso(pcfFalso_t *f, busI2c_t *bus, int (*valor)(void *ctx, int canal), void *ctx);
+
+// -------------------- Driver --------------------
+// Lee 'juegos' veces los cuatro canales (valores[j][canal]) en una transferencia.
+// 'duracionNs' (puede ser NULL) es lo que tardó, para repartir las marcas de tiempo.
+int pcf_rafaga(const busI2c_t *bus, uint8_t (*valores)[PCF_CANALES], int juegos, uint64_t *duracionNs);
+
+#endif
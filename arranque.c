@@ -0,0 +1,114 @@
+// arranque.c
+// Fases del arranque (ver arranque.h). Las puede marcar cualquier hilo: cada
+// una toma un casillero con un atómico y lo escribe solo quien la abrió.
+#include "arranque.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct {
+    const char *nombre;
+    uint64_t desde;   // ns en CLOCK_BOOTTIME
+    _Atomic uint64_t hasta;   // 0 mientras corre; == desde en un hito
+    int principal;
+} fase_t;
+
+static fase_t fases[ARRANQUE_FASES];
+static _Atomic int cantFases = 0;
+static uint64_t inicioMain;
+static pthread_t hiloPrincipal;
+
+static uint64_t ahora(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_BOOTTIME, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+static double ms(uint64_t ns) {
+    return ns / 1e6;
+}
+
+// Campo 22 de /proc/self/stat: cuándo arrancó el proceso, en ticks desde el
+// arranque del sistema. 0 si no se pudo leer.
+static uint64_t inicioProceso(void) {
+    char linea[1024];
+    FILE *f = fopen("/proc/self/stat", "r");
+    if (!f)
+        return 0;
+    size_t n = fread(linea, 1, sizeof(linea) - 1, f);
+    fclose(f);
+    linea[n] = '\0';
+
+    // El nombre del ejecutable puede tener espacios: se cuenta desde el último ')'
+    char *p = strrchr(linea, ')');
+    unsigned long long ticks;
+    if (!p || sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d %*d %*d %llu",
+                     &ticks) != 1)
+        return 0;
+    return ticks * (1000000000ULL / (uint64_t)sysconf(_SC_CLK_TCK));
+}
+
+void arranque_iniciar(void) {
+    inicioMain = ahora();
+    hiloPrincipal = pthread_self();
+}
+
+int arranque_fase(const char *nombre) {
+    int i = atomic_fetch_add(&cantFases, 1);
+    if (i >= ARRANQUE_FASES)
+        return -1;
+
+    fases[i].nombre = nombre;
+    fases[i].principal = pthread_equal(pthread_self(), hiloPrincipal);
+    fases[i].desde = ahora();
+    return i;
+}
+
+void arranque_fin(int fase) {
+    if (fase >= 0)
+        atomic_store(&fases[fase].hasta, ahora());
+}
+
+void arranque_hito(const char *nombre) {
+    int i = arranque_fase(nombre);
+    if (i >= 0)
+        atomic_store(&fases[i].hasta, fases[i].desde);
+}
+
+int arranque_informe(const char *ruta) {
+    FILE *f = strcmp(ruta, "-") == 0 ? stderr : fopen(ruta, "w");
+    if (!f)
+        return 1;
+
+    uint64_t exec = inicioProceso();
+    fprintf(f, "main() a los %.1f ms del arranque del sistema", ms(inicioMain));
+    if (exec)
+        fprintf(f, " (el proceso empezó a los %.0f ms)", ms(exec));
+    fprintf(f, "\n%-28s %9s %9s %9s\n", "fase", "desde ms", "hasta ms", "dura ms");
+
+    int n = atomic_load(&cantFases);
+    if (n > ARRANQUE_FASES)
+        n = ARRANQUE_FASES;
+    for (int i = 0; i < n; i++) {
+        const fase_t *p = &fases[i];
+        uint64_t hasta = atomic_load(&p->hasta);
+
+        fprintf(f, "%-28s %9.2f ", p->nombre, ms(p->desde - inicioMain));
+        if (hasta == p->desde)
+            fprintf(f, "%9s %9s", "", "");
+        else if (hasta == 0)
+            fprintf(f, "%9s %9s", "...", "");
+        else
+            fprintf(f, "%9.2f %9.2f", ms(hasta - inicioMain), ms(hasta - p->desde));
+        fprintf(f, "%s\n", p->principal ? "" : "  (en paralelo)");
+    }
+
+    if (f != stderr)
+        fclose(f);
+    return 0;
+}
@@ -0,0 +1,21 @@
+#ifndef ARRANQUE_H
+#define ARRANQUE_H
+
+// Tiempos del arranque, para ver qué demora el encendido de las luces tras
+// un corte. Cada fase queda con su inicio y su fin en CLOCK_BOOTTIME (que
+// cuenta desde que arrancó el kernel) y con el hilo que la corrió; las que
+// no son del hilo principal corren en paralelo con él.
+//
+// arranque_informe() escribe la tabla con los tiempos relativos a main() y,
+// arriba, cuándo arrancó el proceso (de /proc/self/stat, en ticks de 10 ms).
+#define ARRANQUE_FASES 24
+
+void arranque_iniciar(void);                 // lo primero de main()
+int  arranque_fase(const char *nombre);      // empieza una fase: su número, o -1 si no hay lugar
+void arranque_fin(int fase);
+void arranque_hito(const char *nombre);      // un instante (p.ej. el primer frame)
+
+// "-" es stderr. 1 si no se pudo escribir.
+int  arranque_informe(const char *ruta);
+
+#endif
@@ -0,0 +1,433 @@
+// audio.c
+// Modo de audio (ver audio.h): análisis por bandas con detección de golpes
+// y el hilo que lo alimenta desde ALSA o desde un .wav. Todo en enteros: la
+// energía de cada banda se compara en log2 Q8 (256 = el doble de energía,
+// 3 dB), así un piso, un pico y un umbral son sumas y restas.
+#define _GNU_SOURCE
+#include "audio.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef LUCES_ALSA
+#include <alsa/asoundlib.h>
+#endif
+
+#define PRIORIDAD_FIFO   70       // debajo del hilo de salida (motor.c)
+
+#define BANDA_MIN_HZ     60
+#define BANDA_MAX_HZ     12000
+#define RUIDO            (2 * 256)   // 6 dB sobre el piso para que cuente
+#define RANGO_CAIDA      (8 * 256)   // lo que baja un pico en 'caidaMs'
+#define SUBIDA_PISO      10          // el piso sigue a la energía en ~2^10 saltos (6 s)
+#define MEMORIA_GRAVES   7           // promedio de graves de ~2^7 saltos (0.7 s)
+#define UMBRAL_GOLPE     (256 << 8)  // graves al menos al doble del promedio (Q16)...
+#define DESVIOS_GOLPE    3           // ...y a 3 desvíos medios de él
+#define REFRACTARIO_MS   250         // a lo sumo 4 golpes por segundo
+#define DESTELLO_MAX_MS  100
+
+// -------------------- Análisis --------------------
+void audio_analisisIniciar(analisisAudio_t *a, int hz) {
+    fft_iniciar();
+    memset(a, 0, sizeof(*a));
+    a->hz = hz;
+    a->usSalto = (int)(AUDIO_SALTO * 1000000LL / hz);
+
+    // Bandas en escala logarítmica, de al menos un bin y sin el de continua
+    double alto = BANDA_MAX_HZ < hz * 0.45 ? BANDA_MAX_HZ : hz * 0.45;
+    for (int j = 0; j <= AUDIO_BANDAS; j++) {
+        double f = BANDA_MIN_HZ * pow(alto / BANDA_MIN_HZ, (double)j / AUDIO_BANDAS);
+        int bin = (int)lround(f * FFT_N / hz);
+        int minimo = j == 0 ? 1 : a->desde[j - 1] + 1;
+        a->desde[j] = bin < minimo ? minimo : bin > FFT_BINS ? FFT_BINS : bin;
+    }
+
+    for (int j = 0; j < AUDIO_BANDAS; j++)
+        a->piso[j] = INT_MAX;   // lo baja el primer bloque
+    a->ultimoGolpe = -1000000;
+}
+
+static long saltosDe(const analisisAudio_t *a, long ms) {
+    long n = ms * 1000 / a->usSalto;
+    return n > 0 ? n : 1;
+}
+
+uint8_t audio_analizar(analisisAudio_t *a, const int16_t *salto, int caidaMs) {
+    memmove(a->ventana, a->ventana + AUDIO_SALTO, (FFT_N - AUDIO_SALTO) * sizeof(int16_t));
+    memcpy(a->ventana + FFT_N - AUDIO_SALTO, salto, AUDIO_SALTO * sizeof(int16_t));
+    fft_transformar(a->ventana, &a->bloque);
+    a->saltos++;
+
+    if (caidaMs < MOTOR_FRAME_MIN_MS)
+        caidaMs = MOTOR_FRAME_MIN_MS;
+    int caida = (int)((long)RANGO_CAIDA * a->usSalto / (caidaMs * 1000L));
+    if (caida < 1)
+        caida = 1;
+
+    // Barras: cada banda se enciende cerca de su pico y bien sobre su piso
+    uint8_t frame = 0;
+    for (int j = 0; j < AUDIO_BANDAS; j++) {
+        int e = fft_energiaLog(&a->bloque, a->desde[j], a->desde[j + 1]);
+
+        if ((e << 8) < a->piso[j])
+            a->piso[j] = e << 8;
+        else
+            a->piso[j] += ((e << 8) - a->piso[j]) >> SUBIDA_PISO;
+        int piso = a->piso[j] >> 8;
+
+        a->pico[j] = e > a->pico[j] - caida ? e : a->pico[j] - caida;
+        if (a->pico[j] < piso)
+            a->pico[j] = piso;
+
+        if (e > piso + RUIDO && e >= a->pico[j] - (a->pico[j] - piso) / 4)
+            frame |= (uint8_t)(1u << j);
+    }
+
+    // Golpes: los graves (dos primeras bandas) saltan sobre su promedio. El
+    // umbral crece con lo que varían solos: un acorde grave que bate no es
+    // un bombo.
+    int graves = fft_energiaLog(&a->bloque, a->desde[0], a->desde[2]) << 8;
+    int umbral = DESVIOS_GOLPE * a->desvioGraves > UMBRAL_GOLPE ? DESVIOS_GOLPE * a->desvioGraves : UMBRAL_GOLPE;
+    if (a->saltos == 1)
+        a->promedioGraves = graves;   // sin esto arranca de 0 y todo es golpe
+    else if (graves > a->promedioGraves + umbral && graves > a->piso[0] + (RUIDO << 8) &&
+             a->saltos - a->ultimoGolpe >= saltosDe(a, REFRACTARIO_MS)) {
+        a->ultimoGolpe = a->saltos;
+        a->golpes++;
+    }
+    int desvio = graves > a->promedioGraves ? graves - a->promedioGraves : a->promedioGraves - graves;
+    a->desvioGraves += (desvio - a->desvioGraves) >> MEMORIA_GRAVES;
+    a->promedioGraves += (graves - a->promedioGraves) >> MEMORIA_GRAVES;
+
+    int destelloMs = caidaMs / 4 < DESTELLO_MAX_MS ? caidaMs / 4 : DESTELLO_MAX_MS;
+    if (a->saltos - a->ultimoGolpe < saltosDe(a, destelloMs))
+        frame = 0xFF;
+
+    a->frame = frame;
+    return frame;
+}
+
+// -------------------- Programa en el motor --------------------
+static _Atomic uint8_t frameVivo = 0;
+
+// Un paso que solo marca el ritmo del reloj de la pista: el frame es el vivo
+static const paso_t pasoAudio[1] = { { 0x00, 2, 0 } };
+
+static const programa_t programaAudio = {
+    .nombre    = "Ritmo de la musica",
+    .pasos     = pasoAudio,
+    .cantPasos = 1,
+    .bucle     = 1,
+    .delayMs   = 0,
+    .vivo      = &frameVivo,
+};
+
+const programa_t *audio_programa(void) {
+    return &programaAudio;
+}
+
+// -------------------- Fuentes --------------------
+// Un .wav PCM de 16 bits mapeado; se entrega al ritmo en que sonaría
+static const uint8_t *wav = NULL;
+static size_t largoWav = 0;
+static const int16_t *muestrasWav = NULL;
+static long framesWav = 0, posWav = 0;
+static int canalesWav = 1;
+static struct timespec proximoSalto;
+
+#ifdef LUCES_ALSA
+static snd_pcm_t *pcm = NULL;
+#endif
+
+static uint32_t leerU32(const uint8_t *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint16_t leerU16(const uint8_t *p) {
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static int abrirWav(const char *ruta, int *hz) {
+    int fd = open(ruta, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd < 0)
+        return 1;
+    if (fstat(fd, &st) != 0 || st.st_size < 12) {
+        close(fd);
+        return 1;
+    }
+    void *m = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED)
+        return 1;
+    wav = m;
+    largoWav = (size_t)st.st_size;
+    muestrasWav = NULL;
+    framesWav = 0;
+    canalesWav = 0;
+
+    // RIFF/WAVE: se buscan "fmt " y "data" entre los trozos, en el orden que
+    // vengan; los frames se cuentan recién con los dos leídos
+    int formato = 0, bits = 0;
+    const uint8_t *datosWav = NULL;
+    uint32_t largoDatos = 0;
+    if (memcmp(wav, "RIFF", 4) != 0 || memcmp(wav + 8, "WAVE", 4) != 0)
+        goto malo;
+    for (size_t p = 12; p + 8 <= largoWav;) {
+        uint32_t largo = leerU32(wav + p + 4);
+        const uint8_t *datos = wav + p + 8;
+        if (largo > largoWav - p - 8)
+            largo = (uint32_t)(largoWav - p - 8);
+
+        if (memcmp(wav + p, "fmt ", 4) == 0 && largo >= 16) {
+            formato    = leerU16(datos);
+            canalesWav = leerU16(datos + 2);
+            *hz        = (int)leerU32(datos + 4);
+            bits       = leerU16(datos + 14);
+        } else if (memcmp(wav + p, "data", 4) == 0) {
+            datosWav = datos;
+            largoDatos = largo;
+        }
+        p += 8 + largo + (largo & 1);
+    }
+    if (formato != 1 || bits != 16 || canalesWav < 1 || *hz < 8000 || !datosWav)
+        goto malo;
+    muestrasWav = (const int16_t *)datosWav;
+    framesWav = largoDatos / (2 * canalesWav);
+    if (framesWav < AUDIO_SALTO)
+        goto malo;
+
+    posWav = 0;
+    clock_gettime(CLOCK_MONOTONIC, &proximoSalto);
+    return 0;
+
+malo:
+    munmap((void *)wav, largoWav);
+    wav = NULL;
+    return 1;
+}
+
+static int leerWav(int16_t *dest, int n, int hz) {
+    // El bloque "termina de llegar" un salto después del anterior
+    proximoSalto.tv_nsec += (long)n * 1000000000L / hz;
+    while (proximoSalto.tv_nsec >= 1000000000L) {
+        proximoSalto.tv_nsec -= 1000000000L;
+        proximoSalto.tv_sec++;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &proximoSalto, NULL) == EINTR)
+        ;
+
+    for (int i = 0; i < n; i++) {
+        const int16_t *m = muestrasWav + posWav * canalesWav;
+        int32_t suma = 0;
+        for (int c = 0; c < canalesWav; c++)
+            suma += m[c];
+        dest[i] = (int16_t)(suma / canalesWav);
+        if (++posWav >= framesWav)
+            posWav = 0;
+    }
+    return 0;
+}
+
+#ifdef LUCES_ALSA
+// Mono, 16 bits, con un periodo del tamaño del salto: cada lectura vuelve
+// apenas el bloque está completo
+static int abrirAlsa(const char *dispositivo, int *hz) {
+    snd_pcm_hw_params_t *hw;
+    unsigned int tasa = AUDIO_HZ;
+    snd_pcm_uframes_t periodo = AUDIO_SALTO, buffer = AUDIO_SALTO * 4;
+
+    if (snd_pcm_open(&pcm, dispositivo, SND_PCM_STREAM_CAPTURE, 0) < 0) {
+        pcm = NULL;
+        return 1;
+    }
+    snd_pcm_hw_params_alloca(&hw);
+    if (snd_pcm_hw_params_any(pcm, hw) < 0 ||
+        snd_pcm_hw_params_set_access(pcm, hw, SND_PCM_ACCESS_RW_INTERLEAVED) < 0 ||
+        snd_pcm_hw_params_set_format(pcm, hw, SND_PCM_FORMAT_S16) < 0 ||
+        snd_pcm_hw_params_set_channels(pcm, hw, 1) < 0 ||
+        snd_pcm_hw_params_set_rate_near(pcm, hw, &tasa, NULL) < 0 ||
+        snd_pcm_hw_params_set_period_size_near(pcm, hw, &periodo, NULL) < 0 ||
+        snd_pcm_hw_params_set_buffer_size_near(pcm, hw, &buffer) < 0 ||
+        snd_pcm_hw_params(pcm, hw) < 0 || snd_pcm_prepare(pcm) < 0) {
+        snd_pcm_close(pcm);
+        pcm = NULL;
+        return 1;
+    }
+    *hz = (int)tasa;
+    return 0;
+}
+
+static int leerAlsa(int16_t *dest, int n) {
+    while (n > 0) {
+        snd_pcm_sframes_t r = snd_pcm_readi(pcm, dest, (snd_pcm_uframes_t)n);
+        if (r < 0) {
+            if (snd_pcm_recover(pcm, (int)r, 1) < 0)
+                return 1;
+            continue;   // se perdió un tramo (overrun): sigue con lo que venga
+        }
+        dest += r;
+        n -= (int)r;
+    }
+    return 0;
+}
+#endif
+
+// -------------------- Hilo de captura --------------------
+static pthread_t hilo;
+static int corriendo = 0;
+static _Atomic int terminar = 0;
+static int idAudio = -1;
+static analisisAudio_t analisis;
+
+// Las escribe el hilo y las lee la interfaz: son contadores sueltos, sin
+// necesidad de que el conjunto sea consistente
+static _Atomic long bloques, golpes, procesoUsMax, procesoUsTotal;
+static struct timespec inicio;
+
+static long nsDesde(const struct timespec *a) {
+    struct timespec b;
+    clock_gettime(CLOCK_MONOTONIC, &b);
+    return (b.tv_sec - a->tv_sec) * 1000000000L + (b.tv_nsec - a->tv_nsec);
+}
+
+static int leerSalto(int16_t *dest) {
+#ifdef LUCES_ALSA
+    if (pcm)
+        return leerAlsa(dest, AUDIO_SALTO);
+#endif
+    return leerWav(dest, AUDIO_SALTO, analisis.hz);
+}
+
+static void *hiloAudio(void *arg) {
+    (void)arg;
+    int16_t salto[AUDIO_SALTO];
+
+    while (!atomic_load(&terminar) && leerSalto(salto) == 0) {
+        struct timespec t0;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+
+        uint8_t frame = audio_analizar(&analisis, salto, motor_velocidad(idAudio));
+        if (frame != atomic_load_explicit(&frameVivo, memory_order_relaxed)) {
+            atomic_store_explicit(&frameVivo, frame, memory_order_relaxed);
+            motor_refrescar();
+        }
+
+        long us = nsDesde(&t0) / 1000;
+        atomic_fetch_add_explicit(&procesoUsTotal, us, memory_order_relaxed);
+        if (us > atomic_load_explicit(&procesoUsMax, memory_order_relaxed))
+            atomic_store_explicit(&procesoUsMax, us, memory_order_relaxed);
+        atomic_store_explicit(&golpes, analisis.golpes, memory_order_relaxed);
+        atomic_fetch_add_explicit(&bloques, 1, memory_order_relaxed);
+    }
+    return NULL;
+}
+
+static void cerrarFuente(void) {
+#ifdef LUCES_ALSA
+    if (pcm) {
+        snd_pcm_close(pcm);
+        pcm = NULL;
+    }
+#endif
+    if (wav) {
+        munmap((void *)wav, largoWav);
+        wav = NULL;
+    }
+}
+
+static int esWav(const char *fuente) {
+    size_t n = fuente ? strlen(fuente) : 0;
+    return n > 4 && strcasecmp(fuente + n - 4, ".wav") == 0;
+}
+
+int audio_iniciar(const char *fuente, int id) {
+    int hz = AUDIO_HZ;
+
+    if (corriendo)
+        return 0;
+    if (esWav(fuente)) {
+        if (abrirWav(fuente, &hz) != 0)
+            return 1;
+    } else {
+#ifdef LUCES_ALSA
+        if (abrirAlsa(fuente ? fuente : "default", &hz) != 0)
+            return 1;
+#else
+        return 1;   // compilado sin ALSA: solo .wav
+#endif
+    }
+
+    audio_analisisIniciar(&analisis, hz);
+    idAudio = id;
+    atomic_store(&frameVivo, 0);
+    atomic_store(&terminar, 0);
+    atomic_store(&bloques, 0);
+    atomic_store(&golpes, 0);
+    atomic_store(&procesoUsMax, 0);
+    atomic_store(&procesoUsTotal, 0);
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+
+    // Tiempo real si hay permisos, como el hilo de salida
+    pthread_attr_t attr;
+    struct sched_param sp = { .sched_priority = PRIORIDAD_FIFO };
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    pthread_attr_setschedparam(&attr, &sp);
+
+    int r = pthread_create(&hilo, &attr, hiloAudio, NULL);
+    if (r != 0)
+        r = pthread_create(&hilo, NULL, hiloAudio, NULL);
+    pthread_attr_destroy(&attr);
+    if (r != 0) {
+        cerrarFuente();
+        return 1;
+    }
+    corriendo = 1;
+    return 0;
+}
+
+void audio_cerrar(void) {
+    if (!corriendo)
+        return;
+
+    atomic_store(&terminar, 1);
+    pthread_join(hilo, NULL);   // a lo sumo un salto
+    corriendo = 0;
+    cerrarFuente();
+    atomic_store(&frameVivo, 0);
+    motor_refrescar();
+}
+
+int audio_activo(void) {
+    return corriendo;
+}
+
+void audio_estadisticas(estadAudio_t *e) {
+    memset(e, 0, sizeof(*e));
+    if (!corriendo)
+        return;
+
+    e->hz = analisis.hz;
+    e->bloques = atomic_load_explicit(&bloques, memory_order_relaxed);
+    e->golpes = atomic_load_explicit(&golpes, memory_order_relaxed);
+    e->procesoUsMax = atomic_load_explicit(&procesoUsMax, memory_order_relaxed);
+    long total = atomic_load_explicit(&procesoUsTotal, memory_order_relaxed);
+    e->procesoUsPromedio = e->bloques ? total / e->bloques : 0;
+    e->latenciaUsMax = analisis.usSalto + e->procesoUsMax;
+
+    long transcurridoUs = nsDesde(&inicio) / 1000;
+    e->cpu = transcurridoUs > 0 ? (double)total / transcurridoUs : 0;
+}
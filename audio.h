@@ -0,0 +1,68 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include <stdint.h>
+
+#include "fft.h"
+#include "motor.h"
+
+// Luces al ritmo de la música. Un hilo toma el audio de a AUDIO_SALTO
+// muestras (ALSA, o un .wav que hace de micrófono a su ritmo real), lo pasa
+// por la FFT de fft.h y reparte la energía en AUDIO_BANDAS bandas
+// logarítmicas: la banda j enciende la posición j del frame cuando está
+// cerca de su pico reciente. Un golpe de graves enciende todo un instante.
+//
+// El frame se publica en un atómico que el motor lee al componer (ver
+// 'vivo' en programa_t), así que el programa de audio se reproduce, pausa,
+// detiene y acelera como cualquier otra secuencia. La velocidad es la caída:
+// cuánto tardan las barras en bajar después de un pico.
+//
+// De la muestra a la luz pasan un salto (5.8 ms a 44.1 kHz, lo que tarda en
+// llegar el bloque) más el cálculo, unos pocos us.
+#define AUDIO_HZ      44100
+#define AUDIO_SALTO   256                 // muestras nuevas por bloque
+#define AUDIO_BANDAS  8
+
+// -------------------- Análisis (sin hilo ni fuente) --------------------
+typedef struct {
+    int hz;
+    int usSalto;
+    int16_t ventana[FFT_N];               // últimas FFT_N muestras
+    fftBloque_t bloque;
+    int desde[AUDIO_BANDAS + 1];          // bins de cada banda
+    int piso[AUDIO_BANDAS];               // log2 Q16: sube lento, baja de golpe
+    int pico[AUDIO_BANDAS];               // log2 Q8: sube de golpe, cae con la velocidad
+    int promedioGraves;                   // log2 Q16, para los golpes
+    int desvioGraves;                     // desvío medio respecto del promedio (Q16)
+    long saltos;
+    long ultimoGolpe;                     // en saltos
+    long golpes;
+    uint8_t frame;
+} analisisAudio_t;
+
+void    audio_analisisIniciar(analisisAudio_t *a, int hz);
+uint8_t audio_analizar(analisisAudio_t *a, const int16_t *salto, int caidaMs);
+
+// -------------------- Captura --------------------
+typedef struct {
+    int  hz;
+    long bloques;
+    long golpes;
+    long procesoUsMax;                    // FFT + bandas + golpes de un bloque
+    long procesoUsPromedio;
+    long latenciaUsMax;                   // salto + proceso
+    double cpu;                           // fracción de un núcleo
+} estadAudio_t;
+
+// Programa que hay que registrar en el motor para reproducir el audio
+const programa_t *audio_programa(void);
+
+// 'fuente': un .wav (se repite al terminar) o un dispositivo ALSA; NULL es
+// el "default" de ALSA. 'id' es el del programa de audio en el motor, de
+// donde se toma la velocidad. 1 si no se pudo abrir.
+int  audio_iniciar(const char *fuente, int id);
+void audio_cerrar(void);
+int  audio_activo(void);
+void audio_estadisticas(estadAudio_t *e);
+
+#endif
@@ -0,0 +1,88 @@
+// bam.c
+// Intensidad por bit-angle modulation sobre el HAL: en vez de PWM por LED
+// (un digitalWrite por canal y por tick) se escriben 8 frames completos por
+// ciclo, cada uno durante un tiempo binario.
+#include "bam.h"
+#include "gpio_hal.h"
+
+#include <math.h>
+
+uint8_t bam_gamma[256];
+
+void bam_iniciar(double gamma) {
+    for (int i = 0; i < 256; i++)
+        bam_gamma[i] = (uint8_t)lround(255.0 * pow(i / 255.0, gamma));
+}
+
+void bam_planos8(const uint8_t intens[8], uint8_t mascaras[BAM_BITS]) {
+    uint8_t g[8];
+
+    for (int j = 0; j < 8; j++)
+        g[j] = bam_gamma[intens[j]];
+
+    for (int b = 0; b < BAM_BITS; b++) {
+        uint8_t m = 0;
+        for (int j = 0; j < 8; j++)
+            m |= (uint8_t)((g[j] >> b & 1) << j);
+        mascaras[b] = m;
+    }
+}
+
+// -------------------- Temporización del ciclo --------------------
+static void sumarUs(struct timespec *t, long us) {
+    t->tv_nsec += us * 1000L;
+    while (t->tv_nsec >= 1000000000L) {
+        t->tv_nsec -= 1000000000L;
+        t->tv_sec++;
+    }
+}
+
+static long restanteUs(const struct timespec *t) {
+    struct timespec ahora;
+    clock_gettime(CLOCK_MONOTONIC, &ahora);
+    return (t->tv_sec - ahora.tv_sec) * 1000000L + (t->tv_nsec - ahora.tv_nsec) / 1000L;
+}
+
+static int antes(const struct timespec *a, const struct timespec *b) {
+    return a->tv_sec < b->tv_sec || (a->tv_sec == b->tv_sec && a->tv_nsec < b->tv_nsec);
+}
+
+static void esperarHasta(const struct timespec *t) {
+    long falta = restanteUs(t);
+
+    if (falta > BAM_SPIN_US)
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, t, NULL);
+    else
+        while (restanteUs(t) > 0)
+            ;
+}
+
+// Próximo corte: el fin del plano o el límite, lo que llegue antes.
+// Devuelve 1 si el límite cortó el ciclo.
+static int finDePlano(struct timespec *t, int b, const struct timespec *limite) {
+    sumarUs(t, (long)BAM_BASE_US << b);
+    if (limite && !antes(t, limite)) {
+        esperarHasta(limite);
+        return 1;
+    }
+    esperarHasta(t);
+    return 0;
+}
+
+int bam_ciclo8(const uint8_t mascaras[BAM_BITS], const struct timespec *limite) {
+    struct timespec t;
+    int escrituras = 0;
+    int anterior = hal_frameActual();   // un frame que no cambia no se reescribe
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    for (int b = BAM_BITS - 1; b >= 0; b--) {
+        if (mascaras[b] != anterior) {
+            hal_escribirFrame(mascaras[b]);
+            anterior = mascaras[b];
+            escrituras++;
+        }
+        if (finDePlano(&t, b, limite))
+            break;
+    }
+    return escrituras;
+}
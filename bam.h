@@ -0,0 +1,29 @@
+#ifndef BAM_H
+#define BAM_H
+
+#include <stdint.h>
+#include <time.h>
+
+// Bit-angle modulation: una intensidad de 8 bits se muestra como 8 planos de
+// bits, el plano b encendido durante BAM_BASE_US << b. Un ciclo completo dura
+// 255 * BAM_BASE_US (~7,6 ms, ~130 Hz de refresco).
+#define BAM_BITS     8
+#define BAM_BASE_US  30
+#define BAM_CICLO_US (BAM_BASE_US * 255)
+#define BAM_SPIN_US  100   // esperas más cortas se hacen girando, no durmiendo
+
+extern uint8_t bam_gamma[256];
+
+void bam_iniciar(double gamma);
+
+// Planos de un frame de 8 posiciones: mascaras[b] tiene el bit j encendido si
+// gamma(intens[j]) tiene el bit b. Se estiran a los canales en el HAL.
+void bam_planos8(const uint8_t intens[8], uint8_t mascaras[BAM_BITS]);
+
+// Saca un ciclo empezando ahora, del plano más significativo al menos: si
+// 'limite' llega antes (vence el paso de la secuencia), el ciclo se corta ahí
+// y lo que se pierde son los bits de menos peso. Devuelve cuántas escrituras
+// al HAL hizo (planos iguales seguidos se escriben una sola vez).
+int bam_ciclo8(const uint8_t mascaras[BAM_BITS], const struct timespec *limite);
+
+#endif
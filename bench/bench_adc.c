@@ -0,0 +1,180 @@
+// bench_adc.c
+// Lectura del PCF8591 (adc_i2c.h) contra un chip falso en el mismo proceso:
+//   - muestras por segundo del camino de wiringPi (tres transacciones por
+//     canal: control, lectura que se tira y la buena) contra ráfagas de 1, 8
+//     y 32 juegos de los cuatro canales en una sola transferencia, a 100 y
+//     400 kHz. El tiempo de bus sale de los bits que cuenta el falso; a cada
+//     transacción se le suma una llamada al sistema medida acá (read() de
+//     /dev/zero: el driver I2C real cuesta más, así que es un piso)
+//   - que cada canal traiga lo suyo y que el byte viejo del chip se descarte
+//   - el muestreador de adc.c en modo ráfaga sobre el bus falso a ritmo real:
+//     lotes correlativos, marcas de tiempo crecientes, un lector lento que
+//     pierde lotes y lo nota, y el canal 0 manejando el filtro
+//
+// Uso: bench_adc [segundos]
+#include "adc.h"
+#include "adc_i2c.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define HZ_MUESTREO  100
+#define JUEGOS_VIVO  8
+#define LLAMADAS     20000
+
+static const long velocidades[] = { 100000, 400000 };
+
+// Lo que mide cada canal: distinto por canal y por "generación" para notar
+// si se cuela un valor de la transferencia anterior
+static int generacion = 0;
+
+static int medir(void *ctx, int canal) {
+    (void)ctx;
+    return canal * 60 + generacion;
+}
+
+static double segundos(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static double llamadaUs(void) {
+    char b;
+    int fd = open("/dev/zero", O_RDONLY);
+    if (fd < 0)
+        return 0;
+    double t0 = segundos();
+    for (int i = 0; i < LLAMADAS; i++)
+        if (read(fd, &b, 1) != 1)
+            break;
+    double us = (segundos() - t0) * 1e6 / LLAMADAS;
+    close(fd);
+    return us;
+}
+
+// -------------------- Camino de wiringPi --------------------
+// myAnalogRead() de pcf8591.c: wiringPiI2CWrite(control), y dos wiringPiI2CRead
+static int leerWiringPi(const busI2c_t *bus, int canal) {
+    uint8_t control = (uint8_t)(PCF_SALIDA | canal), v;
+    bus->transferir(bus->ctx, &control, 1, NULL, 0);
+    bus->transferir(bus->ctx, NULL, 0, &v, 1);
+    bus->transferir(bus->ctx, NULL, 0, &v, 1);
+    return v;
+}
+
+// Muestras por segundo (canal-lecturas) con el bus a 'hz' y 'us' por llamada.
+// 'canales' > 0: wiringPi; si no, ráfagas de 'juegos'. Devuelve 1 si algún valor vino mal.
+static int comparar(long hz, double us, int canales, int juegos, double *porSegundo) {
+    busI2c_t bus;
+    pcfFalso_t f;
+    int errores = 0, lecturas;
+
+    pcf_falso(&f, &bus, medir, NULL);
+    for (int vuelta = 0; vuelta < 10; vuelta++) {
+        generacion = vuelta;
+        if (canales > 0) {
+            for (int c = 0; c < canales; c++)
+                errores += leerWiringPi(&bus, c) != medir(NULL, c);
+        } else {
+            uint8_t v[PCF_JUEGOS_MAX][PCF_CANALES];
+            pcf_rafaga(&bus, v, juegos, NULL);
+            for (int j = 0; j < juegos; j++)
+                for (int c = 0; c < PCF_CANALES; c++)
+                    errores += v[j][c] != medir(NULL, c);
+        }
+    }
+    lecturas = 10 * (canales > 0 ? canales : juegos * PCF_CANALES);
+
+    double s = (double)f.bits / hz + f.transferencias * us / 1e6;
+    *porSegundo = lecturas / s;
+    return errores != 0;
+}
+
+// -------------------- Muestreador en ráfaga --------------------
+static int vivo(int segs) {
+    busI2c_t bus;
+    pcfFalso_t f;
+    loteAdc_t l[ADC_LOTES];
+    unsigned int rapido = 0, lento = 0;
+    long recibidos = 0, saltos = 0, retrocesos = 0, malos = 0;
+    uint64_t ultimoT = 0;
+    uint32_t esperado = 0;
+
+    generacion = 0;
+    pcf_falso(&f, &bus, medir, NULL);
+    f.busHz = 400000;
+    if (adc_iniciarRafaga(&bus, HZ_MUESTREO, JUEGOS_VIVO, 50, 2000) != 0) {
+        printf("adc_iniciarRafaga falló\n");
+        return 1;
+    }
+
+    double fin = segundos() + segs;
+    while (segundos() < fin) {
+        usleep(30000);   // el lector rápido pasa cada 30 ms: nunca se atrasa 16 lotes
+        int n = adc_lotes(&rapido, l, ADC_LOTES);
+        for (int i = 0; i < n; i++) {
+            saltos += l[i].numero != esperado;
+            esperado = l[i].numero + 1;
+            retrocesos += l[i].tNs <= ultimoT;
+            ultimoT = l[i].tNs + (uint64_t)(l[i].juegos - 1) * l[i].periodoNs;
+            for (int j = 0; j < l[i].juegos; j++)
+                for (int c = 0; c < PCF_CANALES; c++)
+                    malos += l[i].valores[j][c] != medir(NULL, c);
+            recibidos++;
+        }
+    }
+    int periodo = l[0].periodoNs;
+
+    // El lento recién lee al final: solo ve los últimos ADC_LOTES
+    int nLento = adc_lotes(&lento, l, ADC_LOTES);
+    uint32_t primeroLento = nLento ? l[0].numero : 0;
+
+    // El filtro sigue al canal 0
+    generacion = 100;
+    usleep(300000);
+    int filtrado = adc_filtrado();
+    adc_cerrar();
+
+    printf("Ráfagas de %d juegos a %d Hz por %d s (bus falso a 400 kHz): %ld lotes, %ld saltos, "
+           "%ld marcas que retroceden, %ld valores mal; %.1f us entre juegos\n",
+           JUEGOS_VIVO, HZ_MUESTREO, segs, recibidos, saltos, retrocesos, malos, periodo / 1000.0);
+    printf("Lector lento: %d lotes desde el %u (perdió %u, lo ve en 'numero')\n",
+           nLento, primeroLento, primeroLento);
+    printf("Canal 0 a %d: filtrado %d\n", medir(NULL, 0), filtrado);
+
+    return saltos || retrocesos || malos || recibidos < (long)segs * HZ_MUESTREO / 2 ||
+           primeroLento == 0 || filtrado < medir(NULL, 0) - ADC_HISTERESIS;
+}
+
+int main(int argc, char *argv[]) {
+    int segs = argc > 1 ? atoi(argv[1]) : 2;
+    int fallas = 0;
+    if (segs <= 0)
+        segs = 2;
+
+    double us = llamadaUs();
+    printf("Llamada al sistema: %.2f us por transacción\n", us);
+
+    for (size_t v = 0; v < sizeof(velocidades) / sizeof(velocidades[0]); v++) {
+        long hz = velocidades[v];
+        double uno, cuatro, r1, r8, r32;
+
+        fallas += comparar(hz, us, 1, 0, &uno);
+        fallas += comparar(hz, us, 4, 0, &cuatro);
+        fallas += comparar(hz, us, 0, 1, &r1);
+        fallas += comparar(hz, us, 0, 8, &r8);
+        fallas += comparar(hz, us, 0, 32, &r32);
+        printf("%3ld kHz  wiringPi 1 canal %6.0f/s, 4 canales %6.0f/s | ráfaga x1 %6.0f/s, x8 %6.0f/s, "
+               "x32 %6.0f/s (%.1fx)\n",
+               hz / 1000, uno, cuatro, r1, r8, r32, r32 / cuatro);
+    }
+    if (fallas)
+        printf("%d pasadas trajeron valores equivocados\n", fallas);
+
+    return vivo(segs) || fallas;
+}
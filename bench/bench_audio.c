@@ -0,0 +1,216 @@
+// bench_audio.c
+// Modo de audio (audio.h) sin micrófono:
+//   - FFT en punto fijo contra una DFT en doble precisión, con un tono fuerte
+//     y uno 60 dB más bajo (la normalización por bloque tiene que sostener la
+//     relación señal/ruido), y NEON contra escalar bit a bit donde hay NEON
+//   - costo por bloque de la FFT y del análisis completo, y qué parte de un
+//     núcleo se lleva a 44.1 kHz
+//   - golpes: un bombo a 120 BPM bajo acordes y ruido; cuántos detecta, si
+//     inventa alguno y cuánto tarda desde el golpe hasta la decisión
+//   - lo que tarda el motor en sacar un frame vivo tras motor_refrescar()
+// y al final la latencia del golpe a la luz que resulta.
+//
+// Uso: bench_audio [segundos_de_senal]
+#include "audio.h"
+#include "fft.h"
+#include "motor.h"
+#include "gpio_hal.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BPM        120
+#define CAIDA_MS   200   // la velocidad de la secuencia
+#define VECES      20000
+#define REFRESCOS  500
+
+static const unsigned char pines[8] = {23, 24, 25, 12, 16, 20, 21, 26};
+
+static double segundos(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+// -------------------- Precisión --------------------
+// SNR (dB) de la FFT entera contra la DFT exacta del mismo bloque ventaneado
+static double relacionSenalRuido(double amplitud, const char **nucleoUsado) {
+    int16_t x[FFT_N];
+    fftBloque_t b;
+
+    for (int n = 0; n < FFT_N; n++)
+        x[n] = (int16_t)lround(amplitud * sin(2 * M_PI * 37.3 * n / FFT_N));
+    fft_transformar(x, &b);
+    *nucleoUsado = fft_nucleo();
+
+    double escala = ldexp(1.0, b.corrimiento) / FFT_N, senal = 0, ruido = 0;
+    for (int k = 0; k < FFT_BINS; k++) {
+        double re = 0, im = 0;
+        for (int n = 0; n < FFT_N; n++) {
+            double w = 0.5 - 0.5 * cos(2 * M_PI * n / FFT_N);
+            re += x[n] * w * cos(2 * M_PI * k * n / FFT_N);
+            im -= x[n] * w * sin(2 * M_PI * k * n / FFT_N);
+        }
+        re *= escala;
+        im *= escala;
+        senal += re * re + im * im;
+        ruido += (re - b.re[k]) * (re - b.re[k]) + (im - b.im[k]) * (im - b.im[k]);
+    }
+    return 10 * log10(senal / (ruido > 0 ? ruido : 1e-12));
+}
+
+static int nucleosIguales(void) {
+    int16_t x[FFT_N];
+    fftBloque_t a, b;
+    unsigned int semilla = 7;
+
+    for (int n = 0; n < FFT_N; n++)
+        x[n] = (int16_t)(rand_r(&semilla) % 40000 - 20000);
+    fft_usarEscalar(1);
+    fft_transformar(x, &a);
+    fft_usarEscalar(0);
+    fft_transformar(x, &b);
+    return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+// -------------------- Señal de prueba --------------------
+// Bombo de 55 Hz que decae en ~60 ms, acordes que cambian cada compás y ruido
+static int16_t *armarSenal(int hz, int total, int *golpes, int *inicios) {
+    int16_t *s = malloc(sizeof(int16_t) * (size_t)total);
+    int periodo = hz * 60 / BPM, n = 0;
+    unsigned int semilla = 1;
+    static const double acordes[4][3] = {
+        { 261.6, 329.6, 392.0 }, { 220.0, 261.6, 329.6 },
+        { 174.6, 220.0, 261.6 }, { 196.0, 246.9, 293.7 },
+    };
+
+    for (int i = 0; i < total; i++) {
+        int fase = i % periodo;
+        double t = (double)fase / hz;
+        double v = 14000 * exp(-t / 0.06) * sin(2 * M_PI * 55 * t);
+
+        const double *acorde = acordes[i / (periodo * 4) % 4];
+        for (int j = 0; j < 3; j++)
+            v += 1500 * sin(2 * M_PI * acorde[j] * i / hz);
+        v += (double)(rand_r(&semilla) % 1200) - 600;
+        s[i] = (int16_t)(v > 32767 ? 32767 : v < -32768 ? -32768 : v);
+
+        if (fase == 0)
+            inicios[n++] = i;
+    }
+    *golpes = n;
+    return s;
+}
+
+// -------------------- Refresco del motor --------------------
+static _Atomic uint8_t vivo = 0;
+static const paso_t pasoVivo[1] = { { 0x00, 2, 0 } };
+static const programa_t programaVivo = {
+    .nombre = "vivo", .pasos = pasoVivo, .cantPasos = 1, .bucle = 1, .delayMs = 1000, .vivo = &vivo,
+};
+
+static void medirRefresco(double *promedioUs, double *maximoUs) {
+    frameInfo_t fi;
+    double total = 0, peor = 0;
+
+    hal_iniciar(HAL_SIMULADO, pines, 8);
+    int id = motor_registrar(&programaVivo);
+    motor_iniciar();
+    motor_reproducir(id, 1000);
+
+    for (int i = 0; i < REFRESCOS; i++) {
+        uint8_t v = (uint8_t)(i % 255 + 1);
+        double t0 = segundos();
+        atomic_store(&vivo, v);
+        motor_refrescar();
+        while (!(motor_leerFrame(&fi) && fi.frame == v))
+            ;
+        double us = (segundos() - t0) * 1e6;
+        total += us;
+        if (us > peor)
+            peor = us;
+        usleep(2000);   // como entre dos saltos de audio
+    }
+    motor_detener();
+    motor_cerrar();
+    hal_cerrar();
+    *promedioUs = total / REFRESCOS;
+    *maximoUs = peor;
+}
+
+int main(int argc, char *argv[]) {
+    int segs = argc > 1 ? atoi(argv[1]) : 30;
+    if (segs <= 0)
+        segs = 30;
+
+    fft_iniciar();
+    const char *nucleo;
+    double snrFuerte = relacionSenalRuido(20000, &nucleo);
+    double snrBajo = relacionSenalRuido(20, &nucleo);
+    printf("FFT %d puntos en Q15 (%s): SNR %.1f dB a -4 dBFS, %.1f dB a -64 dBFS\n",
+           FFT_N, nucleo, snrFuerte, snrBajo);
+    if (strcmp(nucleo, "NEON") == 0)
+        printf("NEON y escalar dan %s\n", nucleosIguales() ? "lo mismo bit a bit" : "DISTINTO");
+
+    // Costo
+    int hz = AUDIO_HZ, total = hz * segs, golpes, *inicios = malloc(sizeof(int) * (size_t)(segs * 4 + 1));
+    int16_t *senal = armarSenal(hz, total, &golpes, inicios);
+    analisisAudio_t a;
+    fftBloque_t b;
+
+    double t0 = segundos();
+    for (int i = 0; i < VECES; i++)
+        fft_transformar(senal + (i * AUDIO_SALTO) % (total - FFT_N), &b);
+    double usFft = (segundos() - t0) * 1e6 / VECES;
+
+    // Golpes: se cuenta dónde termina el salto en que se detectó cada uno
+    audio_analisisIniciar(&a, hz);
+    int saltos = total / AUDIO_SALTO, detectados = 0, falsos = 0, siguiente = 0;
+    double latTotal = 0, latMax = 0;
+    long anteriores = 0;
+
+    t0 = segundos();
+    for (int i = 0; i < saltos; i++) {
+        audio_analizar(&a, senal + i * AUDIO_SALTO, CAIDA_MS);
+        if (a.golpes == anteriores)
+            continue;
+        anteriores = a.golpes;
+
+        int fin = (i + 1) * AUDIO_SALTO;
+        while (siguiente + 1 < golpes && inicios[siguiente + 1] <= fin)
+            siguiente++;
+        double ms = (fin - inicios[siguiente]) * 1000.0 / hz;
+        if (ms > 60) {
+            falsos++;
+            continue;
+        }
+        detectados++;
+        latTotal += ms;
+        if (ms > latMax)
+            latMax = ms;
+    }
+    double usAnalisis = (segundos() - t0) * 1e6 / saltos;
+    double usSalto = AUDIO_SALTO * 1e6 / hz;
+
+    printf("Por bloque: FFT %.1f us, análisis completo %.1f us de %.0f us entre bloques (%.2f%% de un núcleo)\n",
+           usFft, usAnalisis, usSalto, usAnalisis / usSalto * 100);
+    printf("Golpes a %d BPM en %d s: %d de %d detectados, %d falsos; del golpe a la decisión %.1f ms (máx %.1f)\n",
+           BPM, segs, detectados, golpes, falsos, detectados ? latTotal / detectados : 0, latMax);
+
+    double refrescoUs, refrescoMaxUs;
+    medirRefresco(&refrescoUs, &refrescoMaxUs);
+    printf("Refresco del motor tras motor_refrescar(): %.0f us (máx %.0f)\n", refrescoUs, refrescoMaxUs);
+
+    // La decisión ya incluye esperar a que se complete el salto
+    printf("Del golpe a la luz: %.1f ms (máx %.1f): decisión + análisis + refresco; límite 20 ms\n",
+           (detectados ? latTotal / detectados : 0) + (usAnalisis + refrescoUs) / 1000,
+           latMax + (usAnalisis + refrescoMaxUs) / 1000);
+
+    free(senal);
+    free(inicios);
+    return detectados * 10 < golpes * 9 || falsos > golpes / 10;
+}
@@ -0,0 +1,243 @@
+// bench_control.c
+// Prueba de carga del servidor de control (control.h): cientos de conexiones
+// locales por el socket Unix, cada una con una trama en vuelo a la vez
+// (consultas y cambios de velocidad), mientras el hilo de salida reproduce
+// una secuencia a 20 ms.
+//
+// Reporta tramas por segundo, latencia por trama (p50/p99/máximo) y el atraso
+// de los frames de LEDs con y sin la carga, que es lo que no se tiene que
+// mover: el servidor corre en el hilo de la interfaz, nunca en el de salida.
+//
+// Una tercera corrida baja el brillo (el hilo pasa a BAM y mira su cola una
+// vez por ciclo) y mezcla selecciones con consulta: esas respuestas esperan
+// al hilo de salida, pero el resto de los clientes no tiene que notarlo.
+//
+// Uso: bench_control [conexiones] [ms]
+#include "control.h"
+#include "protocolo.h"
+#include "reactor.h"
+#include "motor.h"
+#include "gpio_hal.h"
+#include "secuencias.h"
+#include "reloj.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/resource.h>
+
+#define DELAY_SECUENCIA 20
+#define MAX_MUESTRAS    (1 << 20)
+
+int modoRemoto = 0;   // secuencias.c lo toma de main.c
+
+typedef struct {
+    int fd;
+    protoLector_t lector;
+    uint8_t seq;
+    double enviado;
+} conexion_t;
+
+static char rutaSocket[64];
+static int cantConexiones = 400;
+static int duracionMs = 2000;
+static atomic_int terminar = 0;
+static int conSelecciones = 0;
+
+static double *muestras;
+static long cantMuestras = 0;
+static long fallidas = 0;
+
+static double segundos(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static int compararDouble(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static int enviar(conexion_t *c) {
+    // Una de cada ocho es un cambio de velocidad (al mismo valor, para que el
+    // atraso medido sea comparable con la corrida sin carga)
+    static const uint8_t consultar[] = { PROTO_CONSULTAR };
+    static const uint8_t velocidad[] = { PROTO_VELOCIDAD, DELAY_SECUENCIA, 0 };
+    static const uint8_t seleccion[] = { PROTO_SELECCIONAR, SEC_AUTO, 0, DELAY_SECUENCIA, 0, PROTO_CONSULTAR };
+    uint8_t trama[PROTO_MAX_TRAMA];
+    size_t n = (c->seq & 7) != 7 ? proto_armar(trama, c->seq, consultar, sizeof(consultar))
+             : conSelecciones    ? proto_armar(trama, c->seq, seleccion, sizeof(seleccion))
+                                 : proto_armar(trama, c->seq, velocidad, sizeof(velocidad));
+
+    c->enviado = segundos();
+    return write(c->fd, trama, n) == (ssize_t)n ? 0 : 1;
+}
+
+static void *clientes(void *arg) {
+    conexion_t *con = calloc(cantConexiones, sizeof(conexion_t));
+    int ep = epoll_create1(0);
+    struct sockaddr_un dir;
+    (void)arg;
+
+    memset(&dir, 0, sizeof(dir));
+    dir.sun_family = AF_UNIX;
+    strcpy(dir.sun_path, rutaSocket);
+
+    int abiertas = 0;
+    for (int i = 0; i < cantConexiones; i++) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || connect(fd, (struct sockaddr *)&dir, sizeof(dir)) != 0) {
+            if (fd >= 0)
+                close(fd);
+            break;
+        }
+        con[i].fd = fd;
+        proto_lectorIniciar(&con[i].lector);
+
+        struct epoll_event ev = { .events = EPOLLIN, .data.u32 = (uint32_t)i };
+        epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev);
+        abiertas++;
+    }
+    printf("%d conexiones abiertas\n", abiertas);
+
+    for (int i = 0; i < abiertas; i++)
+        enviar(&con[i]);
+
+    double fin = segundos() + duracionMs / 1000.0;
+    struct epoll_event evs[64];
+
+    while (segundos() < fin) {
+        int n = epoll_wait(ep, evs, 64, 100);
+        for (int e = 0; e < n; e++) {
+            conexion_t *c = &con[evs[e].data.u32];
+            uint8_t buf[256];
+            ssize_t leidos = read(c->fd, buf, sizeof(buf));
+
+            if (leidos <= 0) {
+                fallidas++;
+                epoll_ctl(ep, EPOLL_CTL_DEL, c->fd, NULL);
+                continue;
+            }
+            for (ssize_t k = 0; k < leidos; k++) {
+                if (proto_leer(&c->lector, buf[k]) != 1 || proto_seq(&c->lector) != c->seq)
+                    continue;
+
+                if (cantMuestras < MAX_MUESTRAS)
+                    muestras[cantMuestras++] = (segundos() - c->enviado) * 1e6;
+                c->seq++;
+                if (enviar(c) != 0)
+                    fallidas++;
+            }
+        }
+    }
+
+    for (int i = 0; i < abiertas; i++)
+        close(con[i].fd);
+    close(ep);
+    free(con);
+
+    atomic_store(&terminar, 1);
+    return NULL;
+}
+
+static relojFrames_t correrSecuencia(int conCarga) {
+    motor_reproducir(SEC_AUTO, DELAY_SECUENCIA);
+
+    if (conCarga) {
+        pthread_t hilo;
+        pthread_create(&hilo, NULL, clientes, NULL);
+        while (!atomic_load(&terminar))
+            reactor_esperar(100);   // el servidor se atiende acá adentro
+        pthread_join(hilo, NULL);
+    } else {
+        usleep(duracionMs * 1000);
+    }
+
+    motor_detener();
+    return *motor_reloj();
+}
+
+static void informar(void) {
+    if (cantMuestras == 0)
+        return;
+
+    double suma = 0;
+    for (long i = 0; i < cantMuestras; i++)
+        suma += muestras[i];
+    qsort(muestras, cantMuestras, sizeof(double), compararDouble);
+
+    printf("%ld tramas en %d ms: %.0f tramas/s, latencia %.1f/%.1f/%.1f/%.1f us (prom/p50/p99/max), fallidas %ld\n",
+           cantMuestras, duracionMs, cantMuestras * 1000.0 / duracionMs, suma / cantMuestras,
+           muestras[cantMuestras / 2], muestras[cantMuestras * 99 / 100], muestras[cantMuestras - 1], fallidas);
+}
+
+static void imprimirReloj(const char *nombre, const relojFrames_t *r) {
+    printf("%-10s frames %5ld  atraso %5ld/%6ld us  [", nombre, r->frames, reloj_atrasoPromedioUs(r), r->atrasoMaxUs);
+    for (int c = 0; c < RELOJ_CASILLEROS; c++)
+        printf("%s%ld", c ? " " : "", r->histograma[c]);
+    printf("]%s\n", r->resincronizaciones ? " RESINCRONIZÓ" : "");
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1)
+        cantConexiones = atoi(argv[1]);
+    if (argc > 2)
+        duracionMs = atoi(argv[2]);
+    if (cantConexiones <= 0 || cantConexiones > CONTROL_MAX_CLIENTES || duracionMs <= 0) {
+        fprintf(stderr, "Uso: %s [conexiones (hasta %d)] [ms]\n", argv[0], CONTROL_MAX_CLIENTES);
+        return 1;
+    }
+
+    // Dos fds por conexión (cliente y servidor) en el mismo proceso
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+
+    snprintf(rutaSocket, sizeof(rutaSocket), "/tmp/bench_control.%d", (int)getpid());
+    muestras = malloc(sizeof(double) * MAX_MUESTRAS);
+
+    if (hal_iniciar(HAL_SIMULADO, LEDS, 8) != 0 || reactor_iniciar() != 0) {
+        fprintf(stderr, "No se pudo iniciar el HAL o el reactor\n");
+        return 1;
+    }
+    secuencias_iniciar(NULL);
+    if (motor_iniciar() != 0 || control_iniciar(rutaSocket, 0, NULL) != 0) {
+        fprintf(stderr, "No se pudo iniciar el hilo de salida o el servidor\n");
+        return 1;
+    }
+    reactor_fuentes(0);
+
+    relojFrames_t sinCarga = correrSecuencia(0);
+    relojFrames_t conCarga = correrSecuencia(1);
+    informar();
+    printf("servidor: %lu tramas, %lu desconectados por no leer\n", control_tramas(), control_desconectados());
+    imprimirReloj("sin carga", &sinCarga);
+    imprimirReloj("con carga", &conCarga);
+
+    // BAM: brillo a la mitad, una de cada ocho tramas selecciona y consulta
+    cantMuestras = fallidas = 0;
+    atomic_store(&terminar, 0);
+    conSelecciones = 1;
+    motor_configurarIntensidad(MOTOR_BRILLO_MAX / 2, 0);
+    correrSecuencia(1);
+    printf("con BAM y selecciones: ");
+    informar();
+    printf("con BAM    %lu ciclos de BAM\n", motor_ciclosBam());
+
+    control_cerrar();
+    motor_cerrar();
+    hal_cerrar();
+    free(muestras);
+    return 0;
+}
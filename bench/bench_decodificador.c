@@ -0,0 +1,149 @@
+// bench_decodificador.c
+// Rendimiento del decodificador de entrada con tráfico sintético: texto,
+// flechas (ESC [ A / ESC O B), CRLF y borrados, partido en bloques de tamaño
+// variable para que muchas secuencias queden cortadas entre dos lecturas.
+//
+// Mide el decodificador solo (MB/s, teclas/s) y el camino completo por un
+// pipe con entrada_siguiente() (read() por byte contra read() por bloque).
+#include "decodificador.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define LARGO_DATOS (16u << 20)   // 16 MB
+#define LARGO_PIPE  (4u << 20)
+
+static char *datos;
+
+static double segundos(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+// Genera la entrada y devuelve cuántas flechas se escribieron
+static size_t generar(char *p, size_t n) {
+    static const char *piezas[] = { "\033[A", "\033[B", "\033OA", "3\r\n", "q", "abc", "\177", "\r", "\033[1;5C" };
+    size_t i = 0, flechas = 0;
+    unsigned int semilla = 12345;
+
+    while (i < n) {
+        int k = rand_r(&semilla) % 9;
+        size_t largo = strlen(piezas[k]);
+        if (i + largo > n)
+            break;
+        memcpy(p + i, piezas[k], largo);
+        i += largo;
+        if (k <= 2)
+            flechas++;
+    }
+    memset(p + i, 'x', n - i);
+    return flechas;
+}
+
+static void benchDecodificador(size_t flechasEsperadas) {
+    decodificador_t d;
+    tecla_t teclas[256];
+    size_t flechas = 0, total = 0;
+    unsigned int semilla = 99;
+
+    dec_iniciar(&d);
+    double t0 = segundos();
+
+    size_t i = 0;
+    while (i < LARGO_DATOS) {
+        size_t bloque = 1 + rand_r(&semilla) % 64;   // ráfagas como las del UART
+        if (bloque > LARGO_DATOS - i)
+            bloque = LARGO_DATOS - i;
+
+        size_t usados = 0;
+        while (usados < bloque) {
+            size_t consumidos;
+            size_t n = dec_alimentar(&d, datos + i + usados, bloque - usados, teclas, 256, &consumidos);
+            for (size_t k = 0; k < n; k++)
+                if (teclas[k].tipo == TEC_ARRIBA || teclas[k].tipo == TEC_ABAJO)
+                    flechas++;
+            total += n;
+            usados += consumidos;
+        }
+        i += bloque;
+    }
+
+    double dt = segundos() - t0;
+    printf("decodificador: %.1f MB/s, %.1f Mteclas/s, flechas %zu/%zu %s\n",
+           LARGO_DATOS / dt / 1e6, total / dt / 1e6, flechas, flechasEsperadas,
+           flechas == flechasEsperadas ? "OK" : "ERROR");
+}
+
+static void *escritor(void *arg) {
+    int fd = *(int *)arg;
+    size_t i = 0;
+    while (i < LARGO_PIPE) {
+        ssize_t n = write(fd, datos + i, LARGO_PIPE - i > 4096 ? 4096 : LARGO_PIPE - i);
+        if (n <= 0)
+            break;
+        i += (size_t)n;
+    }
+    close(fd);
+    return NULL;
+}
+
+// Lee LARGO_PIPE bytes por un pipe con read() de 'bloque' bytes
+static void benchPipe(size_t bloque) {
+    int p[2];
+    if (pipe(p) != 0)
+        return;
+
+    pthread_t h;
+    pthread_create(&h, NULL, escritor, &p[1]);
+
+    double t0 = segundos();
+    unsigned long lecturas = 0;
+    size_t teclas = 0;
+
+    if (bloque == 1) {
+        // Como el manejarTeclado anterior: un read() por byte
+        decodificador_t d;
+        tecla_t t;
+        char c;
+        dec_iniciar(&d);
+        while (read(p[0], &c, 1) == 1) {
+            lecturas++;
+            teclas += dec_byte(&d, (uint8_t)c, &t);
+        }
+    } else {
+        entrada_t e;
+        tecla_t t;
+        entrada_iniciar(&e, p[0]);
+        while (entrada_siguiente(&e, &t) > 0)
+            teclas++;
+        lecturas = e.lecturas;
+    }
+
+    double dt = segundos() - t0;
+    pthread_join(h, NULL);
+    close(p[0]);
+
+    printf("pipe, read() de %4zu: %7.1f MB/s, %8lu read(), %.2f bytes por read()\n",
+           bloque, LARGO_PIPE / dt / 1e6, lecturas, (double)LARGO_PIPE / lecturas);
+    (void)teclas;
+}
+
+int main(void) {
+    datos = malloc(LARGO_DATOS);
+    if (!datos)
+        return 1;
+
+    size_t flechas = generar(datos, LARGO_DATOS);
+    benchDecodificador(flechas);
+    benchPipe(1);
+    benchPipe(ENTRADA_BUFFER);
+
+    free(datos);
+    return 0;
+}
@@ -0,0 +1,135 @@
+// bench_estado.c
+// Archivo de estado persistente (estado.h): cuánto cuesta abrirlo y guardar
+// una velocidad, comparado con reescribir un archivo de texto por cambio
+// (con y sin fsync), y qué queda después de una escritura cortada.
+//
+// La prueba de corte pisa a mano, en el archivo, la palabra del registro más
+// nuevo de una clave (lo que deja un corte de luz a mitad de la escritura) y
+// vuelve a abrir: tiene que aparecer el valor anterior, nunca basura.
+//
+// Uso: bench_estado [escrituras]
+#include "estado.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define LARGO_CABECERA 16   // ver estado.c
+
+static char ruta[64];
+
+static double segundos(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static double medirApertura(void) {
+    double t0 = segundos();
+    int r = estado_abrir(ruta);
+    double us = (segundos() - t0) * 1e6;
+
+    if (r != 0) {
+        perror(ruta);
+        exit(1);
+    }
+    return us;
+}
+
+// La alternativa: un archivo de texto con todas las velocidades por cambio
+static double reescribir(int veces, int conFsync) {
+    char rutaTexto[80];
+    snprintf(rutaTexto, sizeof(rutaTexto), "%s.txt", ruta);
+
+    double t0 = segundos();
+    for (int i = 0; i < veces; i++) {
+        FILE *f = fopen(rutaTexto, "w");
+        if (!f)
+            return -1;
+        for (int id = 0; id < 8; id++)
+            fprintf(f, "%d %d\n", id, 100 + (i + id) % 900);
+        fflush(f);
+        if (conFsync)
+            fsync(fileno(f));
+        fclose(f);
+    }
+    double us = (segundos() - t0) * 1e6 / veces;
+    unlink(rutaTexto);
+    return us;
+}
+
+// Pisa con basura la copia de 'clave' que tiene 'valor'; 1 si la encontró
+static int cortarEscritura(int clave, int valor) {
+    int fd = open(ruta, O_RDWR);
+    uint8_t copias[16];
+    off_t pos = LARGO_CABECERA + (off_t)clave * sizeof(copias);
+    int hecho = 0;
+
+    if (fd < 0 || pread(fd, copias, sizeof(copias), pos) != (ssize_t)sizeof(copias)) {
+        if (fd >= 0)
+            close(fd);
+        return 0;
+    }
+    for (int s = 0; s < 2 && !hecho; s++) {
+        if ((copias[8 * s] | copias[8 * s + 1] << 8) != valor)
+            continue;
+        // Media palabra nueva y media vieja, como un store de 64 bits partido en dos
+        copias[8 * s + 6] ^= 0xA5;
+        copias[8 * s + 7] ^= 0x5A;
+        hecho = pwrite(fd, copias, sizeof(copias), pos) == (ssize_t)sizeof(copias);
+    }
+    close(fd);
+    return hecho;
+}
+
+int main(int argc, char **argv) {
+    int escrituras = argc > 1 ? atoi(argv[1]) : 1000000;
+    if (escrituras <= 0) {
+        fprintf(stderr, "Uso: %s [escrituras]\n", argv[0]);
+        return 1;
+    }
+    snprintf(ruta, sizeof(ruta), "/tmp/bench_estado.%d", (int)getpid());
+
+    double nuevo = medirApertura();
+    estado_cerrar();
+    double existente = medirApertura();
+    printf("abrir: %.1f us la primera vez (formatea), %.1f us con el archivo ya hecho\n", nuevo, existente);
+
+    // Una velocidad por escritura, rotando entre las 8 secuencias
+    double t0 = segundos();
+    for (int i = 0; i < escrituras; i++)
+        estado_guardar(ESTADO_VELOCIDAD(i & 7), 100 + i % 900);
+    double nsGuardar = (segundos() - t0) * 1e9 / escrituras;
+
+    t0 = segundos();
+    estado_sincronizar();
+    double usSync = (segundos() - t0) * 1e6;
+
+    printf("guardar: %.1f ns por velocidad; msync de todo el archivo %.0f us\n", nsGuardar, usSync);
+    printf("reescribir texto: %.1f us por cambio, %.1f us con fsync\n",
+           reescribir(20000, 0), reescribir(200, 1));
+
+    // Corte a mitad de escritura: 250 -> 300 y se rompe la copia con 300
+    int clave = ESTADO_VELOCIDAD(3);
+    estado_guardar(clave, 250);
+    estado_guardar(clave, 300);
+    estado_cerrar();
+
+    int cortado = cortarEscritura(clave, 300);
+    medirApertura();
+    printf("corte: %s, al reabrir %d (esperado 250), %d registros descartados\n",
+           cortado ? "copia nueva rota" : "NO SE ENCONTRÓ LA COPIA", estado_leer(clave), estado_descartados());
+
+    // Y se sigue escribiendo sobre la copia rota
+    estado_guardar(clave, 320);
+    estado_cerrar();
+    medirApertura();
+    printf("después del corte: %d (esperado 320)\n", estado_leer(clave));
+
+    estado_cerrar();
+    unlink(ruta);
+    return 0;
+}
@@ -0,0 +1,120 @@
+// bench_grabador.c
+// Grabador de frames (grabador.h): cuánto le agrega a cada escritura del HAL
+// y cuántos bytes ocupa un frame, con patrones de secuencia estirados a 8,
+// 64 y 512 canales y con frames completos de 512 canales que cambian de a
+// poco. Cada grabación se vuelve a leer con el lector y tiene que dar los
+// mismos frames, en el mismo orden.
+//
+// Uso: bench_grabador [frames]
+#include "grabador.h"
+#include "frame.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static char ruta[64];
+
+static double segundos(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+// El frame 'i' de la prueba: un patrón que corre (como una secuencia) o,
+// con 'completos', un frame ancho donde cambian un par de canales por vez
+static uint8_t patron(int i) {
+    return (uint8_t)(1u << (i % 8) | (i / 64 % 2 ? 0x81 : 0));
+}
+
+static void armarCompleto(int i, frame_t *f) {
+    frame_limpiar(f);
+    for (int c = i % 480; c < i % 480 + 32; c++)
+        frame_poner(f, c, 1);
+}
+
+static int verificar(int canales, int completos, int frames, off_t *tamanio) {
+    int fd = open(ruta, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        perror(ruta);
+        exit(1);
+    }
+    *tamanio = st.st_size;
+    const grabCabecera_t *c = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (c == MAP_FAILED) {
+        perror("mmap");
+        exit(1);
+    }
+
+    lectorGrab_t l;
+    frame_t f;
+    int n = 0, ok = c->canales == canales;
+
+    grab_lector(&l, c, (const uint8_t *)(c + 1), c->largo);
+    while (ok && grab_siguiente(&l) == 1) {
+        if (completos)
+            armarCompleto(n % 1024, &f);
+        else
+            frame_estirar(patron(n), canales, &f);
+        for (int k = 0; k < canales / 8; k++)
+            ok &= l.frame[k] == frame_byte(&f, k);
+        n++;
+    }
+    munmap((void *)c, (size_t)st.st_size);
+    return ok && n == frames;
+}
+
+static void medir(int canales, int completos, int frames) {
+    static frame_t *anchos;
+    if (!anchos) {
+        anchos = malloc(sizeof(frame_t) * 1024);
+        for (int i = 0; i < 1024; i++)
+            armarCompleto(i, &anchos[i]);
+    }
+
+    if (grab_abrir(ruta, canales) != 0) {
+        perror(ruta);
+        exit(1);
+    }
+    double t0 = segundos();
+    for (int i = 0; i < frames; i++) {
+        if (completos)
+            grab_canales(&anchos[i % 1024]);
+        else
+            grab_patron(patron(i));
+    }
+    double ns = (segundos() - t0) * 1e9 / frames;
+    grab_cerrar();
+
+    off_t tamanio;
+    int ok = verificar(canales, completos, frames, &tamanio);
+    printf("%-22s %4d canales  %7.1f ns/frame  %6.2f bytes/frame  %s\n",
+           completos ? "frames completos" : "patrones estirados", canales, ns,
+           (double)(tamanio - (off_t)sizeof(grabCabecera_t)) / frames, ok ? "ok" : "NO COINCIDE");
+    if (!ok)
+        exit(1);
+}
+
+int main(int argc, char *argv[]) {
+    int frames = argc > 1 ? atoi(argv[1]) : 1000000;
+    if (frames <= 0)
+        frames = 1000000;
+
+    snprintf(ruta, sizeof(ruta), "/tmp/bench_grabador.%d", (int)getpid());
+    printf("%d frames por prueba\n", frames);
+
+    medir(8, 0, frames);
+    medir(64, 0, frames);
+    medir(512, 0, frames);
+    medir(512, 1, frames);
+
+    unlink(ruta);
+    return 0;
+}
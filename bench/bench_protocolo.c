@@ -0,0 +1,227 @@
+// bench_protocolo.c
+// Latencia ida y vuelta del protocolo binario de control (protocolo.h) a
+// través de un PTY que hace de puente Arduino: el hilo principal es el lado
+// del programa (reactor + entradaSerial con proto_byte + uart_tx + motor) y
+// un segundo hilo es el controlador del PC escribiendo tramas en el maestro.
+//
+// Reporta por tipo de trama el tiempo hasta la respuesta (promedio, p50, p99,
+// máximo), los comandos por segundo, y lo que tardarían esos bytes en un
+// UART real a 38400 baudios, que en la placa domina sobre todo lo demás.
+//
+// Uso: bench_protocolo [tramas_por_prueba]
+#define _GNU_SOURCE
+#include "protocolo.h"
+#include "decodificador.h"
+#include "reactor.h"
+#include "uart_tx.h"
+#include "motor.h"
+#include "gpio_hal.h"
+#include "secuencias.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <termios.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define BAUDIOS 38400
+
+int modoRemoto = 1;   // secuencias.c lo toma de main.c
+
+static int maestro = -1;
+static atomic_int terminar = 0;
+static int tramasPorPrueba = 2000;
+
+static double segundos(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static int compararDouble(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Espera la respuesta con 'seq'; devuelve el resultado o -1 si no llegó
+static int esperarRespuesta(protoLector_t *l, uint8_t seq, uint8_t *estado) {
+    struct pollfd pfd = { .fd = maestro, .events = POLLIN };
+    uint8_t buf[256];
+
+    while (poll(&pfd, 1, 1000) > 0) {
+        ssize_t n = read(maestro, buf, sizeof(buf));
+        if (n <= 0)
+            return -1;
+
+        for (ssize_t i = 0; i < n; i++) {
+            if (proto_leer(l, buf[i]) != 1 || proto_seq(l) != seq)
+                continue;
+
+            int largo;
+            const uint8_t *c = proto_carga(l, &largo);
+            if (largo < 3 || c[0] != PROTO_RESPUESTA)
+                continue;
+            if (estado && largo >= 3 + PROTO_LARGO_ESTADO)
+                memcpy(estado, c + 3, PROTO_LARGO_ESTADO);
+            return c[1];
+        }
+    }
+    return -1;
+}
+
+static void prueba(const char *nombre, const uint8_t *carga, size_t n, int comandos, int corromper) {
+    protoLector_t l;
+    uint8_t trama[PROTO_MAX_TRAMA];
+    double *t = malloc(sizeof(double) * tramasPorPrueba);
+    int errores = 0, respuestas = 0;
+    size_t largoTrama = 0;
+
+    proto_lectorIniciar(&l);
+    double inicio = segundos();
+
+    for (int i = 0; i < tramasPorPrueba; i++) {
+        largoTrama = proto_armar(trama, (uint8_t)i, carga, n);
+        if (corromper)
+            trama[largoTrama - 1] ^= 0x5A;
+
+        double t0 = segundos();
+        if (write(maestro, trama, largoTrama) != (ssize_t)largoTrama)
+            break;
+        int r = esperarRespuesta(&l, (uint8_t)i, NULL);
+        t[i] = (segundos() - t0) * 1e6;
+
+        if (r < 0)
+            break;
+        respuestas++;
+        if (r != PROTO_OK)
+            errores++;
+    }
+    double total = segundos() - inicio;
+
+    if (respuestas == 0) {
+        printf("%-34s sin respuesta\n", nombre);
+        free(t);
+        return;
+    }
+
+    double suma = 0;
+    for (int i = 0; i < respuestas; i++)
+        suma += t[i];
+    qsort(t, respuestas, sizeof(double), compararDouble);
+
+    // Trama + respuesta de 3 bytes de carga, 10 bits por byte en el cable
+    double cableUs = (double)(largoTrama + 8) * 10 * 1e6 / BAUDIOS;
+
+    printf("%-34s %6.1f/%6.1f/%6.1f/%7.1f us  %8.0f cmd/s  errores %4d  (a %d baudios: +%.0f us)\n",
+           nombre, suma / respuestas, t[respuestas / 2], t[respuestas * 99 / 100], t[respuestas - 1],
+           comandos * respuestas / total, errores, BAUDIOS, cableUs);
+    free(t);
+}
+
+static void *controlador(void *arg) {
+    (void)arg;
+
+    uint8_t consultar[] = { PROTO_CONSULTAR };
+    uint8_t velocidad[] = { PROTO_VELOCIDAD, 100, 0 };
+    uint8_t seleccionar[] = { PROTO_SELECCIONAR, SEC_AUTO, 0, 50, 0 };
+
+    // Ocho comandos en una sola trama
+    uint8_t lote[] = {
+        PROTO_VELOCIDAD, 120, 0, PROTO_INTENSIDAD, 255, 0,
+        PROTO_VELOCIDAD, 110, 0, PROTO_VELOCIDAD, 100, 0,
+        PROTO_VELOCIDAD, 90, 0,  PROTO_VELOCIDAD, 80, 0,
+        PROTO_VELOCIDAD, 70, 0,  PROTO_CONSULTAR
+    };
+
+    printf("%-34s %s\n", "trama", "promedio/p50/p99/max");
+    prueba("consultar", consultar, sizeof(consultar), 1, 0);
+    prueba("velocidad", velocidad, sizeof(velocidad), 1, 0);
+    prueba("seleccionar (espera al motor)", seleccionar, sizeof(seleccionar), 1, 0);
+    prueba("lote de 8 comandos", lote, sizeof(lote), 8, 0);
+    prueba("crc malo (NAK)", velocidad, sizeof(velocidad), 1, 1);
+
+    // Estado final
+    protoLector_t l;
+    uint8_t trama[PROTO_MAX_TRAMA], crudo[PROTO_LARGO_ESTADO];
+    protoEstado_t e;
+    proto_lectorIniciar(&l);
+    if (write(maestro, trama, proto_armar(trama, 0xEE, consultar, 1)) > 0 &&
+        esperarRespuesta(&l, 0xEE, crudo) == PROTO_OK) {
+        proto_leerEstado(crudo, &e);
+        printf("estado: secuencia %d, delay %u ms, brillo %u, estela %u, %u secuencias, %u frames\n",
+               e.activo, e.delayMs, e.brillo, e.estela, e.cantSecuencias, e.frames);
+    }
+
+    atomic_store(&terminar, 1);
+    if (write(maestro, "\r", 1) < 0) {
+        // solo para despertar al reactor
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1)
+        tramasPorPrueba = atoi(argv[1]);
+    if (tramasPorPrueba <= 0) {
+        fprintf(stderr, "Uso: %s [tramas_por_prueba]\n", argv[0]);
+        return 1;
+    }
+
+    // El PTY hace de puente: el esclavo es el "UART" del programa
+    maestro = posix_openpt(O_RDWR | O_NOCTTY);
+    if (maestro < 0 || grantpt(maestro) != 0 || unlockpt(maestro) != 0) {
+        perror("posix_openpt");
+        return 1;
+    }
+    int esclavo = open(ptsname(maestro), O_RDWR | O_NOCTTY);
+    struct termios tio;
+    if (esclavo < 0 || tcgetattr(esclavo, &tio) != 0) {
+        perror("pts");
+        return 1;
+    }
+    cfmakeraw(&tio);
+    tcsetattr(esclavo, TCSANOW, &tio);
+    tcgetattr(maestro, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(maestro, TCSANOW, &tio);
+
+    if (hal_iniciar(HAL_SIMULADO, LEDS, 8) != 0 || reactor_iniciar() != 0) {
+        fprintf(stderr, "No se pudo iniciar el HAL o el reactor\n");
+        return 1;
+    }
+    secuencias_iniciar(NULL);
+    if (motor_iniciar() != 0) {
+        fprintf(stderr, "No se pudo iniciar el hilo de salida\n");
+        return 1;
+    }
+
+    uart_iniciar(esclavo);
+    entrada_iniciar(&entradaSerial, esclavo);
+    entradaSerial.filtro = proto_byte;
+    reactor_vigilar(EV_SERIAL, esclavo);
+    reactor_fuentes(EV_SERIAL);
+
+    pthread_t hilo;
+    pthread_create(&hilo, NULL, controlador, NULL);
+
+    // Lado del programa: lo mismo que hace leerLineaRemota() esperando una línea
+    tecla_t t;
+    while (!atomic_load(&terminar)) {
+        while (entrada_siguiente(&entradaSerial, &t) > 0) {
+            // el texto se ignora acá
+        }
+        reactor_esperar(100);
+    }
+
+    pthread_join(hilo, NULL);
+    printf("tramas recibidas %lu, descartadas %lu\n", proto_tramasRecibidas(), proto_tramasDescartadas());
+
+    motor_cerrar();
+    hal_cerrar();
+    return 0;
+}
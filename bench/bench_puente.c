@@ -0,0 +1,339 @@
+// bench_puente.c
+// Puente serie del Arduino (puente.h) contra líneas simuladas a 38400
+// baudios, en tiempo virtual: reproduce flujos de bytes típicos (redibujos
+// del menú, comandos pegados desde la PC, las dos puntas saturadas) por el
+// loop() original de ProyectoFinalUART.ino (un byte por sentido por vuelta)
+// y por el núcleo, sin y con flujo, y cuenta lo que llega, lo que se pierde
+// y a qué velocidad.
+//
+// Modelo de la placa:
+//  - Serial por hardware: colas de 64 bytes de entrada y de salida; write()
+//    espera si la salida está llena. La PC manda sin control de flujo (USB).
+//  - SoftwareSerial: recibir un byte ocupa la CPU todo el byte (la
+//    interrupción espera los bits) y transmitir también, con interrupciones
+//    apagadas: lo que la Raspberry empiece a mandar mientras tanto se pierde.
+//    Entrada de 64 bytes.
+//  - La Raspberry respeta el RTS del Arduino con un byte de demora.
+//
+// Uso: bench_puente
+#include "puente.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BAUDIOS    38400
+#define BYTE_US    (10e6 / BAUDIOS)
+#define ISR_US     (BYTE_US * 0.95)   // SoftwareSerial suelta la CPU a mitad del bit de parada
+#define VUELTA_US  10.0    // loop() vacío con sus available()
+#define LEER_US    2.0     // read()/write() de un byte entre colas
+#define COLA_HW    64      // SERIAL_RX/TX_BUFFER_SIZE del core de Arduino
+#define COLA_SOFT  64      // _SS_MAX_RX_BUFF
+#define GUARDA_US  300.0   // la de ProyectoFinalUART.ino
+#define MAX_BYTES  65536
+#define INF        1e300
+
+typedef struct {
+    uint8_t d[COLA_HW > COLA_SOFT ? COLA_HW : COLA_SOFT];
+    int inicio, n, capacidad;
+} cola_t;
+
+// Un sentido: lo que manda un lado (con el momento en que lo tiene listo)
+// y lo que le llega al otro
+typedef struct {
+    uint8_t *datos;
+    double  *listo;
+    int      total;
+    int      siguiente;
+    double   libre;        // cuándo se desocupa la línea
+    uint8_t *llegado;
+    int      llegados;
+    int      perdidos;
+    double   ultimo;       // cuándo llegó el último
+} sentido_t;
+
+static struct {
+    double ahora;
+    sentido_t pcRaspi, raspiPc;
+    cola_t hwRx, hwTx, softRx;
+    double txFin;          // cuándo termina de salir el primero de hwTx
+    int transmitiendo;     // SoftwareSerial escribiendo: interrupciones apagadas
+    int pausado;
+    double pausaDesde;
+} sim;
+
+static double max2(double a, double b) { return a > b ? a : b; }
+
+static int meter(cola_t *c, uint8_t b) {
+    if (c->n == c->capacidad)
+        return 0;
+    c->d[(c->inicio + c->n++) % c->capacidad] = b;
+    return 1;
+}
+
+static uint8_t sacar(cola_t *c) {
+    uint8_t b = c->d[c->inicio];
+    c->inicio = (c->inicio + 1) % c->capacidad;
+    c->n--;
+    return b;
+}
+
+static void entregar(sentido_t *s, uint8_t b, double t) {
+    s->llegado[s->llegados++] = b;
+    s->ultimo = t;
+}
+
+// -------------------- Líneas --------------------
+// Procesa en orden todo lo que pasa en las líneas hasta 'hasta'. Cada byte
+// que entra por SoftwareSerial corre 'hasta' casi un byte: la CPU estuvo en
+// la interrupción.
+static void avanzar(double hasta) {
+    sentido_t *a = &sim.pcRaspi, *b = &sim.raspiPc;
+
+    for (;;) {
+        double tPc = INF, tRaspi = INF, tTx = INF;
+
+        if (a->siguiente < a->total)
+            tPc = max2(a->listo[a->siguiente], a->libre) + BYTE_US;
+        if (b->siguiente < b->total) {
+            double inicio = max2(b->listo[b->siguiente], b->libre);
+            if (!sim.pausado || inicio < sim.pausaDesde + BYTE_US)
+                tRaspi = inicio;
+        }
+        if (sim.hwTx.n)
+            tTx = sim.txFin;
+
+        double t = tPc < tRaspi ? tPc : tRaspi;
+        if (tTx < t)
+            t = tTx;
+        if (t > hasta)
+            break;
+
+        if (t == tTx) {
+            entregar(b, sacar(&sim.hwTx), t);
+            sim.txFin += BYTE_US;
+        } else if (t == tPc) {
+            a->libre = t;
+            if (!meter(&sim.hwRx, a->datos[a->siguiente++]))
+                a->perdidos++;
+        } else {
+            b->libre = t + BYTE_US;
+            uint8_t byte = b->datos[b->siguiente++];
+            if (sim.transmitiendo || !meter(&sim.softRx, byte)) {
+                b->perdidos++;
+            } else {
+                hasta += ISR_US;
+            }
+        }
+    }
+    if (hasta > sim.ahora)
+        sim.ahora = hasta;
+}
+
+// -------------------- Puertos --------------------
+static int pcDisponibles(void *ctx) { (void)ctx; return sim.hwRx.n; }
+static int pcEspacio(void *ctx)     { (void)ctx; return COLA_HW - sim.hwTx.n; }
+
+static int pcLeer(void *ctx) {
+    (void)ctx;
+    avanzar(sim.ahora + LEER_US);
+    return sim.hwRx.n ? sacar(&sim.hwRx) : -1;
+}
+
+static void pcEscribir(void *ctx, const uint8_t *d, int n) {
+    (void)ctx;
+    for (int i = 0; i < n; i++) {
+        while (sim.hwTx.n == COLA_HW)
+            avanzar(sim.txFin);
+        if (sim.hwTx.n == 0)
+            sim.txFin = sim.ahora + BYTE_US;
+        meter(&sim.hwTx, d[i]);
+        avanzar(sim.ahora + LEER_US);
+    }
+}
+
+static int raspiDisponibles(void *ctx) { (void)ctx; return sim.softRx.n; }
+static int raspiEspacio(void *ctx)     { (void)ctx; return PUENTE_RAFAGA; }
+
+static int raspiLeer(void *ctx) {
+    (void)ctx;
+    avanzar(sim.ahora + LEER_US);
+    return sim.softRx.n ? sacar(&sim.softRx) : -1;
+}
+
+static void raspiEscribir(void *ctx, const uint8_t *d, int n) {
+    (void)ctx;
+    for (int i = 0; i < n; i++) {
+        sim.transmitiendo = 1;
+        avanzar(sim.ahora + BYTE_US);
+        sim.transmitiendo = 0;
+        entregar(&sim.pcRaspi, d[i], sim.ahora);
+    }
+}
+
+static void raspiPausar(void *ctx, uint8_t pausa) {
+    (void)ctx;
+    avanzar(sim.ahora);
+    if (pausa && !sim.pausado) {
+        sim.pausado = 1;
+        sim.pausaDesde = sim.ahora;
+        avanzar(sim.ahora + GUARDA_US);
+    } else if (!pausa && sim.pausado) {
+        sim.pausado = 0;
+        sim.raspiPc.libre = max2(sim.raspiPc.libre, sim.ahora);
+    }
+}
+
+// El loop() de antes
+static void loopViejo(void) {
+    if (pcDisponibles(NULL)) {
+        uint8_t c = (uint8_t)pcLeer(NULL);
+        raspiEscribir(NULL, &c, 1);
+    }
+    if (raspiDisponibles(NULL)) {
+        uint8_t c = (uint8_t)raspiLeer(NULL);
+        pcEscribir(NULL, &c, 1);
+    }
+}
+
+// -------------------- Escenarios --------------------
+static uint32_t semilla;
+
+// n bytes de texto que el lado tiene listos en t (ms)
+static void agregar(sentido_t *s, double ms, int n) {
+    for (int i = 0; i < n && s->total < MAX_BYTES; i++) {
+        semilla = semilla * 1103515245u + 12345u;
+        s->datos[s->total] = (uint8_t)(' ' + (semilla >> 16) % 95);
+        s->listo[s->total++] = ms * 1000.0;
+    }
+}
+
+// El programa redibuja el menú (~1.5 KB) cada medio segundo; el usuario
+// aprieta una tecla cada 250 ms
+static void escMenu(sentido_t *pc, sentido_t *raspi) {
+    for (int i = 0; i < 6; i++)
+        agregar(raspi, i * 500.0, 1500);
+    for (int i = 0; i < 12; i++)
+        agregar(pc, 100.0 + i * 250.0, 1);
+}
+
+// Se pegan dos bloques de comandos mientras la Raspberry contesta
+static void escPegado(sentido_t *pc, sentido_t *raspi) {
+    agregar(pc, 0, 2000);
+    agregar(pc, 1500, 2000);
+    for (int i = 0; i < 30; i++)
+        agregar(raspi, i * 100.0, 80);
+}
+
+static void escSaturado(sentido_t *pc, sentido_t *raspi) {
+    agregar(pc, 0, 8000);
+    agregar(raspi, 0, 8000);
+}
+
+static const struct {
+    const char *nombre;
+    void (*armar)(sentido_t *pc, sentido_t *raspi);
+} escenarios[] = {
+    { "redibujo de menú", escMenu },
+    { "comandos pegados", escPegado },
+    { "saturado",         escSaturado },
+};
+
+enum { VIEJO, NUCLEO, NUCLEO_FLUJO, MODOS };
+static const char *nombresModo[MODOS] = { "1 byte por loop", "núcleo", "núcleo + RTS/CTS" };
+
+// -------------------- Corrida --------------------
+static void preparar(sentido_t *s) {
+    uint8_t *datos = s->datos, *llegado = s->llegado;
+    double *listo = s->listo;
+    memset(s, 0, sizeof(*s));
+    s->datos = datos;
+    s->llegado = llegado;
+    s->listo = listo;
+}
+
+static int quieto(const puente_t *p) {
+    return sim.pcRaspi.siguiente == sim.pcRaspi.total && sim.raspiPc.siguiente == sim.raspiPc.total &&
+           !sim.hwRx.n && !sim.hwTx.n && !sim.softRx.n &&
+           (!p || (!p->haciaPc.ocupados && !p->haciaRaspi.ocupados));
+}
+
+// La velocidad se mide desde el primer byte listo hasta el último que
+// llegó; 'fin' es cuánto después del último listo terminó de pasar
+static void imprimirSentido(const char *nombre, const sentido_t *s) {
+    double segs = s->llegados && s->total ? (s->ultimo - s->listo[0]) / 1e6 : 0;
+    double tasa = segs > 0 ? s->llegados / segs : 0;
+    double finMs = s->llegados ? (s->ultimo - s->listo[s->total - 1]) / 1e3 : 0;
+    int integro = s->llegados == s->total && memcmp(s->datos, s->llegado, (size_t)s->total) == 0;
+
+    printf("    %-10s %5d/%-5d perdidos %5d (%4.1f%%)  %5.0f B/s (%3.0f%%)  fin +%4.0f ms  %s\n", nombre,
+           s->llegados, s->total, s->perdidos, s->total ? 100.0 * s->perdidos / s->total : 0.0, tasa,
+           100.0 * tasa / (BAUDIOS / 10.0), finMs, integro ? "íntegro" : "con faltantes");
+}
+
+static void correr(int e, int modo) {
+    static puente_t p;
+    puertoPuente_t pc = { pcDisponibles, pcLeer, pcEspacio, pcEscribir, NULL, NULL, NULL, 0 };
+    puertoPuente_t raspi = { raspiDisponibles, raspiLeer, raspiEspacio, raspiEscribir, NULL, NULL, NULL, 1 };
+
+    preparar(&sim.pcRaspi);
+    preparar(&sim.raspiPc);
+    sim.ahora = 0;
+    sim.hwRx = (cola_t){ .capacidad = COLA_HW };
+    sim.hwTx = (cola_t){ .capacidad = COLA_HW };
+    sim.softRx = (cola_t){ .capacidad = COLA_SOFT };
+    sim.transmitiendo = sim.pausado = 0;
+
+    semilla = 1u + (uint32_t)e;
+    escenarios[e].armar(&sim.pcRaspi, &sim.raspiPc);
+
+    if (modo == NUCLEO_FLUJO)
+        raspi.pausar = raspiPausar;
+    if (modo != VIEJO)
+        puente_iniciar(&p, &pc, &raspi, modo == NUCLEO_FLUJO);
+
+    double limite = 0;
+    for (int i = 0; i < sim.pcRaspi.total; i++)
+        limite = max2(limite, sim.pcRaspi.listo[i]);
+    for (int i = 0; i < sim.raspiPc.total; i++)
+        limite = max2(limite, sim.raspiPc.listo[i]);
+    limite += 30e6;
+
+    while (sim.ahora < limite && !quieto(modo == VIEJO ? NULL : &p)) {
+        avanzar(sim.ahora + VUELTA_US);
+        if (modo == VIEJO)
+            loopViejo();
+        else
+            puente_atender(&p);
+    }
+
+    printf("  %s\n", nombresModo[modo]);
+    imprimirSentido("PC->Raspi", &sim.pcRaspi);
+    imprimirSentido("Raspi->PC", &sim.raspiPc);
+    if (modo == NUCLEO_FLUJO)
+        printf("    %-10s pausas por anillo lleno %lu, anillos hasta %u y %u de %d\n", "",
+               p.pcRaspi.pausas + p.raspiPc.pausas, p.pcRaspi.maxOcupados, p.raspiPc.maxOcupados,
+               PUENTE_ANILLO);
+}
+
+int main(void) {
+    sentido_t *sentidos[2] = { &sim.pcRaspi, &sim.raspiPc };
+    for (int i = 0; i < 2; i++) {
+        sentidos[i]->datos = malloc(MAX_BYTES);
+        sentidos[i]->llegado = malloc(MAX_BYTES);
+        sentidos[i]->listo = malloc(MAX_BYTES * sizeof(double));
+        if (!sentidos[i]->datos || !sentidos[i]->llegado || !sentidos[i]->listo) {
+            perror("malloc");
+            return 1;
+        }
+    }
+
+    printf("Puente serie a %d baudios (%.0f B/s por sentido), anillos de %d bytes\n",
+           BAUDIOS, BAUDIOS / 10.0, PUENTE_ANILLO);
+    for (int e = 0; e < (int)(sizeof(escenarios) / sizeof(escenarios[0])); e++) {
+        printf("\n%s\n", escenarios[e].nombre);
+        for (int m = 0; m < MODOS; m++)
+            correr(e, m);
+    }
+    return 0;
+}
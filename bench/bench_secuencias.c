@@ -0,0 +1,245 @@
+// bench_secuencias.c
+// Corre cada secuencia sin terminal ni hardware (HAL simulado) con el mismo
+// hilo de salida que el programa, y reporta por secuencia:
+//   - frames/s que realmente salieron
+//   - jitter: atraso promedio/máximo de cada frame respecto de su deadline
+//     e histograma con los casilleros de reloj.h
+//   - syscalls de lectura/escritura (/proc/self/io) y cambios de contexto
+//     (getrusage) por frame
+//   - latencia comando -> LED: lo que tardan motor_reproducir() y
+//     motor_detener() en volver, que es cuando el frame ya está en el HAL
+// y al final cuatro secuencias a la vez en grupos de 2 LEDs con velocidades
+// distintas (pistas del motor), el refresco y el costo de CPU de la
+// intensidad por BAM con 8 y 64 canales.
+//
+// runPrograma() del menú atiende la terminal; acá se lanza el mismo programa
+// directo en el motor, que es lo que hace por debajo.
+//
+// Uso: bench_secuencias [ms_por_secuencia] [delay_ms]
+// Con LUCES_BIBLIOTECA se usan las secuencias compiladas por seqc, y con
+// LUCES_SPI/LUCES_CANALES la salida es la cadena de 74HC595.
+#include "secuencias.h"
+#include "motor.h"
+#include "gpio_hal.h"
+#include "reloj.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/resource.h>
+
+#define LATENCIAS 20   // arranques/paradas medidos por secuencia
+
+int modoRemoto = 0;   // secuencias.c lo toma de main.c
+
+static double segundos(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+// Syscalls de tipo read y write de todo el proceso
+static unsigned long syscallsES(void) {
+    unsigned long syscr = 0, syscw = 0;
+    char linea[64];
+    FILE *f = fopen("/proc/self/io", "r");
+
+    if (!f)
+        return 0;
+    while (fgets(linea, sizeof(linea), f)) {
+        sscanf(linea, "syscr: %lu", &syscr);
+        sscanf(linea, "syscw: %lu", &syscw);
+    }
+    fclose(f);
+    return syscr + syscw;
+}
+
+static long cambiosContexto(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_nvcsw + ru.ru_nivcsw;
+}
+
+static void medirLatencias(int id, int delay_ms, double *promUs, double *maxUs) {
+    double total = 0, max = 0;
+
+    for (int i = 0; i < LATENCIAS; i++) {
+        double t0 = segundos();
+        motor_reproducir(id, delay_ms);
+        double t1 = segundos();
+        motor_detener();
+        double t2 = segundos();
+
+        double a = (t1 - t0) * 1e6, b = (t2 - t1) * 1e6;
+        total += a + b;
+        if (a > max) max = a;
+        if (b > max) max = b;
+    }
+    *promUs = total / (2 * LATENCIAS);
+    *maxUs = max;
+}
+
+static void benchSecuencia(int id, int duracionMs, int delay_ms) {
+    unsigned long sys0 = syscallsES();
+    long ctx0 = cambiosContexto();
+    struct pollfd pfd = { .fd = motor_fdAviso(), .events = POLLIN };
+    motor_consumirAviso();
+    double t0 = segundos();
+
+    motor_reproducir(id, delay_ms);
+
+    // Las que no son bucle (la apilada) terminan solas antes y avisan; acá se
+    // duerme en poll() para no sumar cambios de contexto propios
+    poll(&pfd, 1, duracionMs);
+    double dt = segundos() - t0;
+    motor_detener();
+
+    // Los contadores se copian recién con el hilo parado
+    relojFrames_t r = *motor_reloj();
+    unsigned long sys = syscallsES() - sys0;
+    long ctx = cambiosContexto() - ctx0;
+    long frames = r.frames + 1;   // el primer frame sale sin vencimiento
+
+    double latProm, latMax;
+    medirLatencias(id, delay_ms, &latProm, &latMax);
+
+    printf("%-28s %6.1f fps  atraso %5ld/%6ld us  sys/frame %5.2f  ctx/frame %5.2f  cmd->LED %6.1f/%7.1f us  [",
+           secuencias_nombre(id), frames / dt, reloj_atrasoPromedioUs(&r), r.atrasoMaxUs,
+           (double)sys / frames, (double)ctx / frames, latProm, latMax);
+    for (int c = 0; c < RELOJ_CASILLEROS; c++)
+        printf("%s%ld", c ? " " : "", r.histograma[c]);
+    printf("]%s\n", r.resincronizaciones ? " RESINCRONIZÓ" : "");
+}
+
+// Cuatro pistas a la vez, cada una con su secuencia en 2 LEDs y a su
+// velocidad: frames y atraso por pista, escrituras al HAL (los vencimientos
+// que coinciden salen en una sola) y si una pista pausada retoma donde estaba
+static void benchPistas(int duracionMs) {
+    static const int ids[MOTOR_PISTAS]    = { SEC_BINARIO, SEC_CHOQUE, SEC_AUTO, SEC_DANZA };
+    static const int delays[MOTOR_PISTAS] = { 20, 30, 40, 50 };
+    unsigned long escrituras0 = hal_cantEscrituras();
+
+    motor_resetVelocidades();
+    for (int p = 0; p < MOTOR_PISTAS; p++)
+        motor_reproducirEn(p, ids[p], delays[p], (uint8_t)(0x03 << (2 * p)));
+    usleep(duracionMs * 1000);
+
+    // Pausa de la pista 1 a mitad de camino: las demás siguen
+    motor_pausar(1);
+    usleep(200 * 1000);
+    motor_reanudar(1);
+
+    relojFrames_t r[MOTOR_PISTAS];
+    frameInfo_t antes, despues;
+    long pasos = 0;
+
+    motor_leerFrame(&antes);   // la pista 0 es la que se publica con su paso
+    for (int p = 0; p < MOTOR_PISTAS; p++) {
+        motor_detenerPista(p);
+        r[p] = *motor_relojEn(p);
+        pasos += r[p].frames + 1;
+    }
+    unsigned long escrituras = hal_cantEscrituras() - escrituras0;
+
+    // Otra secuencia en el medio y después la original retoma donde quedó
+    motor_reproducir(SEC_CARRERA, 20);
+    motor_reproducir(ids[0], delays[0]);
+    motor_leerFrame(&despues);
+    motor_detener();
+
+    printf("4 pistas (2 LEDs c/u, 20/30/40/50 ms):");
+    for (int p = 0; p < MOTOR_PISTAS; p++)
+        printf("  %ld frames %ld/%ld us", r[p].frames, reloj_atrasoPromedioUs(&r[p]), r[p].atrasoMaxUs);
+    printf("\n  %lu escrituras al HAL para %ld pasos; retomada en el paso %u (dejada en %u)\n",
+           escrituras, pasos, despues.paso, antes.paso);
+    motor_resetVelocidades();
+}
+
+// BAM sobre la cadena SPI simulada (un archivo): refresco real, CPU del
+// proceso y escrituras al HAL por ciclo, con brillo a media escala y estela
+static void benchBam(int canales, int duracionMs) {
+    char ruta[] = "/tmp/bench_spiXXXXXX";
+    int fd = mkstemp(ruta);
+    if (fd < 0)
+        return;
+    close(fd);
+
+    hal_cerrar();
+    if (hal_iniciarSpi(ruta, canales, 8000000) != 0) {
+        unlink(ruta);
+        return;
+    }
+
+    motor_configurarIntensidad(MOTOR_BRILLO_MAX / 2, 4);
+
+    struct rusage ru0, ru1;
+    unsigned long ciclos0 = motor_ciclosBam();
+    unsigned long escrituras0 = hal_cantEscrituras();
+    getrusage(RUSAGE_SELF, &ru0);
+    double t0 = segundos();
+
+    motor_reproducir(SEC_AUTO, 50);
+    usleep(duracionMs * 1000);
+    motor_detener();
+
+    double dt = segundos() - t0;
+    getrusage(RUSAGE_SELF, &ru1);
+    unsigned long ciclos = motor_ciclosBam() - ciclos0;
+    unsigned long escrituras = hal_cantEscrituras() - escrituras0;
+    double cpu = (ru1.ru_utime.tv_sec - ru0.ru_utime.tv_sec) + (ru1.ru_utime.tv_usec - ru0.ru_utime.tv_usec) / 1e6 +
+                 (ru1.ru_stime.tv_sec - ru0.ru_stime.tv_sec) + (ru1.ru_stime.tv_usec - ru0.ru_stime.tv_usec) / 1e6;
+
+    printf("BAM %3d canales: %6.1f Hz de refresco, CPU %5.1f%% (%6.1f us por ciclo), %4.2f escrituras por ciclo\n",
+           canales, ciclos / dt, 100.0 * cpu / dt, ciclos ? cpu * 1e6 / ciclos : 0.0,
+           ciclos ? (double)escrituras / ciclos : 0.0);
+
+    motor_configurarIntensidad(MOTOR_BRILLO_MAX, 0);
+    unlink(ruta);
+}
+
+int main(int argc, char **argv) {
+    int duracionMs = argc > 1 ? atoi(argv[1]) : 1000;
+    int delay_ms = argc > 2 ? atoi(argv[2]) : 20;
+
+    if (duracionMs <= 0 || delay_ms <= 0) {
+        fprintf(stderr, "Uso: %s [ms_por_secuencia] [delay_ms]\n", argv[0]);
+        return 1;
+    }
+
+    // Con LUCES_SPI se mide contra la cadena de 74HC595 (o el archivo que la simula)
+    const char *ruta_spi = getenv("LUCES_SPI");
+    const char *canales = getenv("LUCES_CANALES");
+    int hal_error = ruta_spi ? hal_iniciarSpi(ruta_spi, canales ? atoi(canales) : 64, 8000000)
+                             : hal_iniciar(HAL_SIMULADO, LEDS, 8);
+    if (hal_error != 0) {
+        fprintf(stderr, "No se pudo iniciar la salida de LEDs\n");
+        return 1;
+    }
+    int cant = secuencias_iniciar(getenv("LUCES_BIBLIOTECA"));
+    if (motor_iniciar() != 0) {
+        fprintf(stderr, "No se pudo iniciar el hilo de salida\n");
+        return 1;
+    }
+
+    printf("%d secuencias, %d ms cada una, delay %d ms, %d canales, hilo de salida %s\n",
+           cant, duracionMs, delay_ms, hal_canales(), motor_tiempoReal() ? "SCHED_FIFO" : "normal");
+    printf("histograma de atraso: <");
+    for (int c = 0; c < RELOJ_CASILLEROS - 1; c++)
+        printf("%ld%s", reloj_limitesUs[c], c < RELOJ_CASILLEROS - 2 ? " <" : " us, resto\n");
+
+    for (int id = 0; id < cant; id++) {
+        motor_resetVelocidades();   // que cada una arranque con delay_ms
+        benchSecuencia(id, duracionMs, delay_ms);
+    }
+
+    benchPistas(duracionMs);
+    benchBam(8, duracionMs);
+    benchBam(64, duracionMs);
+
+    motor_cerrar();
+    hal_cerrar();
+    return 0;
+}
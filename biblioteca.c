@@ -0,0 +1,98 @@
+// biblioteca.c
+// Abre la biblioteca compilada con mmap y entrega programas que apuntan
+// directo a la proyección: no hay parseo ni copias al arrancar.
+#include "biblioteca.h"
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const uint8_t *mapa = NULL;
+static size_t largoMapa = 0;
+static const bibEntrada_t *entradas = NULL;
+static int cantidad = 0;
+
+// Verifica que cabecera, entradas y pasos estén dentro del archivo
+static int validar(const uint8_t *p, size_t largo) {
+    if (largo < sizeof(bibCabecera_t))
+        return 1;
+
+    const bibCabecera_t *cab = (const bibCabecera_t *)p;
+    if (cab->magia != BIB_MAGIA || cab->version != BIB_VERSION || cab->largo != largo)
+        return 1;
+
+    size_t finEntradas = sizeof(bibCabecera_t) + (size_t)cab->cantSecuencias * sizeof(bibEntrada_t);
+    if (finEntradas > largo)
+        return 1;
+
+    const bibEntrada_t *e = (const bibEntrada_t *)(p + sizeof(bibCabecera_t));
+    for (int i = 0; i < cab->cantSecuencias; i++) {
+        if (memchr(e[i].nombre, '\0', BIB_NOMBRE) == NULL)
+            return 1;
+        if (e[i].cantPasos == 0 || e[i].offsetPasos % 4 != 0 || e[i].offsetPasos < finEntradas)
+            return 1;
+        if ((size_t)e[i].offsetPasos + (size_t)e[i].cantPasos * sizeof(paso_t) > largo)
+            return 1;
+    }
+    return 0;
+}
+
+int biblioteca_abrir(const char *ruta) {
+    biblioteca_cerrar();
+
+    int fd = open(ruta, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return 1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return 1;
+    }
+
+    void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return 1;
+
+    if (validar(p, (size_t)st.st_size) != 0) {
+        munmap(p, (size_t)st.st_size);
+        return 1;
+    }
+
+    mapa      = p;
+    largoMapa = (size_t)st.st_size;
+    entradas  = (const bibEntrada_t *)(mapa + sizeof(bibCabecera_t));
+    cantidad  = ((const bibCabecera_t *)mapa)->cantSecuencias;
+    return 0;
+}
+
+int biblioteca_cantidad(void) {
+    return cantidad;
+}
+
+// Completa un programa cuyos pasos apuntan dentro de la proyección
+int biblioteca_programa(int i, programa_t *prog) {
+    if (i < 0 || i >= cantidad)
+        return 1;
+
+    const bibEntrada_t *e = &entradas[i];
+    prog->nombre    = e->nombre;
+    prog->pasos     = (const paso_t *)(mapa + e->offsetPasos);
+    prog->cantPasos = e->cantPasos;
+    prog->bucle     = e->bucle;
+    prog->delayMs   = e->delayMs;
+    prog->vivo      = NULL;
+    return 0;
+}
+
+void biblioteca_cerrar(void) {
+    if (mapa)
+        munmap((void *)mapa, largoMapa);
+    mapa      = NULL;
+    largoMapa = 0;
+    entradas  = NULL;
+    cantidad  = 0;
+}
@@ -0,0 +1,41 @@
+#ifndef BIBLIOTECA_H
+#define BIBLIOTECA_H
+
+#include <stdint.h>
+
+#include "motor.h"
+
+// Formato binario de la biblioteca de secuencias (lo genera herramientas/seqc).
+// Todo little-endian y alineado a 4 bytes para poder usarse directo desde el mmap:
+//   cabecera | entradas[cantSecuencias] | pasos de todas las secuencias
+#define BIB_MAGIA    0x5145534Cu   // "LSEQ"
+#define BIB_VERSION  1
+#define BIB_NOMBRE   32
+
+typedef struct {
+    uint32_t magia;
+    uint16_t version;
+    uint16_t cantSecuencias;
+    uint32_t largo;            // tamaño total del archivo
+    uint32_t reservado;
+} bibCabecera_t;
+
+typedef struct {
+    char     nombre[BIB_NOMBRE];   // terminado en '\0'
+    uint32_t offsetPasos;          // desde el inicio del archivo
+    uint16_t cantPasos;
+    uint16_t delayMs;              // delay por defecto (0 = delay inicial del menú)
+    uint8_t  bucle;
+    uint8_t  reservado[3];
+} bibEntrada_t;
+
+_Static_assert(sizeof(paso_t) == 4, "paso_t debe ocupar 4 bytes en la biblioteca");
+_Static_assert(sizeof(bibCabecera_t) == 16, "cabecera de biblioteca");
+_Static_assert(sizeof(bibEntrada_t) == 44, "entrada de biblioteca");
+
+int  biblioteca_abrir(const char *ruta);
+int  biblioteca_cantidad(void);
+int  biblioteca_programa(int i, programa_t *prog);
+void biblioteca_cerrar(void);
+
+#endif
@@ -0,0 +1,40 @@
+// buffer_triple.c
+#include "buffer_triple.h"
+
+#include <string.h>
+
+#define BT_NUEVO  4u
+#define BT_INDICE 3u
+
+void bt_iniciar(bufferTriple_t *bt) {
+    memset(bt->bufs, 0, sizeof(bt->bufs));
+    bt->escritura = 0;
+    atomic_store(&bt->intermedio, 1);
+    bt->lectura = 2;
+}
+
+// Buffer donde el productor arma el próximo frame
+frameInfo_t *bt_escritura(bufferTriple_t *bt) {
+    return &bt->bufs[bt->escritura];
+}
+
+void bt_publicar(bufferTriple_t *bt) {
+    unsigned int anterior = atomic_exchange_explicit(&bt->intermedio, bt->escritura | BT_NUEVO,
+                                                     memory_order_acq_rel);
+    bt->escritura = anterior & BT_INDICE;
+}
+
+// Copia el último frame publicado; devuelve 1 si es nuevo desde la lectura anterior
+int bt_leer(bufferTriple_t *bt, frameInfo_t *dest) {
+    int nuevo = 0;
+
+    if (atomic_load_explicit(&bt->intermedio, memory_order_relaxed) & BT_NUEVO) {
+        unsigned int anterior = atomic_exchange_explicit(&bt->intermedio, bt->lectura,
+                                                         memory_order_acq_rel);
+        bt->lectura = anterior & BT_INDICE;
+        nuevo = 1;
+    }
+
+    *dest = bt->bufs[bt->lectura];
+    return nuevo;
+}
@@ -0,0 +1,29 @@
+#ifndef BUFFER_TRIPLE_H
+#define BUFFER_TRIPLE_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+// Último frame publicado por el hilo de salida
+typedef struct {
+    uint8_t  frame;
+    int16_t  secuencia;   // -1 si no hay secuencia en curso
+    uint16_t paso;
+    uint32_t numero;      // contador de frames escritos
+} frameInfo_t;
+
+// Buffer triple: el productor nunca espera al consumidor y el consumidor
+// siempre lee el frame completo más reciente.
+typedef struct {
+    frameInfo_t bufs[3];
+    _Atomic unsigned int intermedio;   // índice del buffer libre | BT_NUEVO
+    unsigned int escritura;            // propiedad del productor
+    unsigned int lectura;              // propiedad del consumidor
+} bufferTriple_t;
+
+void bt_iniciar(bufferTriple_t *bt);
+frameInfo_t *bt_escritura(bufferTriple_t *bt);
+void bt_publicar(bufferTriple_t *bt);
+int  bt_leer(bufferTriple_t *bt, frameInfo_t *dest);
+
+#endif
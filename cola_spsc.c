@@ -0,0 +1,33 @@
+// cola_spsc.c
+#include "cola_spsc.h"
+
+void cola_iniciar(colaSpsc_t *c) {
+    atomic_store(&c->cabeza, 0);
+    atomic_store(&c->cola, 0);
+}
+
+// Devuelve 0 si se encoló, 1 si la cola está llena
+int cola_encolar(colaSpsc_t *c, const comando_t *cmd) {
+    unsigned int cabeza = atomic_load_explicit(&c->cabeza, memory_order_relaxed);
+    unsigned int cola   = atomic_load_explicit(&c->cola, memory_order_acquire);
+
+    if (cabeza - cola == COLA_CAPACIDAD)
+        return 1;
+
+    c->items[cabeza & (COLA_CAPACIDAD - 1)] = *cmd;
+    atomic_store_explicit(&c->cabeza, cabeza + 1, memory_order_release);
+    return 0;
+}
+
+// Devuelve 1 si sacó un comando, 0 si la cola está vacía
+int cola_desencolar(colaSpsc_t *c, comando_t *cmd) {
+    unsigned int cola   = atomic_load_explicit(&c->cola, memory_order_relaxed);
+    unsigned int cabeza = atomic_load_explicit(&c->cabeza, memory_order_acquire);
+
+    if (cola == cabeza)
+        return 0;
+
+    *cmd = c->items[cola & (COLA_CAPACIDAD - 1)];
+    atomic_store_explicit(&c->cola, cola + 1, memory_order_release);
+    return 1;
+}
@@ -0,0 +1,28 @@
+#ifndef COLA_SPSC_H
+#define COLA_SPSC_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+// Cola sin locks de un productor (hilo de interfaz) y un consumidor (hilo de salida)
+#define COLA_CAPACIDAD 64   // potencia de 2
+
+typedef struct {
+    uint16_t tipo;
+    uint16_t secuencia;
+    int32_t  valor;
+    uint8_t  pista;
+    uint8_t  grupo;
+} comando_t;
+
+typedef struct {
+    _Alignas(64) _Atomic unsigned int cabeza;   // solo la escribe el productor
+    _Alignas(64) _Atomic unsigned int cola;     // solo la escribe el consumidor
+    comando_t items[COLA_CAPACIDAD];
+} colaSpsc_t;
+
+void cola_iniciar(colaSpsc_t *c);
+int  cola_encolar(colaSpsc_t *c, const comando_t *cmd);
+int  cola_desencolar(colaSpsc_t *c, comando_t *cmd);
+
+#endif
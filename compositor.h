@@ -0,0 +1,29 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include <stdint.h>
+
+// Compositor de capas: cómo se aplica cada pista del motor sobre lo que
+// quedó de las anteriores (ver componer() en motor.c). El destino arranca
+// apagado y las capas van en orden, así que la primera suele ser un OR.
+enum {
+    COMP_OR,
+    COMP_AND,
+    COMP_XOR,
+    COMP_MASCARA,   // apaga lo que la capa tiene encendido
+    COMP_OPS
+};
+
+#define COMP_VALIDA(op) ((unsigned)(op) < COMP_OPS)
+
+// Un paso sobre un frame de 8 posiciones
+static inline uint8_t comp_aplicar8(int op, uint8_t dest, uint8_t capa) {
+    switch (op) {
+    case COMP_AND:     return dest & capa;
+    case COMP_XOR:     return dest ^ capa;
+    case COMP_MASCARA: return dest & (uint8_t)~capa;
+    default:           return dest | capa;
+    }
+}
+
+#endif
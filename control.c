@@ -0,0 +1,429 @@
+// control.c
+// Servidor de control no bloqueante (ver control.h). Un epoll propio con los
+// sockets que escuchan y todos los clientes; reactor.c solo ve su fd. Cada
+// cliente tiene su lector de tramas y un buffer fijo para las respuestas: uno
+// que no lee lo que se le contesta se desconecta en vez de frenar a los demás.
+//
+// Los comandos no esperan al hilo de salida (que en BAM mira su cola una vez
+// por ciclo). Una respuesta con estado se retiene hasta que el hilo avisa que
+// aplicó lo anterior; mientras tanto ese cliente no se lee más, para que sus
+// respuestas salgan en orden, y los demás se siguen atendiendo.
+#define _GNU_SOURCE   // accept4
+#include "control.h"
+#include "protocolo.h"
+#include "motor.h"
+#include "reactor.h"
+#include "telemetria.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#define ESCUCHA_UNIX  0xFFFFFFFEu   // data.u32 de los sockets que escuchan
+#define ESCUCHA_TCP   0xFFFFFFFFu
+#define CONFIRMACION  0xFFFFFFFDu   // motor_fdConfirmacion()
+#define EVENTOS_POR_VUELTA 64
+#define LARGO_LECTURA 512
+
+typedef struct {
+    int fd;                           // -1 = lugar libre
+    protoLector_t lector;
+    uint8_t salida[CONTROL_SALIDA];
+    size_t pendientes;
+    uint32_t eventos;                 // lo pedido a epoll
+    unsigned int ultimaMarca;         // motor_marca() tras su último comando
+    // Respuesta retenida hasta motor_aplicado(marca) y lo que se leyó detrás
+    int retenida;
+    unsigned int marca;
+    int consulta;
+    uint8_t seq;
+    uint8_t resp[PROTO_MAX_RESPUESTA];
+    int largoResp;
+    uint8_t entrada[LARGO_LECTURA];
+    int cantEntrada;
+} cliente_t;
+
+static int epControl = -1;
+static int escuchaUnix = -1, escuchaTcp = -1;
+static char rutaSocket[sizeof(((struct sockaddr_un *)0)->sun_path)];
+
+static cliente_t clientes[CONTROL_MAX_CLIENTES];
+static int libres[CONTROL_MAX_CLIENTES];   // pila de lugares libres
+static int cantLibres = 0;
+static int conectados = 0;
+static int retenidos = 0;
+static int guardando = 0;   // velocidades por guardar: cuenta como una retenida
+
+static unsigned long tramas = 0;
+static unsigned long desconectados = 0;
+
+static int vigilar(int op, int fd, uint32_t eventos, uint32_t dato) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = eventos;
+    ev.data.u32 = dato;
+    return epoll_ctl(epControl, op, fd, &ev);
+}
+
+static void cerrarCliente(int i) {
+    cliente_t *c = &clientes[i];
+
+    if (c->retenida && --retenidos == 0)
+        motor_pedirConfirmacion(0);
+    c->retenida = 0;
+
+    epoll_ctl(epControl, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    c->fd = -1;
+    libres[cantLibres++] = i;
+    conectados--;
+}
+
+// Las velocidades que cambió una trama van al archivo de estado cuando el
+// hilo de salida las aplicó (motor_guardarPendiente); mientras tanto se pide
+// el aviso igual que para una respuesta retenida. El pedido se marca antes
+// de volver a mirar: no se pierde el aviso.
+static void guardarVelocidades(void) {
+    if (!guardando && motor_guardarPendiente()) {
+        guardando = 1;
+        if (retenidos++ == 0)
+            motor_pedirConfirmacion(1);
+    }
+    if (guardando && !motor_guardarPendiente()) {
+        guardando = 0;
+        if (--retenidos == 0)
+            motor_pedirConfirmacion(0);
+    }
+}
+
+// -------------------- Sockets que escuchan --------------------
+static int escucharUnix(const char *ruta) {
+    struct sockaddr_un dir;
+
+    if (strlen(ruta) >= sizeof(dir.sun_path))
+        return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+
+    memset(&dir, 0, sizeof(dir));
+    dir.sun_family = AF_UNIX;
+    strcpy(dir.sun_path, ruta);
+    unlink(ruta);   // quedó de una ejecución anterior
+
+    if (bind(fd, (struct sockaddr *)&dir, sizeof(dir)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        return -1;
+    }
+    strcpy(rutaSocket, ruta);
+    return fd;
+}
+
+static int escucharTcp(int puerto, const char *direccion) {
+    struct sockaddr_in dir;
+    int uno = 1;
+
+    memset(&dir, 0, sizeof(dir));
+    dir.sin_family = AF_INET;
+    dir.sin_port = htons((uint16_t)puerto);
+    if (!direccion)
+        dir.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    else if (inet_pton(AF_INET, direccion, &dir.sin_addr) != 1)
+        return -1;
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &uno, sizeof(uno));
+
+    if (bind(fd, (struct sockaddr *)&dir, sizeof(dir)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int control_iniciar(const char *rutaUnix, int puertoTcp, const char *direccionTcp) {
+    if (epControl >= 0)
+        return 0;
+
+    epControl = epoll_create1(EPOLL_CLOEXEC);
+    if (epControl < 0)
+        return 1;
+
+    for (int i = 0; i < CONTROL_MAX_CLIENTES; i++) {
+        clientes[i].fd = -1;
+        libres[i] = CONTROL_MAX_CLIENTES - 1 - i;
+    }
+    cantLibres = CONTROL_MAX_CLIENTES;
+
+    if (rutaUnix && (escuchaUnix = escucharUnix(rutaUnix)) >= 0)
+        vigilar(EPOLL_CTL_ADD, escuchaUnix, EPOLLIN, ESCUCHA_UNIX);
+    if (puertoTcp > 0 && (escuchaTcp = escucharTcp(puertoTcp, direccionTcp)) >= 0)
+        vigilar(EPOLL_CTL_ADD, escuchaTcp, EPOLLIN, ESCUCHA_TCP);
+
+    if (escuchaUnix < 0 && escuchaTcp < 0) {
+        close(epControl);
+        epControl = -1;
+        return 1;
+    }
+    vigilar(EPOLL_CTL_ADD, motor_fdConfirmacion(), EPOLLIN, CONFIRMACION);
+
+    reactor_vigilar(EV_CONTROL, epControl);
+    reactor_atender(EV_CONTROL, control_atender);
+    return 0;
+}
+
+void control_cerrar(void) {
+    if (epControl < 0)
+        return;
+
+    reactor_atender(EV_CONTROL, NULL);
+    reactor_vigilar(EV_CONTROL, -1);
+
+    for (int i = 0; i < CONTROL_MAX_CLIENTES; i++)
+        if (clientes[i].fd >= 0)
+            cerrarCliente(i);
+    epoll_ctl(epControl, EPOLL_CTL_DEL, motor_fdConfirmacion(), NULL);
+    if (escuchaUnix >= 0) {
+        close(escuchaUnix);
+        unlink(rutaSocket);
+    }
+    if (escuchaTcp >= 0)
+        close(escuchaTcp);
+    close(epControl);
+    escuchaUnix = escuchaTcp = epControl = -1;
+}
+
+int control_fd(void) {
+    return epControl;
+}
+
+// -------------------- Clientes --------------------
+static void aceptar(int escucha) {
+    while (1) {
+        int fd = accept4(escucha, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+            return;   // EAGAIN: no hay más en la cola
+
+        if (cantLibres == 0) {
+            close(fd);
+            continue;
+        }
+
+        if (escucha == escuchaTcp) {
+            int uno = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &uno, sizeof(uno));
+        }
+
+        int i = libres[--cantLibres];
+        cliente_t *c = &clientes[i];
+        c->fd = fd;
+        c->pendientes = 0;
+        c->eventos = EPOLLIN;
+        c->retenida = 0;
+        c->cantEntrada = 0;
+        c->ultimaMarca = motor_marca();
+        proto_lectorIniciar(&c->lector);
+
+        if (vigilar(EPOLL_CTL_ADD, fd, EPOLLIN, (uint32_t)i) != 0) {
+            close(fd);
+            c->fd = -1;
+            libres[cantLibres++] = i;
+            continue;
+        }
+        conectados++;
+    }
+}
+
+// Manda lo pendiente; si el socket no acepta todo se pide EPOLLOUT.
+// Devuelve 1 si el cliente se cerró.
+static int vaciar(int i) {
+    cliente_t *c = &clientes[i];
+
+    if (c->pendientes) {
+        ssize_t n = send(c->fd, c->salida, c->pendientes, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            cerrarCliente(i);
+            return 1;
+        }
+        if (n > 0) {
+            c->pendientes -= (size_t)n;
+            memmove(c->salida, c->salida + n, c->pendientes);
+        }
+    }
+
+    // Con una respuesta retenida no se lee más de este cliente
+    uint32_t quiere = (c->retenida ? 0 : EPOLLIN) | (c->pendientes > 0 ? EPOLLOUT : 0);
+    if (quiere != c->eventos) {
+        vigilar(EPOLL_CTL_MOD, c->fd, quiere, (uint32_t)i);
+        c->eventos = quiere;
+    }
+    return 0;
+}
+
+static int encolar(cliente_t *c, uint8_t seq, const uint8_t *carga, int n) {
+    if (c->pendientes + PROTO_MAX_TRAMA > CONTROL_SALIDA)
+        return 1;
+    c->pendientes += proto_armar(c->salida + c->pendientes, seq, carga, (size_t)n);
+    return 0;
+}
+
+// Ejecuta las tramas completas de lo leído y encola las respuestas; se
+// detiene en la primera que haya que retener. Devuelve 1 si se cerró.
+static int procesar(int i) {
+    cliente_t *c = &clientes[i];
+    int k = 0;
+
+    while (k < c->cantEntrada && !c->retenida) {
+        int r = proto_leer(&c->lector, c->entrada[k++]);
+        if (r == 0)
+            continue;
+
+        uint8_t resp[PROTO_MAX_RESPUESTA];
+        int largo, consulta = -1;
+
+        if (r > 0) {
+            int cant;
+            const uint8_t *comandos = proto_carga(&c->lector, &cant);
+            unsigned int antes = motor_marca();
+            largo = proto_ejecutar(comandos, cant, resp, &consulta);
+            if (motor_marca() != antes)
+                c->ultimaMarca = motor_marca();
+            guardarVelocidades();
+            tramas++;
+        } else if (c->lector.pos > 0) {
+            tele_sumar(&tele->interfaz.tramasDescartadas, 1);
+            resp[0] = PROTO_RESPUESTA;
+            resp[1] = PROTO_ERROR_CRC;
+            resp[2] = 0;
+            largo = 3;
+        } else {
+            continue;   // largo inválido: no hay seq a quien contestar
+        }
+
+        if (consulta >= 0) {
+            // Solo hace falta que estén aplicados los comandos de este
+            // cliente. El pedido se marca antes de mirar: no se pierde el aviso.
+            unsigned int marca = c->ultimaMarca;
+            if (retenidos++ == 0)
+                motor_pedirConfirmacion(1);
+            if (motor_aplicado(marca)) {
+                if (--retenidos == 0)
+                    motor_pedirConfirmacion(0);
+                largo = proto_agregarEstado(resp, consulta);
+            } else {
+                c->retenida = 1;
+                c->marca = marca;
+                c->consulta = consulta;
+                c->seq = proto_seq(&c->lector);
+                memcpy(c->resp, resp, (size_t)largo);
+                c->largoResp = largo;
+                break;
+            }
+        }
+
+        if (encolar(c, proto_seq(&c->lector), resp, largo) != 0) {
+            // Manda tramas sin leer las respuestas: se corta
+            desconectados++;
+            cerrarCliente(i);
+            return 1;
+        }
+    }
+
+    c->cantEntrada -= k;
+    memmove(c->entrada, c->entrada + k, (size_t)c->cantEntrada);
+    return vaciar(i);
+}
+
+static void leer(int i) {
+    cliente_t *c = &clientes[i];
+
+    ssize_t n = read(c->fd, c->entrada, sizeof(c->entrada));
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+        cerrarCliente(i);
+        return;
+    }
+    c->cantEntrada = n > 0 ? (int)n : 0;
+    procesar(i);
+}
+
+// El hilo de salida aplicó comandos: salen las respuestas que ya pueden
+static void liberarRetenidas(void) {
+    motor_consumirConfirmacion();
+    guardarVelocidades();
+
+    for (int i = 0; i < CONTROL_MAX_CLIENTES && retenidos > 0; i++) {
+        cliente_t *c = &clientes[i];
+        if (c->fd < 0 || !c->retenida || !motor_aplicado(c->marca))
+            continue;
+
+        c->retenida = 0;
+        if (--retenidos == 0)
+            motor_pedirConfirmacion(0);
+        int largo = proto_agregarEstado(c->resp, c->consulta);
+        if (encolar(c, c->seq, c->resp, largo) != 0) {
+            desconectados++;
+            cerrarCliente(i);
+            continue;
+        }
+        procesar(i);   // lo que había llegado detrás (y vuelve a pedir EPOLLIN)
+    }
+}
+
+void control_atender(void) {
+    struct epoll_event evs[EVENTOS_POR_VUELTA];
+
+    if (epControl < 0)
+        return;
+
+    // Una vuelta sin esperar; si quedan más, el reactor vuelve a despertar
+    int n = epoll_wait(epControl, evs, EVENTOS_POR_VUELTA, 0);
+    for (int e = 0; e < n; e++) {
+        uint32_t dato = evs[e].data.u32;
+
+        if (dato == CONFIRMACION) {
+            liberarRetenidas();
+            continue;
+        }
+        if (dato == ESCUCHA_UNIX || dato == ESCUCHA_TCP) {
+            aceptar(dato == ESCUCHA_UNIX ? escuchaUnix : escuchaTcp);
+            continue;
+        }
+
+        int i = (int)dato;
+        if (clientes[i].fd < 0)
+            continue;   // se cerró en esta misma vuelta
+        if (evs[e].events & EPOLLOUT) {
+            if (vaciar(i))
+                continue;
+        }
+        if (clientes[i].retenida) {
+            if (evs[e].events & (EPOLLHUP | EPOLLERR))
+                cerrarCliente(i);
+            continue;
+        }
+        if (evs[e].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+            leer(i);
+    }
+}
+
+int control_clientes(void) {
+    return conectados;
+}
+
+unsigned long control_tramas(void) {
+    return tramas;
+}
+
+unsigned long control_desconectados(void) {
+    return desconectados;
+}
@@ -0,0 +1,30 @@
+#ifndef CONTROL_H
+#define CONTROL_H
+
+// Servidor de control por socket (Unix y/o TCP) para muchos clientes a la vez:
+// tableros, programadores de horarios, bancos de prueba. Cada conexión habla
+// las mismas tramas binarias que el UART (protocolo.h), sin el texto del menú.
+//
+// Todo corre en el hilo de la interfaz sin bloquear: el servidor tiene su
+// propio epoll y ese fd se vigila en el reactor como EV_CONTROL, así que los
+// clientes se atienden mientras el menú o una secuencia esperan entrada. Los
+// comandos llegan al hilo de salida por la misma cola que los del menú.
+#define CONTROL_MAX_CLIENTES 1024
+#define CONTROL_SALIDA       1024   // bytes de respuestas pendientes por cliente
+
+// rutaUnix NULL o puertoTcp 0 desactivan ese lado. El TCP no pide
+// contraseña: escucha en 'direccionTcp' y, si es NULL, solo en 127.0.0.1;
+// abrirlo a la red tiene que ser explícito ("0.0.0.0" o la IP de una
+// interfaz). Devuelve 0 si quedó escuchando al menos uno y ya registrado en
+// el reactor.
+int  control_iniciar(const char *rutaUnix, int puertoTcp, const char *direccionTcp);
+void control_cerrar(void);
+
+int  control_fd(void);
+void control_atender(void);   // manejador de EV_CONTROL
+
+int  control_clientes(void);
+unsigned long control_tramas(void);
+unsigned long control_desconectados(void);   // clientes cortados por no leer sus respuestas
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef CRC_H
+#define CRC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// CRC-16/CCITT (poli 0x1021, inicial 0xFFFF, sin reflejar): el de las tramas
+// del protocolo y el de los registros del archivo de estado
+uint16_t crc_ccitt(const uint8_t *datos, size_t n);
+
+#endif
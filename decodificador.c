@@ -0,0 +1,157 @@
+// decodificador.c
+#include "decodificador.h"
+
+#include <errno.h>
+#include <unistd.h>
+
+enum {
+    D_NORMAL,
+    D_ESC,      // llegó ESC
+    D_CSI,      // ESC [ ... esperando el byte final
+    D_SS3       // ESC O (flechas en modo aplicación)
+};
+
+#define MAX_CSI 16   // una secuencia más larga se descarta
+
+entrada_t entradaTeclado = { .fd = STDIN_FILENO };
+entrada_t entradaSerial  = { .fd = -1 };
+
+void dec_iniciar(decodificador_t *d) {
+    d->estado = D_NORMAL;
+    d->largoCsi = 0;
+    d->ultimoFueCR = 0;
+}
+
+static int flecha(uint8_t b, tecla_t *t) {
+    switch (b) {
+    case 'A': t->tipo = TEC_ARRIBA;    return 1;
+    case 'B': t->tipo = TEC_ABAJO;     return 1;
+    case 'C': t->tipo = TEC_DERECHA;   return 1;
+    case 'D': t->tipo = TEC_IZQUIERDA; return 1;
+    default:  return 0;
+    }
+}
+
+// Procesa un byte; devuelve 1 si completó una tecla (en *t)
+int dec_byte(decodificador_t *d, uint8_t b, tecla_t *t) {
+    int eraCR = d->ultimoFueCR;
+    d->ultimoFueCR = 0;
+
+    switch (d->estado) {
+    case D_ESC:
+        if (b == '[') {
+            d->estado = D_CSI;
+            d->largoCsi = 0;
+            return 0;
+        }
+        if (b == 'O') {
+            d->estado = D_SS3;
+            return 0;
+        }
+        if (b == 27)
+            return 0;
+        // ESC suelto: se ignora y el byte se procesa normalmente
+        d->estado = D_NORMAL;
+        break;
+
+    case D_CSI:
+        if (b >= 0x40 && b <= 0x7E) {   // byte final
+            d->estado = D_NORMAL;
+            return flecha(b, t);
+        }
+        if (b < 0x20 || ++d->largoCsi > MAX_CSI)
+            d->estado = D_NORMAL;       // secuencia rota: se descarta
+        return 0;
+
+    case D_SS3:
+        d->estado = D_NORMAL;
+        return flecha(b, t);
+    }
+
+    // D_NORMAL
+    switch (b) {
+    case 27:
+        d->estado = D_ESC;
+        return 0;
+
+    case '\r':
+        d->ultimoFueCR = 1;
+        t->tipo = TEC_ENTER;
+        return 1;
+
+    case '\n':
+        if (eraCR)
+            return 0;   // el LF de un CRLF ya se entregó como ENTER
+        t->tipo = TEC_ENTER;
+        return 1;
+
+    case 127:
+    case 8:
+        t->tipo = TEC_BORRAR;
+        return 1;
+
+    default:
+        t->tipo = TEC_CARACTER;
+        t->c = (char)b;
+        return 1;
+    }
+}
+
+// Decodifica un bloque entero; se detiene si se llenan las 'max' teclas.
+// En *consumidos queda cuántos bytes se procesaron.
+size_t dec_alimentar(decodificador_t *d, const char *datos, size_t n, tecla_t *teclas, size_t max, size_t *consumidos) {
+    size_t cant = 0, i = 0;
+
+    while (i < n && cant < max) {
+        if (dec_byte(d, (uint8_t)datos[i++], &teclas[cant]))
+            cant++;
+    }
+    if (consumidos)
+        *consumidos = i;
+    return cant;
+}
+
+// -------------------- Fuentes de entrada --------------------
+void entrada_iniciar(entrada_t *e, int fd) {
+    e->fd = fd;
+    e->pos = e->largo = 0;
+    e->lecturas = 0;
+    e->filtro = NULL;
+    e->bytes = NULL;
+    dec_iniciar(&e->dec);
+}
+
+// Entrega la próxima tecla: primero de lo ya leído, si no con un read() de un
+// bloque entero. Devuelve 1 si hay tecla, 0 si no hay datos y -1 en EOF/error.
+int entrada_siguiente(entrada_t *e, tecla_t *t) {
+    if (e->fd < 0)
+        return -1;
+
+    while (1) {
+        while (e->pos < e->largo) {
+            uint8_t b = (uint8_t)e->buf[e->pos++];
+            if (e->filtro && e->filtro(b))
+                continue;
+            if (dec_byte(&e->dec, b, t))
+                return 1;
+        }
+
+        ssize_t n = read(e->fd, e->buf, sizeof(e->buf));
+        e->lecturas++;
+
+        if (n > 0) {
+            if (e->bytes)
+                tele_sumar(e->bytes, (uint64_t)n);
+            e->pos = 0;
+            e->largo = (size_t)n;
+            continue;
+        }
+        e->pos = e->largo = 0;
+
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+            return 0;
+        if (n == 0 && e->fd == STDIN_FILENO)
+            return 0;   // terminal no canónica con VMIN=0: no hay datos
+        return -1;
+    }
+}
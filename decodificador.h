@@ -0,0 +1,57 @@
+#ifndef DECODIFICADOR_H
+#define DECODIFICADOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "telemetria.h"
+
+// Teclas que entrega el decodificador
+enum {
+    TEC_CARACTER,    // carácter común en 'c' (incluye 'q')
+    TEC_ARRIBA,
+    TEC_ABAJO,
+    TEC_DERECHA,
+    TEC_IZQUIERDA,
+    TEC_ENTER,       // CR, LF o CRLF
+    TEC_BORRAR       // DEL (127) o BS (8)
+};
+
+typedef struct {
+    int  tipo;
+    char c;
+} tecla_t;
+
+// Máquina de estados incremental: los bytes pueden llegar de a uno o en
+// bloques, y una secuencia ESC [ A partida entre dos read() se arma igual.
+typedef struct {
+    uint8_t estado;
+    uint8_t largoCsi;
+    uint8_t ultimoFueCR;
+} decodificador_t;
+
+void dec_iniciar(decodificador_t *d);
+int  dec_byte(decodificador_t *d, uint8_t b, tecla_t *t);
+size_t dec_alimentar(decodificador_t *d, const char *datos, size_t n, tecla_t *teclas, size_t max, size_t *consumidos);
+
+// Fuente de entrada: un fd no bloqueante leído de a bloques más su decodificador.
+// Los bytes que sobran después de una tecla quedan guardados para la próxima.
+#define ENTRADA_BUFFER 256
+
+typedef struct {
+    int fd;
+    decodificador_t dec;
+    char buf[ENTRADA_BUFFER];
+    size_t pos, largo;
+    unsigned long lecturas;   // read() hechos (para medir)
+    int (*filtro)(uint8_t b); // si devuelve 1 el byte no es una tecla (p.ej. proto_byte)
+    teleContador_t *bytes;    // contador de bytes leídos en la telemetría (NULL = ninguno)
+} entrada_t;
+
+extern entrada_t entradaTeclado;   // stdin
+extern entrada_t entradaSerial;    // serial_fd (se asigna al abrir el UART)
+
+void entrada_iniciar(entrada_t *e, int fd);
+int  entrada_siguiente(entrada_t *e, tecla_t *t);
+
+#endif
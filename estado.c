@@ -0,0 +1,164 @@
+// estado.c
+// Archivo de estado persistente (ver estado.h):
+//
+//   cabecera (16 bytes)  registros[ESTADO_CLAVES][2] (8 bytes cada uno)
+//
+// Un registro es una palabra de 64 bits: valor (16) | generación (16) |
+// clave (16) | crc (16). Se escribe entera de una vez; el CRC cubre los
+// otros tres campos, así una palabra escrita a medias (o que nunca llegó al
+// disco) no pasa la verificación y se usa la otra copia.
+#include "estado.h"
+#include "crc.h"
+
+#include <stddef.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define ESTADO_MAGIA 0x5345434Cu   // "LCES"
+
+typedef struct {
+    uint32_t magia;
+    uint16_t version;
+    uint16_t claves;
+    uint32_t reservado;
+    uint32_t crc;        // de los 12 bytes anteriores
+} cabecera_t;
+
+typedef struct {
+    cabecera_t cabecera;
+    volatile uint64_t registros[ESTADO_CLAVES][2];
+} archivoEstado_t;
+
+static archivoEstado_t *archivo = NULL;
+static int descartados = 0;
+
+// Copia vigente de cada clave: de ahí salen las lecturas y la generación de
+// la próxima escritura (el archivo solo se lee al abrir)
+static uint16_t valores[ESTADO_CLAVES];
+static uint16_t generaciones[ESTADO_CLAVES];
+static uint8_t  vigente[ESTADO_CLAVES];   // registro (0 o 1) que tiene el valor
+
+static uint64_t armarRegistro(int clave, uint16_t valor, uint16_t gen) {
+    uint8_t d[6] = {
+        (uint8_t)valor, (uint8_t)(valor >> 8),
+        (uint8_t)gen,   (uint8_t)(gen >> 8),
+        (uint8_t)clave, (uint8_t)(clave >> 8)
+    };
+    return (uint64_t)valor | (uint64_t)gen << 16 | (uint64_t)clave << 32 | (uint64_t)crc_ccitt(d, 6) << 48;
+}
+
+// 1 si el registro es válido para 'clave' (una palabra en cero es "nunca escrito")
+static int leerRegistro(uint64_t r, int clave, uint16_t *valor, uint16_t *gen) {
+    if (r == 0 || (int)(r >> 32 & 0xFFFF) != clave)
+        return 0;
+    *valor = (uint16_t)r;
+    *gen = (uint16_t)(r >> 16);
+    return armarRegistro(clave, *valor, *gen) == r;
+}
+
+static uint32_t crcCabecera(const cabecera_t *c) {
+    return crc_ccitt((const uint8_t *)c, offsetof(cabecera_t, crc));
+}
+
+static void formatear(void) {
+    memset((void *)archivo->registros, 0, sizeof(archivo->registros));
+    archivo->cabecera = (cabecera_t){
+        .magia = ESTADO_MAGIA,
+        .version = ESTADO_VERSION,
+        .claves = ESTADO_CLAVES,
+    };
+    archivo->cabecera.crc = crcCabecera(&archivo->cabecera);
+    msync(archivo, sizeof(*archivo), MS_SYNC);
+}
+
+// -------------------- Abrir y cerrar --------------------
+int estado_abrir(const char *ruta) {
+    if (archivo)
+        return 0;
+
+    int fd = open(ruta, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return 1;
+
+    struct stat st;
+    int nuevo = fstat(fd, &st) != 0 || st.st_size != (off_t)sizeof(archivoEstado_t);
+    if (nuevo && ftruncate(fd, sizeof(archivoEstado_t)) != 0) {
+        close(fd);
+        return 1;
+    }
+
+    void *m = mmap(NULL, sizeof(archivoEstado_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED)
+        return 1;
+    archivo = m;
+
+    // Otro tamaño u otra versión: se empieza de cero
+    const cabecera_t *c = &archivo->cabecera;
+    if (nuevo || c->magia != ESTADO_MAGIA || c->version != ESTADO_VERSION ||
+        c->claves != ESTADO_CLAVES || c->crc != crcCabecera(c))
+        formatear();
+
+    descartados = 0;
+    for (int k = 0; k < ESTADO_CLAVES; k++) {
+        uint16_t v[2], g[2];
+        int ok[2];
+
+        for (int s = 0; s < 2; s++) {
+            ok[s] = leerRegistro(archivo->registros[k][s], k, &v[s], &g[s]);
+            if (!ok[s] && archivo->registros[k][s] != 0)
+                descartados++;
+        }
+
+        // El más nuevo de los válidos (la generación da la vuelta a los 65536)
+        int s = ok[0] && ok[1] ? (int16_t)(g[1] - g[0]) > 0 : ok[1];
+        valores[k] = ok[s] ? v[s] : 0;
+        generaciones[k] = ok[s] ? g[s] : 0;
+        vigente[k] = (uint8_t)s;
+    }
+    return 0;
+}
+
+void estado_cerrar(void) {
+    if (!archivo)
+        return;
+    estado_sincronizar();
+    munmap(archivo, sizeof(*archivo));
+    archivo = NULL;
+}
+
+// -------------------- Lectura y escritura --------------------
+static int claveValida(int clave) {
+    return archivo && clave >= 0 && clave < ESTADO_CLAVES;
+}
+
+int estado_leer(int clave) {
+    return claveValida(clave) ? valores[clave] : 0;
+}
+
+// Escribe en el registro que no tiene el valor vigente; hasta que esa
+// palabra está completa, el otro sigue valiendo
+void estado_guardar(int clave, int valor) {
+    if (!claveValida(clave) || valor < 0 || valor > 0xFFFF || valores[clave] == valor)
+        return;
+
+    int s = !vigente[clave];
+    uint16_t gen = (uint16_t)(generaciones[clave] + 1);
+
+    archivo->registros[clave][s] = armarRegistro(clave, (uint16_t)valor, gen);
+    valores[clave] = (uint16_t)valor;
+    generaciones[clave] = gen;
+    vigente[clave] = (uint8_t)s;
+}
+
+void estado_sincronizar(void) {
+    if (archivo)
+        msync(archivo, sizeof(*archivo), MS_SYNC);
+}
+
+int estado_descartados(void) {
+    return descartados;
+}
@@ -0,0 +1,36 @@
+#ifndef ESTADO_H
+#define ESTADO_H
+
+#include <stdint.h>
+
+#include "motor.h"
+
+// Estado que sobrevive a un reinicio o a un corte de luz: el delay inicial
+// del menú y la velocidad guardada de cada secuencia. Vive en un archivo
+// chico mapeado en memoria, así arrancar es un mmap() y guardar un valor es
+// una escritura en memoria (el kernel lo baja al archivo solo, o ya mismo
+// con estado_sincronizar()).
+//
+// Cada clave tiene dos registros de 64 bits con número de generación y
+// CRC-16: se escribe siempre el más viejo y se lee el válido más nuevo, así
+// una escritura cortada a la mitad deja el valor anterior, nunca basura.
+// Sin estado_abrir() todo es un no-op y estado_leer() devuelve 0.
+#define ESTADO_VERSION 1
+
+// Claves
+#define ESTADO_DELAY_INICIAL 0
+#define ESTADO_VELOCIDAD(id) (1 + (id))
+#define ESTADO_CLAVES        (1 + MOTOR_MAX_PROGRAMAS)
+
+int  estado_abrir(const char *ruta);   // 1 si no se pudo crear o mapear
+void estado_cerrar(void);
+
+// Todo lo escribe la interfaz (las velocidades, con motor_guardarEstado()):
+// el hilo de salida no toca el archivo
+int  estado_leer(int clave);
+void estado_guardar(int clave, int valor);
+
+void estado_sincronizar(void);
+int  estado_descartados(void);   // registros dañados encontrados al abrir
+
+#endif
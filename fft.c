@@ -0,0 +1,174 @@
+// fft.c
+// FFT radix 2 en punto fijo (ver fft.h). Las muestras entran ya en orden de
+// bits invertidos, así las etapas trabajan en el lugar sin intercambios.
+// Cada etapa tiene su tabla de factores contigua (la de mitad h empieza en
+// h - 1): el bucle interno lee todo de corrido, en escalar y en NEON.
+#include "fft.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define FFT_CON_NEON
+#endif
+
+#define FFT_TECHO   16383   // máximo tras normalizar: la etapa nunca pasa de 16 bits
+#define FFT_PISO    (2 * 15 * 256)   // compensa el mayor corrimiento (14) en fft_energiaLog
+
+static int16_t ventana[FFT_N];            // Hann en Q15
+static int16_t factorRe[FFT_N - 1];
+static int16_t factorIm[FFT_N - 1];
+static uint16_t invertido[FFT_N];
+static int iniciada = 0;
+
+#ifdef FFT_CON_NEON
+static int usarNeon = 1;
+#else
+static int usarNeon = 0;
+#endif
+
+// a * b en Q15 redondeado: lo mismo que vqrdmulhq_s16 (sin su saturación,
+// que acá no se alcanza)
+static inline int16_t mulQ15(int16_t a, int16_t b) {
+    return (int16_t)(((int32_t)a * b + 0x4000) >> 15);
+}
+
+void fft_iniciar(void) {
+    if (iniciada)
+        return;
+
+    for (int i = 0; i < FFT_N; i++) {
+        ventana[i] = (int16_t)lround(32767.0 * (0.5 - 0.5 * cos(2.0 * M_PI * i / FFT_N)));
+
+        unsigned r = 0;
+        for (int b = 0; b < FFT_LOG2; b++)
+            r |= ((i >> b) & 1u) << (FFT_LOG2 - 1 - b);
+        invertido[i] = (uint16_t)r;
+    }
+
+    // W = e^(-2*pi*i*k / 2h) para cada etapa de mitad h
+    for (int h = 1; h < FFT_N; h <<= 1) {
+        for (int k = 0; k < h; k++) {
+            double ang = -M_PI * k / h;
+            factorRe[h - 1 + k] = (int16_t)lround(32767.0 * cos(ang));
+            factorIm[h - 1 + k] = (int16_t)lround(32767.0 * sin(ang));
+        }
+    }
+    iniciada = 1;
+}
+
+// -------------------- Etapas --------------------
+// a' = (a + b*W) / 2, b' = (a - b*W) / 2
+static void etapaEscalar(int16_t *re, int16_t *im, int h) {
+    const int16_t *wr = factorRe + h - 1, *wi = factorIm + h - 1;
+
+    for (int g = 0; g < FFT_N; g += 2 * h) {
+        for (int k = 0; k < h; k++) {
+            int a = g + k, b = a + h;
+            int16_t tr = (int16_t)(mulQ15(re[b], wr[k]) - mulQ15(im[b], wi[k]));
+            int16_t ti = (int16_t)(mulQ15(re[b], wi[k]) + mulQ15(im[b], wr[k]));
+
+            int16_t ar = re[a], ai = im[a];
+            re[a] = (int16_t)((ar + tr) >> 1);
+            im[a] = (int16_t)((ai + ti) >> 1);
+            re[b] = (int16_t)((ar - tr) >> 1);
+            im[b] = (int16_t)((ai - ti) >> 1);
+        }
+    }
+}
+
+#ifdef FFT_CON_NEON
+// Ocho mariposas por vuelta; solo para h >= 8
+static void etapaNeon(int16_t *re, int16_t *im, int h) {
+    const int16_t *fr = factorRe + h - 1, *fi = factorIm + h - 1;
+
+    for (int g = 0; g < FFT_N; g += 2 * h) {
+        for (int k = 0; k < h; k += 8) {
+            int a = g + k, b = a + h;
+            int16x8_t wr = vld1q_s16(fr + k), wi = vld1q_s16(fi + k);
+            int16x8_t br = vld1q_s16(re + b), bi = vld1q_s16(im + b);
+            int16x8_t ar = vld1q_s16(re + a), ai = vld1q_s16(im + a);
+
+            int16x8_t tr = vsubq_s16(vqrdmulhq_s16(br, wr), vqrdmulhq_s16(bi, wi));
+            int16x8_t ti = vaddq_s16(vqrdmulhq_s16(br, wi), vqrdmulhq_s16(bi, wr));
+
+            vst1q_s16(re + a, vhaddq_s16(ar, tr));
+            vst1q_s16(im + a, vhaddq_s16(ai, ti));
+            vst1q_s16(re + b, vhsubq_s16(ar, tr));
+            vst1q_s16(im + b, vhsubq_s16(ai, ti));
+        }
+    }
+}
+#endif
+
+// -------------------- Transformada --------------------
+void fft_transformar(const int16_t *muestras, fftBloque_t *b) {
+    int32_t v[FFT_N];   // muestra * ventana en Q30
+    int32_t maximo = 0;
+
+    for (int i = 0; i < FFT_N; i++) {
+        v[i] = (int32_t)muestras[i] * ventana[i];
+        int32_t m = abs(v[i]);
+        if (m > maximo)
+            maximo = m;
+    }
+
+    if (maximo == 0) {
+        memset(b, 0, sizeof(*b));
+        return;
+    }
+
+    // Se normaliza antes de redondear, así un bloque bajo no pierde bits:
+    // el menor corrimiento 'r' que deja el pico debajo de FFT_TECHO
+    int r = 1;
+    while (((maximo + (1 << (r - 1))) >> r) > FFT_TECHO)
+        r++;
+    b->corrimiento = 15 - r;
+
+    for (int i = 0; i < FFT_N; i++) {
+        b->re[invertido[i]] = (int16_t)((v[i] + (1 << (r - 1))) >> r);
+        b->im[i] = 0;
+    }
+
+    for (int h = 1; h < FFT_N; h <<= 1) {
+#ifdef FFT_CON_NEON
+        if (usarNeon && h >= 8) {
+            etapaNeon(b->re, b->im, h);
+            continue;
+        }
+#endif
+        etapaEscalar(b->re, b->im, h);
+    }
+}
+
+static int log2Q8(uint64_t x) {
+    int e = 63 - __builtin_clzll(x);
+    uint64_t mantisa = e >= 8 ? x >> (e - 8) : x << (8 - e);
+    return e * 256 + (int)(mantisa & 0xFF);   // log2(1 + f) ~ f: error < 0.09
+}
+
+int fft_energiaLog(const fftBloque_t *b, int desde, int hasta) {
+    uint64_t e = 0;
+
+    for (int k = desde; k < hasta; k++)
+        e += (uint64_t)((int32_t)b->re[k] * b->re[k] + (int32_t)b->im[k] * b->im[k]);
+    if (e == 0)
+        return 0;
+
+    int l = log2Q8(e) - 2 * b->corrimiento * 256 + FFT_PISO;
+    return l > 0 ? l : 0;
+}
+
+const char *fft_nucleo(void) {
+    return usarNeon ? "NEON" : "escalar";
+}
+
+void fft_usarEscalar(int escalar) {
+#ifdef FFT_CON_NEON
+    usarNeon = !escalar;
+#else
+    (void)escalar;
+#endif
+}
@@ -0,0 +1,38 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <stdint.h>
+
+// FFT en punto fijo (Q15) para el modo de audio (audio.h). Todo en enteros
+// de 16 bits: cada etapa divide por 2, así nada desborda y el resultado es
+// la DFT dividida por N. Antes de transformar, el bloque ventaneado se
+// normaliza con un corrimiento (coma flotante por bloque) para no perder
+// resolución con la música baja; fft_potencia() lo descuenta.
+//
+// Las mariposas van de a 8 con NEON en la Raspberry (Q15 con
+// vqrdmulhq_s16) y en escalar en cualquier otro lado; las dos dan
+// exactamente los mismos números.
+#define FFT_LOG2     9
+#define FFT_N        (1 << FFT_LOG2)   // 512 muestras: 11.6 ms a 44.1 kHz
+#define FFT_BINS     (FFT_N / 2)
+
+typedef struct {
+    int16_t re[FFT_N];
+    int16_t im[FFT_N];
+    int     corrimiento;   // bits que se subió la entrada al normalizarla
+} fftBloque_t;
+
+void fft_iniciar(void);
+
+// Ventana de Hann sobre 'muestras' (FFT_N), normalizada, y transformada
+void fft_transformar(const int16_t *muestras, fftBloque_t *b);
+
+// Energía de los bins [desde, hasta) en log2 Q8 (256 = x2), ya descontado
+// el corrimiento. Un bloque en silencio da 0.
+int  fft_energiaLog(const fftBloque_t *b, int desde, int hasta);
+
+// Núcleo de las mariposas; fft_usarEscalar(1) fuerza el escalar (benchmark)
+const char *fft_nucleo(void);
+void fft_usarEscalar(int escalar);
+
+#endif
@@ -0,0 +1,21 @@
+// frame.c
+#include "frame.h"
+
+// El ancho tiene que ser múltiplo de 8 (un 74HC595 por cada 8 canales)
+int frame_canalesValidos(int canales) {
+    return canales >= 8 && canales <= FRAME_MAX_CANALES && canales % 8 == 0;
+}
+
+// Estira un patrón de 8 posiciones a 'canales': la posición j enciende los
+// canales [j*N/8, (j+1)*N/8). Con 8 canales queda el patrón tal cual.
+void frame_estirar(uint8_t patron, int canales, frame_t *dest) {
+    int grupo = canales / 8;
+
+    frame_limpiar(dest);
+    for (int j = 0; j < 8; j++) {
+        if (!(patron >> j & 1))
+            continue;
+        for (int c = j * grupo; c < (j + 1) * grupo; c++)
+            dest->w[c >> 6] |= (uint64_t)1 << (c & 63);
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdint.h>
+
+// Frame de N canales empaquetado: bit c = canal c (palabra c / 64, bit c % 64).
+// Las secuencias siguen escritas para 8 posiciones (un uint8_t por paso, ver
+// FRAME8) y se estiran al ancho configurado: cada posición cubre N/8 canales.
+//
+// Es un límite a propósito: el motor (pistas, grupos, brillo y estela) trabaja
+// en esas 8 posiciones y el frame_t aparece recién en el HAL, en el SPI y en
+// el grabador. Con 512 canales se ven 8 bloques de 64 que se prenden juntos;
+// para manejar canales sueltos harían falta secuencias de N posiciones y un
+// motor que lleve frame_t de punta a punta.
+#define FRAME_MAX_CANALES 512
+#define FRAME_PALABRAS    (FRAME_MAX_CANALES / 64)
+
+typedef struct {
+    uint64_t w[FRAME_PALABRAS];
+} frame_t;
+
+static inline void frame_limpiar(frame_t *f) {
+    for (int i = 0; i < FRAME_PALABRAS; i++)
+        f->w[i] = 0;
+}
+
+static inline int frame_canal(const frame_t *f, int c) {
+    return (int)(f->w[c >> 6] >> (c & 63)) & 1;
+}
+
+static inline void frame_poner(frame_t *f, int c, int v) {
+    uint64_t bit = (uint64_t)1 << (c & 63);
+    if (v)
+        f->w[c >> 6] |= bit;
+    else
+        f->w[c >> 6] &= ~bit;
+}
+
+// Byte k del frame (canales 8k..8k+7, bit j = canal 8k+j)
+static inline uint8_t frame_byte(const frame_t *f, int k) {
+    return (uint8_t)(f->w[k >> 3] >> ((k & 7) * 8));
+}
+
+int  frame_canalesValidos(int canales);
+void frame_estirar(uint8_t patron, int canales, frame_t *dest);
+
+#endif
@@ -0,0 +1,186 @@
+// generadores.c
+// Las 8 secuencias del menú como generadores de pasos. No se compila en el
+// programa: lo usa herramientas/gentablas para escribir tablas_generadas.c.
+#include "generadores.h"
+#include "secuencias.h"
+#include "gpio_hal.h"
+
+// -------------------- Armador --------------------
+// Agrega un frame; su duración se acumula con las esperas que le siguen
+void gen_frame(armador_t *a, uint8_t frame) {
+    if (a->n >= a->max) {
+        a->desborde = 1;
+        return;
+    }
+    a->pasos[a->n].frame  = frame;
+    a->pasos[a->n].medios = 0;
+    a->pasos[a->n].fijoMs = 0;
+    a->n++;
+}
+
+// Espera de 'medios' mitades del delay de la secuencia
+void gen_espera(armador_t *a, int medios) {
+    if (a->n > 0)
+        a->pasos[a->n - 1].medios += medios;
+}
+
+// El último frame dura 'ms' fijos, sin importar la velocidad
+void gen_fijo(armador_t *a, int ms) {
+    if (a->n > 0)
+        a->pasos[a->n - 1].fijoMs = (uint16_t)ms;
+}
+
+void gen_tabla(armador_t *a, const uint8_t *frames, int cant) {
+    for (int i = 0; i < cant; i++) {
+        gen_frame(a, frames[i]);
+        gen_espera(a, 2);
+    }
+}
+
+int gen_ejecutar(const generador_t *g, paso_t *pasos, int max) {
+    armador_t a = { pasos, 0, max, 0 };
+    g->generar(&a);
+    return a.desborde ? -1 : a.n;
+}
+
+// Tablas de secuencias (un uint8_t por frame, bit j = LEDS[j])
+// "La carrera" (tabla de datos)
+static const uint8_t carrera[] = {
+    FRAME8(1,0,0,0,0,0,0,0), FRAME8(0,1,0,0,0,0,0,0), FRAME8(0,0,1,0,0,0,0,0),
+    FRAME8(1,0,0,1,0,0,0,0), FRAME8(0,1,0,0,1,0,0,0), FRAME8(0,0,1,0,1,0,0,0),
+    FRAME8(0,0,0,1,0,1,0,0), FRAME8(0,0,0,0,1,1,0,0), FRAME8(0,0,0,0,0,1,1,0),
+    FRAME8(0,0,0,0,0,0,1,0), FRAME8(0,0,0,0,0,0,0,1)
+};
+
+// "El choque" (tabla de datos)
+static const uint8_t choque[] = {
+    FRAME8(1,0,0,0,0,0,0,1), FRAME8(0,1,0,0,0,0,1,0), FRAME8(0,0,1,0,0,1,0,0),
+    FRAME8(0,0,0,1,1,0,0,0), FRAME8(0,0,0,1,1,0,0,0), FRAME8(0,0,1,0,0,1,0,0),
+    FRAME8(0,1,0,0,0,0,1,0), FRAME8(1,0,0,0,0,0,0,1)
+};
+
+// "Salto intermedio" (tabla de datos: LED de por medio)
+static const uint8_t danza[] = {
+    FRAME8(0,0,1,1,0,0,1,1),
+    FRAME8(1,1,0,0,1,1,0,0),
+    FRAME8(0,0,1,1,1,1,0,0),
+    FRAME8(1,1,0,0,0,0,1,1),
+    FRAME8(1,1,1,1,1,1,1,1),
+    FRAME8(1,1,0,0,0,0,1,1),
+    FRAME8(0,0,1,1,1,1,0,0),
+    FRAME8(1,1,0,0,1,1,0,0),
+    FRAME8(0,0,1,1,0,0,1,1),
+};
+
+// "Escalera central" (tabla de datos: se llena hacia el centro y vuelve)
+static const uint8_t escaleraCentral[] = {
+    FRAME8(0,0,0,0,0,0,0,0),
+    FRAME8(1,0,0,0,0,0,0,1),
+    FRAME8(1,1,0,0,0,0,1,1),
+    FRAME8(1,1,1,0,0,1,1,1),
+    FRAME8(1,1,1,1,1,1,1,1),
+    FRAME8(1,1,1,0,0,1,1,1),
+    FRAME8(1,1,0,0,0,0,1,1),
+    FRAME8(1,0,0,0,0,0,0,1)
+};
+
+#define CANT(t) ((int)(sizeof(t) / sizeof((t)[0])))
+
+static void generarCarrera(armador_t *a) {
+    gen_tabla(a, carrera, CANT(carrera));
+}
+
+static void generarChoque(armador_t *a) {
+    gen_tabla(a, choque, CANT(choque));
+}
+
+static void generarDanza(armador_t *a) {
+    gen_tabla(a, danza, CANT(danza));
+}
+
+static void generarEscaleraCentral(armador_t *a) {
+    gen_tabla(a, escaleraCentral, CANT(escaleraCentral));
+}
+
+// -------------------- Secuencia 1: Auto fantástico --------------------
+static void generarAutoFantastico(armador_t *a) {
+    int indice = 0, direccion = 1;
+
+    // Un ciclo completo de ida y vuelta: 0..7..1
+    for (int i = 0; i < 14; i++) {
+        gen_frame(a, (uint8_t)(1u << indice));
+        gen_espera(a, 2);
+
+        indice += direccion;
+        if (indice == 7 || indice == 0)
+            direccion = -direccion;
+    }
+}
+
+// -------------------- Secuencia 3: La apilada --------------------
+static void generarApilada(armador_t *a) {
+    uint8_t estado = 0;   // LEDs ya apilados
+    int apilados = 0;
+
+    gen_frame(a, 0);   // arranca esperando con todo apagado
+
+    while (apilados < 8) {
+        int destino = 7 - apilados;
+
+        for (int pos = 0; pos <= destino; pos++) {
+            gen_espera(a, 2);
+            gen_frame(a, estado | (uint8_t)(1u << pos));
+        }
+
+        for (int k = 0; k < 4; k++) {
+            gen_espera(a, 1);
+            gen_frame(a, estado | ((k % 2 == 0) ? (uint8_t)(1u << destino) : 0));
+        }
+
+        estado |= (uint8_t)(1u << destino);
+        apilados++;
+    }
+
+    // Todos encendidos un segundo y termina (el último parpadeo no tiene espera)
+    a->n--;
+    gen_frame(a, 0xFF);
+    gen_fijo(a, 1000);
+}
+
+// -------------------- Secuencia 5: Binario completo --------------------
+static void generarBinarioCompleto(armador_t *a) {
+    for (unsigned int val = 0; val < 256; val++) {
+        gen_frame(a, (uint8_t)val);
+        gen_espera(a, 2);
+    }
+}
+
+// -------------------- Secuencia 7: FOFO (First On, First Off) --------------------
+static void generarFirstOnFirstOff(armador_t *a) {
+    for (int i = 0; i < 8; i++) { // Encendido progresivo
+        // Enciende los LEDs desde el primero hasta el actual, el resto apagados
+        gen_frame(a, (uint8_t)((2u << i) - 1));
+        gen_espera(a, 2);
+    }
+
+    gen_espera(a, 2);             // Pausa con todos encendidos
+
+    for (int i = 0; i < 8; i++) { // Apagado progresivo
+        // Apaga los LEDs desde el primero hasta el actual, el resto encendidos
+        gen_frame(a, (uint8_t)~((2u << i) - 1));
+        gen_espera(a, 2);
+    }
+}
+
+// En el orden del menú (SEC_*)
+const generador_t generadores[] = {
+    [SEC_AUTO]     = { "El auto fantastico",        "auto_fantastico",   1, generarAutoFantastico },
+    [SEC_CHOQUE]   = { "El choque",                 "choque",            1, generarChoque },
+    [SEC_APILADA]  = { "La apilada",                "apilada",           0, generarApilada },
+    [SEC_CARRERA]  = { "La carrera",                "carrera",           1, generarCarrera },
+    [SEC_BINARIO]  = { "Contador binario completo", "binario_completo",  1, generarBinarioCompleto },
+    [SEC_DANZA]    = { "Danza de luces",            "danza",             1, generarDanza },
+    [SEC_FOFO]     = { "First On - First Off",      "first_on_first_off", 1, generarFirstOnFirstOff },
+    [SEC_ESCALERA] = { "Escalera central",          "escalera_central",  1, generarEscaleraCentral },
+};
+const int cantGeneradores = CANT(generadores);
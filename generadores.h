@@ -0,0 +1,35 @@
+#ifndef GENERADORES_H
+#define GENERADORES_H
+
+#include "motor.h"
+
+// Interfaz común de las secuencias: cada una es un generador que emite sus
+// frames y esperas en un armador. Las deterministas se corren una sola vez al
+// compilar (herramientas/gentablas) y el programa solo ve las tablas de pasos
+// que quedaron en tablas_generadas.c.
+typedef struct {
+    paso_t *pasos;
+    int n;
+    int max;
+    int desborde;   // 1 si se quiso emitir más de 'max' pasos
+} armador_t;
+
+void gen_frame(armador_t *a, uint8_t frame);
+void gen_espera(armador_t *a, int medios);
+void gen_fijo(armador_t *a, int ms);
+void gen_tabla(armador_t *a, const uint8_t *frames, int cant);
+
+typedef struct {
+    const char *nombre;
+    const char *simbolo;   // nombre de la tabla en el código generado
+    int bucle;
+    void (*generar)(armador_t *a);
+} generador_t;
+
+extern const generador_t generadores[];
+extern const int cantGeneradores;
+
+// Corre un generador; devuelve la cantidad de pasos o -1 si no entraron en 'max'
+int gen_ejecutar(const generador_t *g, paso_t *pasos, int max);
+
+#endif
@@ -0,0 +1,274 @@
+// gpio_hal.c
+#include "gpio_hal.h"
+#include "frame.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <linux/spi/spidev.h>
+
+#ifndef HAL_SIN_WIRINGPI
+#include <wiringPi.h>
+#endif
+
+// Registros del bloque GPIO del BCM283x (índices en palabras de 32 bits)
+#define GPFSEL0        0
+#define GPSET0         7
+#define GPCLR0        10
+#define GPIO_LARGO_MAPA 4096
+
+#define MAX_PINES 8
+
+static int backendActual = -1;
+static volatile uint32_t *gpio = NULL;
+
+static unsigned char pinesHal[MAX_PINES];
+static int cantPines = 0;
+
+// Máscara GPIO (bits 0..31 del banco 0) correspondiente a cada frame posible.
+// Un frame se aplica con una sola escritura a GPSET0 y otra a GPCLR0.
+static uint32_t lutMascara[256];
+static uint32_t mascaraTodos = 0;
+
+static uint8_t frameActual = 0;
+static unsigned long cantEscrituras = 0;
+
+// Cadena de 74HC595 por SPI: cada frame sale en una sola transferencia y el
+// flanco de CS al terminar hace de latch. Con 'spiFalso' el "dispositivo" es
+// un archivo común que queda con el último frame (para probar sin placa).
+static int canalesHal = 8;
+static int spiFd = -1;
+static int spiFalso = 0;
+static int bytesSpi = 0;
+static uint8_t *lutSpi = NULL;     // 256 patrones ya estirados, en orden de salida
+static uint8_t bufSpi[FRAME_MAX_CANALES / 8];
+static struct spi_ioc_transfer transferencia;
+
+static void armarTablaMascaras(void) {
+    mascaraTodos = 0;
+    for (int i = 0; i < cantPines; i++)
+        mascaraTodos |= 1u << pinesHal[i];
+
+    for (int f = 0; f < 256; f++) {
+        uint32_t m = 0;
+        for (int i = 0; i < cantPines; i++)
+            if (f & (1 << i))
+                m |= 1u << pinesHal[i];
+        lutMascara[f] = m;
+    }
+}
+
+static int iniciarGpiomem(void) {
+    int fd = open("/dev/gpiomem", O_RDWR | O_SYNC | O_CLOEXEC);
+    if (fd < 0)
+        return 1;
+
+    void *p = mmap(NULL, GPIO_LARGO_MAPA, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return 1;
+
+    gpio = (volatile uint32_t *)p;
+
+    // Configurar cada pin como salida (función 001 en GPFSELn)
+    for (int i = 0; i < cantPines; i++) {
+        int pin = pinesHal[i];
+        volatile uint32_t *fsel = &gpio[GPFSEL0 + pin / 10];
+        int shift = (pin % 10) * 3;
+        *fsel = (*fsel & ~(7u << shift)) | (1u << shift);
+    }
+    return 0;
+}
+
+// -------------------- Inicialización --------------------
+int hal_iniciar(int backend, const unsigned char *pines, int n_pines) {
+    if (backendActual >= 0 || n_pines > MAX_PINES)
+        return 1;
+
+    for (int i = 0; i < n_pines; i++) {
+        if (pines[i] > 31)   // solo banco 0
+            return 1;
+        pinesHal[i] = pines[i];
+    }
+    cantPines = n_pines;
+    armarTablaMascaras();
+
+    switch (backend) {
+    case HAL_GPIOMEM:
+        if (iniciarGpiomem() != 0)
+            return 1;
+        break;
+
+    case HAL_WIRINGPI:
+#ifndef HAL_SIN_WIRINGPI
+        for (int i = 0; i < cantPines; i++)
+            pinMode(pinesHal[i], OUTPUT);
+        break;
+#else
+        return 1;
+#endif
+
+    case HAL_SIMULADO:
+        break;
+
+    default:
+        return 1;
+    }
+
+    backendActual = backend;
+    canalesHal = cantPines;
+    hal_escribirFrame(0);
+    return 0;
+}
+
+// -------------------- Backend SPI (74HC595 en cadena) --------------------
+// El primer byte que sale termina en el último registro de la cadena, así que
+// el buffer va del último chip al primero; cada byte sale MSB primero (Q7..Q0).
+static void ordenarParaSpi(const frame_t *f, uint8_t *dest) {
+    for (int k = 0; k < bytesSpi; k++)
+        dest[bytesSpi - 1 - k] = frame_byte(f, k);
+}
+
+static void enviarSpi(const uint8_t *datos) {
+    if (spiFalso) {
+        if (pwrite(spiFd, datos, bytesSpi, 0) < 0) {
+            // como con el dispositivo real: un frame perdido no frena al resto
+        }
+        return;
+    }
+    transferencia.tx_buf = (uintptr_t)datos;
+    ioctl(spiFd, SPI_IOC_MESSAGE(1), &transferencia);
+}
+
+int hal_iniciarSpi(const char *ruta, int canales, uint32_t hz) {
+    if (backendActual >= 0 || !frame_canalesValidos(canales))
+        return 1;
+
+    int fd = open(ruta, O_RDWR | O_CLOEXEC);
+    if (fd < 0)
+        return 1;
+
+    struct stat st;
+    spiFalso = fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+
+    if (!spiFalso) {
+        uint8_t modo = SPI_MODE_0, bits = 8;
+        if (ioctl(fd, SPI_IOC_WR_MODE, &modo) < 0 ||
+            ioctl(fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0 ||
+            ioctl(fd, SPI_IOC_WR_MAX_SPEED_HZ, &hz) < 0) {
+            close(fd);
+            return 1;
+        }
+    }
+
+    bytesSpi = canales / 8;
+    uint8_t *lut = malloc(256 * (size_t)bytesSpi);
+    if (!lut) {
+        close(fd);
+        return 1;
+    }
+
+    // Los 256 patrones de 8 posiciones ya estirados: en el hilo de salida un
+    // frame de secuencia es buscar su fila y mandarla, sin armar nada
+    frame_t f;
+    for (int p = 0; p < 256; p++) {
+        frame_estirar((uint8_t)p, canales, &f);
+        ordenarParaSpi(&f, lut + p * bytesSpi);
+    }
+
+    memset(&transferencia, 0, sizeof(transferencia));
+    transferencia.len = bytesSpi;
+    transferencia.speed_hz = hz;
+    transferencia.bits_per_word = 8;
+
+    lutSpi = lut;
+    spiFd = fd;
+    canalesHal = canales;
+    backendActual = HAL_SPI;
+    hal_escribirFrame(0);
+    return 0;
+}
+
+// -------------------- Escritura de un frame completo --------------------
+void hal_escribirFrame(uint8_t frame) {
+    frameActual = frame;
+    cantEscrituras++;
+
+    switch (backendActual) {
+    case HAL_GPIOMEM: {
+        uint32_t on = lutMascara[frame];
+        gpio[GPSET0] = on;
+        gpio[GPCLR0] = mascaraTodos & ~on;
+        break;
+    }
+
+#ifndef HAL_SIN_WIRINGPI
+    case HAL_WIRINGPI:
+        for (int j = 0; j < cantPines; j++)
+            digitalWrite(pinesHal[j], (frame >> j) & 1);
+        break;
+#endif
+
+    case HAL_SPI:
+        enviarSpi(lutSpi + frame * bytesSpi);
+        break;
+
+    default:   // HAL_SIMULADO
+        break;
+    }
+}
+
+// Frame de canales armado por fuera (no un patrón de 8). En los backends de
+// pines sueltos solo cuentan los primeros canales.
+void hal_escribirCanales(const frame_t *f) {
+    if (backendActual != HAL_SPI) {
+        hal_escribirFrame(frame_byte(f, 0));
+        return;
+    }
+
+    frameActual = frame_byte(f, 0);
+    cantEscrituras++;
+    ordenarParaSpi(f, bufSpi);
+    enviarSpi(bufSpi);
+}
+
+int hal_canales(void) {
+    return canalesHal;
+}
+
+uint8_t hal_frameActual(void) {
+    return frameActual;
+}
+
+unsigned long hal_cantEscrituras(void) {
+    return cantEscrituras;
+}
+
+int hal_backend(void) {
+    return backendActual;
+}
+
+void hal_cerrar(void) {
+    if (backendActual < 0)
+        return;
+
+    hal_escribirFrame(0);
+
+    if (gpio) {
+        munmap((void *)gpio, GPIO_LARGO_MAPA);
+        gpio = NULL;
+    }
+    if (spiFd >= 0) {
+        close(spiFd);
+        spiFd = -1;
+        free(lutSpi);
+        lutSpi = NULL;
+    }
+    backendActual = -1;
+}
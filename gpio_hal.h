@@ -0,0 +1,31 @@
+#ifndef GPIO_HAL_H
+#define GPIO_HAL_H
+
+#include <stdint.h>
+
+#include "frame.h"
+
+// Backends de salida
+#define HAL_GPIOMEM   0   // registros GPSET0/GPCLR0 mapeados desde /dev/gpiomem
+#define HAL_WIRINGPI  1   // digitalWrite() pin por pin (respaldo)
+#define HAL_SIMULADO  2   // sin hardware: solo guarda el último frame
+#define HAL_SPI       3   // cadena de 74HC595 por spidev (o archivo que lo simula)
+
+// Empaqueta el estado de los 8 LEDs en una máscara (bit j = LEDS[j])
+#define FRAME8(a, b, c, d, e, f, g, h) \
+    (uint8_t)((a) | (b) << 1 | (c) << 2 | (d) << 3 | (e) << 4 | (f) << 5 | (g) << 6 | (h) << 7)
+
+// Una salida a la vez: devuelven 1 si ya hay una iniciada (hal_cerrar() antes)
+int  hal_iniciar(int backend, const unsigned char *pines, int n_pines);
+int  hal_iniciarSpi(const char *ruta, int canales, uint32_t hz);
+
+// Patrón de 8 posiciones (se estira a los canales configurados) o frame completo
+void hal_escribirFrame(uint8_t frame);
+void hal_escribirCanales(const frame_t *f);
+int  hal_canales(void);
+uint8_t hal_frameActual(void);
+unsigned long hal_cantEscrituras(void);
+int  hal_backend(void);
+void hal_cerrar(void);
+
+#endif
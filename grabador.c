@@ -0,0 +1,272 @@
+// grabador.c
+// Grabador de frames (ver grabador.h). Graba solo el hilo de salida: no
+// hace falta ningún lock. El archivo lo agranda un hilo aparte, nunca el
+// que graba.
+#include "grabador.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#define GRAB_INICIAL (4ul << 20)     // se agranda al doble cuando va por la mitad
+#define GRAB_MAXIMO  (256ul << 20)
+#define GRAB_REVISAR_MS 10           // cada cuánto mira el hilo que agranda
+
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23       // Linux 5.14; en uno más viejo falla y listo
+#endif
+
+static grabCabecera_t *cabecera = NULL;   // seguida de los registros
+static _Atomic size_t capacidad = 0;      // bytes ya reservados en disco (cabecera incluida)
+static int fdGrab = -1;
+static pthread_t hiloAgrandar;
+static atomic_int cortarAgrandar = 0;
+
+static int bytesFrame = 1;
+static uint8_t *estirados = NULL;         // los 256 patrones ya estirados
+static uint8_t anterior[GRAB_BYTES_MAX];
+static uint64_t largo = 0;
+static uint64_t frames = 0;
+static uint64_t ultimoUs = 0;
+
+static uint64_t ahoraNs(clockid_t reloj) {
+    struct timespec t;
+    clock_gettime(reloj, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+static uint8_t *registros(void) {
+    return (uint8_t *)(cabecera + 1);
+}
+
+static uint8_t *ponerVarint(uint8_t *p, uint64_t v) {
+    while (v >= 0x80) {
+        *p++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+// Espacio en disco reservado de antemano: un disco lleno no puede terminar
+// en un SIGBUS al escribir en el mapa. Las páginas nuevas se tocan acá para
+// que el hilo de salida no se lleve el fallo de página al llegar.
+static int reservar(size_t desde, size_t hasta) {
+    if (posix_fallocate(fdGrab, (off_t)desde, (off_t)(hasta - desde)) != 0)
+        return 1;
+    madvise((uint8_t *)cabecera + desde, hasta - desde, MADV_POPULATE_WRITE);
+    return 0;
+}
+
+// -------------------- Hilo que agranda --------------------
+// El mapa cubre GRAB_MAXIMO desde grab_abrir (solo direcciones: no ocupa
+// memoria ni disco), así que agrandar es reservar más archivo detrás de lo
+// ya escrito, sin mover nada. Se hace cuando lo grabado pasa la mitad: a
+// ~1000 frames/s hay minutos de margen, y si igual se llenara el frame se
+// descarta en vez de esperar.
+static void *agrandarEnFondo(void *arg) {
+    (void)arg;
+    struct timespec espera = { 0, GRAB_REVISAR_MS * 1000000L };
+
+    while (!atomic_load(&cortarAgrandar)) {
+        size_t cap = atomic_load(&capacidad);
+        size_t usado = sizeof(grabCabecera_t) +
+                       atomic_load_explicit(&cabecera->largo, memory_order_relaxed);
+
+        if (usado > cap / 2 && cap < GRAB_MAXIMO) {
+            size_t nueva = cap * 2 < GRAB_MAXIMO ? cap * 2 : GRAB_MAXIMO;
+            if (reservar(cap, nueva) != 0)
+                break;   // disco lleno: lo que no entre se cuenta en descartados
+            atomic_store(&capacidad, nueva);
+            continue;
+        }
+        nanosleep(&espera, NULL);
+    }
+    return NULL;
+}
+
+// -------------------- Grabación --------------------
+static void grabar(const uint8_t *nuevo) {
+    uint64_t t = ahoraNs(CLOCK_MONOTONIC);
+
+    if (sizeof(grabCabecera_t) + largo + GRAB_REGISTRO_MAX > atomic_load_explicit(&capacidad, memory_order_acquire)) {
+        atomic_store_explicit(&cabecera->descartados,
+                              atomic_load_explicit(&cabecera->descartados, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+        return;
+    }
+    if (frames == 0)
+        cabecera->inicioNs = t;
+
+    uint8_t delta[GRAB_BYTES_MAX];
+    uint64_t mascara = 0;
+    int n = 0;
+    // De a 8 bytes: en un frame ancho casi todos los tramos quedan iguales
+    for (int w = 0; w < bytesFrame; w += 8) {
+        int largoTramo = bytesFrame - w < 8 ? bytesFrame - w : 8;
+        uint64_t a = 0, b = 0;
+
+        memcpy(&a, anterior + w, largoTramo);
+        memcpy(&b, nuevo + w, largoTramo);
+        if (a == b)
+            continue;
+        for (int k = w; k < w + largoTramo; k++) {
+            uint8_t x = nuevo[k] ^ anterior[k];
+            if (x) {
+                mascara |= (uint64_t)1 << k;
+                delta[n++] = x;
+                anterior[k] = nuevo[k];
+            }
+        }
+    }
+
+    uint64_t us = (t - cabecera->inicioNs) / 1000;
+    uint8_t *p = registros() + largo;
+    p = ponerVarint(p, us - ultimoUs);
+    p = ponerVarint(p, mascara);
+    memcpy(p, delta, n);
+    ultimoUs = us;
+    largo = (uint64_t)(p + n - registros());
+    frames++;
+
+    // El registro queda completo antes de que el largo lo incluya
+    atomic_store_explicit(&cabecera->frames, frames, memory_order_relaxed);
+    atomic_store_explicit(&cabecera->largo, largo, memory_order_release);
+}
+
+void grab_patron(uint8_t patron) {
+    if (cabecera)
+        grabar(estirados + patron * bytesFrame);
+}
+
+void grab_canales(const frame_t *f) {
+    if (!cabecera)
+        return;
+
+    uint8_t bytes[GRAB_BYTES_MAX];
+    for (int k = 0; k < bytesFrame; k++)
+        bytes[k] = frame_byte(f, k);
+    grabar(bytes);
+}
+
+// -------------------- Abrir y cerrar --------------------
+int grab_abrir(const char *ruta, int canales) {
+    if (cabecera)
+        return 0;
+    if (!frame_canalesValidos(canales))
+        return 1;
+
+    fdGrab = open(ruta, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fdGrab < 0)
+        return 1;
+
+    int bytes = canales / 8;
+    uint8_t *lut = malloc(256 * (size_t)bytes);
+    void *m = MAP_FAILED;
+    if (lut)
+        m = mmap(NULL, GRAB_MAXIMO, PROT_READ | PROT_WRITE, MAP_SHARED, fdGrab, 0);
+    if (m != MAP_FAILED) {
+        cabecera = m;
+        if (reservar(0, GRAB_INICIAL) != 0) {
+            munmap(m, GRAB_MAXIMO);
+            cabecera = NULL;
+            m = MAP_FAILED;
+        }
+    }
+    if (m == MAP_FAILED) {
+        free(lut);
+        close(fdGrab);
+        fdGrab = -1;
+        unlink(ruta);
+        return 1;
+    }
+
+    // Igual que en el HAL: un patrón de secuencia se graba como su fila
+    frame_t f;
+    for (int p = 0; p < 256; p++) {
+        frame_estirar((uint8_t)p, canales, &f);
+        for (int k = 0; k < bytes; k++)
+            lut[p * bytes + k] = frame_byte(&f, k);
+    }
+
+    atomic_store(&capacidad, GRAB_INICIAL);
+    *cabecera = (grabCabecera_t){
+        .magia = GRAB_MAGIA,
+        .version = GRAB_VERSION,
+        .canales = (uint16_t)canales,
+        .inicioRealNs = (int64_t)ahoraNs(CLOCK_REALTIME),
+    };
+    estirados = lut;
+    bytesFrame = bytes;
+    memset(anterior, 0, sizeof(anterior));
+    largo = frames = ultimoUs = 0;
+
+    atomic_store(&cortarAgrandar, 0);
+    if (pthread_create(&hiloAgrandar, NULL, agrandarEnFondo, NULL) != 0) {
+        // se graba igual, hasta GRAB_INICIAL
+        atomic_store(&cortarAgrandar, -1);
+    }
+    return 0;
+}
+
+void grab_cerrar(void) {
+    if (!cabecera)
+        return;
+
+    if (atomic_exchange(&cortarAgrandar, 1) == 0)
+        pthread_join(hiloAgrandar, NULL);
+    munmap(cabecera, GRAB_MAXIMO);
+    cabecera = NULL;
+    if (ftruncate(fdGrab, (off_t)(sizeof(grabCabecera_t) + largo)) != 0) {
+        // queda del largo reservado: el lector se guía por la cabecera
+    }
+    close(fdGrab);
+    fdGrab = -1;
+    free(estirados);
+    estirados = NULL;
+}
+
+// -------------------- Lectura --------------------
+void grab_lector(lectorGrab_t *l, const grabCabecera_t *c, const uint8_t *regs, uint64_t largoRegs) {
+    l->p = regs;
+    l->fin = regs + largoRegs;
+    l->bytes = c->canales / 8;
+    l->us = 0;
+    memset(l->frame, 0, sizeof(l->frame));
+}
+
+static int leerVarint(lectorGrab_t *l, uint64_t *v) {
+    *v = 0;
+    for (int s = 0; s < 64 && l->p < l->fin; s += 7) {
+        uint8_t b = *l->p++;
+        *v |= (uint64_t)(b & 0x7F) << s;
+        if (!(b & 0x80))
+            return 0;
+    }
+    return 1;
+}
+
+int grab_siguiente(lectorGrab_t *l) {
+    uint64_t dt, mascara;
+
+    if (l->p >= l->fin)
+        return 0;
+    if (leerVarint(l, &dt) || leerVarint(l, &mascara))
+        return -1;
+    if (l->bytes < 64 && mascara >> l->bytes)
+        return -1;
+
+    for (int k = 0; mascara; k++, mascara >>= 1) {
+        if (!(mascara & 1))
+            continue;
+        if (l->p >= l->fin)
+            return -1;
+        l->frame[k] ^= *l->p++;
+    }
+    l->us += dt;
+    return 1;
+}
@@ -0,0 +1,66 @@
+#ifndef GRABADOR_H
+#define GRABADOR_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "frame.h"
+
+// Grabador de la salida: cada frame que publica el hilo de salida (uno por
+// paso, no cada plano de BAM) queda en un archivo binario con su instante,
+// para ver después en el lugar qué se mostró y cuándo (herramientas/ledplay
+// lo repasa o lo vuelve a sacar por los LEDs).
+//
+// El archivo se mapea en memoria y se escribe de corrido desde el hilo de
+// salida: grabar un frame es tomar la hora y copiar unos pocos bytes, sin
+// llamadas al sistema. El archivo lo agranda un hilo propio del grabador,
+// adelantándose a lo que se va escribiendo. Si el programa se cae, lo
+// escrito hasta 'largo' ya está en el archivo.
+//
+//   cabecera (64 bytes)  registros...
+//
+// Registro: varint(us desde el anterior) varint(máscara de bytes cambiados)
+// y, por cada bit de la máscara (bit k = byte k del frame), el XOR de ese
+// byte con el frame anterior. Un frame de 8 canales ocupa 3 o 4 bytes.
+// Sin grab_abrir() grabar es un no-op.
+#define GRAB_MAGIA      0x42415247u   // "GRAB"
+#define GRAB_VERSION    1
+#define GRAB_BYTES_MAX  (FRAME_MAX_CANALES / 8)
+#define GRAB_REGISTRO_MAX (10 + 10 + GRAB_BYTES_MAX)
+
+typedef struct {
+    uint32_t magia;
+    uint16_t version;
+    uint16_t canales;
+    uint64_t inicioNs;             // CLOCK_MONOTONIC del primer frame
+    int64_t  inicioRealNs;         // CLOCK_REALTIME al abrir (para ubicarlo en el día)
+    _Atomic uint64_t largo;        // bytes de registros completos
+    _Atomic uint64_t frames;
+    _Atomic uint64_t descartados;  // no entraron: el archivo llegó al máximo o no dio el disco
+    uint8_t  reservado[16];
+} grabCabecera_t;
+
+_Static_assert(sizeof(grabCabecera_t) == 64, "la cabecera ocupa 64 bytes");
+
+// Empieza a grabar los frames de 'canales' (hal_canales()). 1 si no se pudo.
+int  grab_abrir(const char *ruta, int canales);
+void grab_cerrar(void);   // deja el archivo del largo justo
+
+// Desde el hilo de salida: patrón de 8 posiciones o frame completo
+void grab_patron(uint8_t patron);
+void grab_canales(const frame_t *f);
+
+// -------------------- Lectura --------------------
+// Recorre registros ya mapeados (no copia nada): 'frame' tiene siempre el
+// frame completo vigente
+typedef struct {
+    const uint8_t *p, *fin;
+    int bytes;                     // bytes por frame
+    uint64_t us;                   // desde el primer frame
+    uint8_t frame[GRAB_BYTES_MAX];
+} lectorGrab_t;
+
+void grab_lector(lectorGrab_t *l, const grabCabecera_t *c, const uint8_t *registros, uint64_t largo);
+int  grab_siguiente(lectorGrab_t *l);   // 1 = hay frame, 0 = fin, -1 = registro roto
+
+#endif
@@ -0,0 +1,65 @@
+// gentablas.c
+// Expande al compilar las secuencias incorporadas: corre cada generador de
+// generadores.c y escribe las tablas de pasos como C constante (tablas.h),
+// así el programa no arma nada al arrancar y las tablas quedan en .rodata.
+//
+// Uso: gentablas salida.c
+#include "generadores.h"
+
+#include <stdio.h>
+
+#define MAX_PASOS 4096   // por secuencia
+
+static paso_t pasos[MAX_PASOS];
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "Uso: %s salida.c\n", argv[0]);
+        return 1;
+    }
+
+    FILE *f = fopen(argv[1], "w");
+    if (!f) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    fprintf(f, "// Generado por herramientas/gentablas a partir de generadores.c: no editar\n");
+    fprintf(f, "#include \"tablas.h\"\n");
+
+    int total = 0;
+    for (int i = 0; i < cantGeneradores; i++) {
+        const generador_t *g = &generadores[i];
+        int n = gen_ejecutar(g, pasos, MAX_PASOS);
+
+        if (n <= 0) {
+            fprintf(stderr, "%s: %s\n", g->nombre, n < 0 ? "demasiados pasos" : "sin pasos");
+            fclose(f);
+            remove(argv[1]);
+            return 1;
+        }
+
+        fprintf(f, "\n// %s\nstatic const paso_t pasos_%s[%d] = {", g->nombre, g->simbolo, n);
+        for (int p = 0; p < n; p++)
+            fprintf(f, "%s{0x%02x, %u, %u},", p % 6 ? " " : "\n    ",
+                    pasos[p].frame, pasos[p].medios, pasos[p].fijoMs);
+        fprintf(f, "\n};\n");
+        total += n;
+    }
+
+    fprintf(f, "\nconst programa_t tablasGeneradas[] = {\n");
+    for (int i = 0; i < cantGeneradores; i++) {
+        const generador_t *g = &generadores[i];
+        fprintf(f, "    { \"%s\", pasos_%s, (int)(sizeof(pasos_%s) / sizeof(paso_t)), %d, 0, NULL },\n",
+                g->nombre, g->simbolo, g->simbolo, g->bucle);
+    }
+    fprintf(f, "};\nconst int cantTablasGeneradas = %d;\n", cantGeneradores);
+
+    if (fclose(f) != 0) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    printf("%s: %d secuencias, %d pasos\n", argv[1], cantGeneradores, total);
+    return 0;
+}
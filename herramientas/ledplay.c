@@ -0,0 +1,303 @@
+// ledplay.c
+// Repasa una grabación de la salida (ver grabador.h): sin opciones muestra
+// los tiempos entre frames y los huecos; con -r vuelve a sacar los frames
+// por los LEDs, o por el backend simulado, con los tiempos originales.
+//
+// El archivo se mapea solo para lectura y se recorre una vez de punta a
+// punta, soltando lo ya leído: una grabación de horas no se carga entera.
+//
+// Uso: ledplay [-r] [-v factor] [-m] [-h ms] archivo
+//   -r  reproducir (misma salida que luces: LUCES_SPI, LUCES_SIMULADO o GPIO)
+//   -v  factor de velocidad al reproducir (2 = el doble de rápido)
+//   -m  mostrar cada frame en la terminal mientras se reproduce
+//   -h  intervalo que cuenta como hueco en las estadísticas (100 ms)
+#include "grabador.h"
+#include "gpio_hal.h"
+#include "secuencias.h"
+
+#include <wiringPi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define CASILLEROS    24          // casillero b: [2^(b-1), 2^b) us, como la telemetría
+#define PEORES_HUECOS 5
+#define SOLTAR_CADA   (8ul << 20) // bytes leídos entre cada madvise(MADV_DONTNEED)
+
+int modoRemoto = 0;   // secuencias.c lo toma de main.c (acá solo se usa LEDS)
+
+static volatile sig_atomic_t cortar = 0;
+
+static void alCortar(int sig) {
+    (void)sig;
+    cortar = 1;
+}
+
+typedef struct {
+    uint64_t us, duracion;
+} hueco_t;
+
+// -------------------- Archivo --------------------
+static const grabCabecera_t *cabecera;
+static size_t largoMapa;
+
+static int mapear(const char *ruta, uint64_t *largo) {
+    int fd = open(ruta, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        perror(ruta);
+        return 1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(grabCabecera_t)) {
+        fprintf(stderr, "%s: no es una grabación\n", ruta);
+        close(fd);
+        return 1;
+    }
+
+    largoMapa = (size_t)st.st_size;
+    void *m = mmap(NULL, largoMapa, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    madvise(m, largoMapa, MADV_SEQUENTIAL);
+
+    cabecera = m;
+    if (cabecera->magia != GRAB_MAGIA || cabecera->version != GRAB_VERSION ||
+        !frame_canalesValidos(cabecera->canales)) {
+        fprintf(stderr, "%s: no es una grabación de esta versión\n", ruta);
+        return 1;
+    }
+
+    // Un archivo más largo que lo que dice la cabecera es de un programa que
+    // no llegó a cerrarlo; uno más corto, uno truncado a mano
+    uint64_t dice = atomic_load_explicit((_Atomic uint64_t *)&cabecera->largo, memory_order_acquire);
+    uint64_t hay = largoMapa - sizeof(grabCabecera_t);
+    *largo = dice < hay ? dice : hay;
+    if (dice > hay)
+        fprintf(stderr, "Aviso: el archivo está cortado, se lee hasta donde llega\n");
+    else if (hay > dice)
+        fprintf(stderr, "Aviso: la grabación no se cerró (¿se cortó el programa?)\n");
+    return 0;
+}
+
+// Lo ya recorrido vuelve al kernel: la memoria no crece con el archivo
+static void soltarLeido(const lectorGrab_t *l, size_t *soltado) {
+    size_t leido = (size_t)(l->p - (const uint8_t *)cabecera);
+    size_t pagina = (size_t)sysconf(_SC_PAGESIZE);
+
+    if (leido - *soltado < SOLTAR_CADA)
+        return;
+    size_t hasta = leido / pagina * pagina;
+    madvise((uint8_t *)cabecera + *soltado, hasta - *soltado, MADV_DONTNEED);
+    *soltado = hasta;
+}
+
+static void primerLector(lectorGrab_t *l, uint64_t largo) {
+    grab_lector(l, cabecera, (const uint8_t *)(cabecera + 1), largo);
+}
+
+// -------------------- Estadísticas --------------------
+static uint64_t percentil(const uint64_t *casilleros, uint64_t total, int p) {
+    uint64_t objetivo = (total * (uint64_t)p + 99) / 100, acumulado = 0;
+
+    for (int b = 0; b < CASILLEROS; b++) {
+        acumulado += casilleros[b];
+        if (acumulado >= objetivo)
+            return b == 0 ? 1 : (uint64_t)1 << b;
+    }
+    return (uint64_t)1 << (CASILLEROS - 1);
+}
+
+// Los PEORES_HUECOS más largos, de mayor a menor
+static void insertarHueco(hueco_t *peores, int *cant, uint64_t us, uint64_t duracion) {
+    int i;
+
+    if (*cant < PEORES_HUECOS)
+        i = (*cant)++;
+    else if (peores[PEORES_HUECOS - 1].duracion < duracion)
+        i = PEORES_HUECOS - 1;
+    else
+        return;
+
+    while (i > 0 && peores[i - 1].duracion < duracion) {
+        peores[i] = peores[i - 1];
+        i--;
+    }
+    peores[i] = (hueco_t){ us, duracion };
+}
+
+static int estadisticas(const char *ruta, uint64_t largo, uint64_t huecoUs) {
+    lectorGrab_t l;
+    uint64_t casilleros[CASILLEROS] = { 0 };
+    uint64_t frames = 0, repetidos = 0, huecos = 0, maxUs = 0, anterior = 0;
+    hueco_t peores[PEORES_HUECOS];
+    int cantPeores = 0, r;
+    size_t soltado = 0;
+
+    primerLector(&l, largo);
+    while ((r = grab_siguiente(&l)) == 1) {
+        uint64_t dt = l.us - anterior;
+        anterior = l.us;
+
+        if (frames++ > 0) {
+            int b = dt ? 64 - __builtin_clzll(dt) : 0;
+            casilleros[b < CASILLEROS ? b : CASILLEROS - 1]++;
+            if (dt > maxUs)
+                maxUs = dt;
+            if (dt >= huecoUs) {
+                huecos++;
+                insertarHueco(peores, &cantPeores, l.us - dt, dt);
+            }
+        }
+        if (l.p[-1] == 0)   // máscara vacía: el mismo frame otra vez
+            repetidos++;
+        soltarLeido(&l, &soltado);
+    }
+
+    time_t inicio = (time_t)(cabecera->inicioRealNs / 1000000000LL);
+    char fecha[32];
+    strftime(fecha, sizeof(fecha), "%Y-%m-%d %H:%M:%S", localtime(&inicio));
+
+    printf("%s: %d canales, grabado el %s\n", ruta, cabecera->canales, fecha);
+    printf("%llu frames en %.3f s (%.1f por segundo), %.2f bytes por frame\n",
+           (unsigned long long)frames, l.us / 1e6, l.us ? frames * 1e6 / l.us : 0.0,
+           frames ? (double)largo / frames : 0.0);
+    printf("repetidos %llu, descartados por falta de lugar %llu\n", (unsigned long long)repetidos,
+           (unsigned long long)atomic_load((_Atomic uint64_t *)&cabecera->descartados));
+    if (r < 0)
+        printf("registro roto después del frame %llu: se corta ahí\n", (unsigned long long)frames);
+
+    uint64_t intervalos = frames > 1 ? frames - 1 : 0;
+    if (intervalos) {
+        uint64_t p50 = percentil(casilleros, intervalos, 50), p99 = percentil(casilleros, intervalos, 99);
+        printf("\nintervalo entre frames (us): prom %.1f  p50 %llu  p99 %llu  max %llu\n",
+               (double)l.us / intervalos, (unsigned long long)(p50 < maxUs ? p50 : maxUs),
+               (unsigned long long)(p99 < maxUs ? p99 : maxUs), (unsigned long long)maxUs);
+        for (int b = 0; b < CASILLEROS; b++)
+            if (casilleros[b])
+                printf("  < %8llu us  %10llu\n", (unsigned long long)1 << b, (unsigned long long)casilleros[b]);
+    }
+
+    printf("\nhuecos de %llu ms o más: %llu\n", (unsigned long long)(huecoUs / 1000), (unsigned long long)huecos);
+    for (int i = 0; i < cantPeores; i++)
+        printf("  a los %10.3f s: %8.1f ms sin frames\n", peores[i].us / 1e6, peores[i].duracion / 1e3);
+    return r < 0;
+}
+
+// -------------------- Reproducción --------------------
+static int iniciarSalida(int canales) {
+    const char *ruta_spi = getenv("LUCES_SPI");
+    if (ruta_spi) {
+        const char *c = getenv("LUCES_CANALES");
+        return hal_iniciarSpi(ruta_spi, c ? atoi(c) : canales, 8000000);
+    }
+    if (getenv("LUCES_SIMULADO"))
+        return hal_iniciar(HAL_SIMULADO, LEDS, 8);
+    if (wiringPiSetupGpio() == -1)
+        return 1;
+    return hal_iniciar(HAL_GPIOMEM, LEDS, 8) != 0 && hal_iniciar(HAL_WIRINGPI, LEDS, 8) != 0;
+}
+
+static void mostrarFrame(const lectorGrab_t *l) {
+    int canales = l->bytes * 8 < 64 ? l->bytes * 8 : 64;
+
+    printf("%12.6f  ", l->us / 1e6);
+    for (int c = 0; c < canales; c++)
+        putchar(l->frame[c / 8] >> (c % 8) & 1 ? '#' : '.');
+    putchar('\n');
+}
+
+static int reproducir(uint64_t largo, double factor, int mostrar) {
+    if (iniciarSalida(cabecera->canales) != 0) {
+        fprintf(stderr, "Error al inicializar la salida de LEDs\n");
+        return 1;
+    }
+    signal(SIGINT, alCortar);
+    signal(SIGTERM, alCortar);
+
+    lectorGrab_t l;
+    struct timespec t0, ahora;
+    uint64_t frames = 0, atrasoMax = 0, atrasoTotal = 0;
+    size_t soltado = 0;
+    frame_t f;
+    int r;
+
+    primerLector(&l, largo);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    while (!cortar && (r = grab_siguiente(&l)) == 1) {
+        uint64_t ns = (uint64_t)(l.us * 1000.0 / factor);
+        struct timespec vence = {
+            .tv_sec = t0.tv_sec + (time_t)(ns / 1000000000ULL),
+            .tv_nsec = t0.tv_nsec + (long)(ns % 1000000000ULL),
+        };
+        if (vence.tv_nsec >= 1000000000L) {
+            vence.tv_sec++;
+            vence.tv_nsec -= 1000000000L;
+        }
+        while (!cortar && clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &vence, NULL) == EINTR)
+            ;
+
+        if (l.bytes == 1) {
+            hal_escribirFrame(l.frame[0]);
+        } else {
+            frame_limpiar(&f);
+            for (int k = 0; k < l.bytes; k++)
+                f.w[k >> 3] |= (uint64_t)l.frame[k] << ((k & 7) * 8);
+            hal_escribirCanales(&f);
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &ahora);
+        long atraso = (ahora.tv_sec - vence.tv_sec) * 1000000L + (ahora.tv_nsec - vence.tv_nsec) / 1000L;
+        if (atraso > 0) {
+            atrasoTotal += (uint64_t)atraso;
+            if ((uint64_t)atraso > atrasoMax)
+                atrasoMax = (uint64_t)atraso;
+        }
+        frames++;
+        if (mostrar)
+            mostrarFrame(&l);
+        soltarLeido(&l, &soltado);
+    }
+    hal_cerrar();
+
+    printf("%s: %llu frames en %.3f s, atraso prom %.1f us, max %llu us\n",
+           cortar ? "cortado" : "reproducido", (unsigned long long)frames, l.us / 1e6 / factor,
+           frames ? (double)atrasoTotal / frames : 0.0, (unsigned long long)atrasoMax);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    int repro = 0, mostrar = 0, opt;
+    double factor = 1.0;
+    uint64_t huecoUs = 100000;
+
+    while ((opt = getopt(argc, argv, "rv:mh:")) != -1) {
+        switch (opt) {
+        case 'r': repro = 1; break;
+        case 'v': factor = atof(optarg); break;
+        case 'm': mostrar = 1; break;
+        case 'h': huecoUs = (uint64_t)atoi(optarg) * 1000; break;
+        default:
+            fprintf(stderr, "Uso: %s [-r] [-v factor] [-m] [-h ms] archivo\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind != argc - 1 || factor <= 0 || huecoUs == 0) {
+        fprintf(stderr, "Uso: %s [-r] [-v factor] [-m] [-h ms] archivo\n", argv[0]);
+        return 1;
+    }
+
+    uint64_t largo;
+    if (mapear(argv[optind], &largo) != 0)
+        return 1;
+    return repro ? reproducir(largo, factor, mostrar) : estadisticas(argv[optind], largo, huecoUs);
+}
@@ -0,0 +1,205 @@
+// ledsim.c
+// Corre las secuencias en el motor virtual (motor_iniciarVirtual): sin hilo,
+// sin placa y sin esperar, de vencimiento en vencimiento. De cada una sale
+// una traza de texto con cada cambio del frame y el ms (virtual) en que
+// pasó; a los dos tercios se le cambia la velocidad a la mitad del delay,
+// así la traza también cubre ese camino.
+//
+// Con -o se escriben las trazas; con -c se comparan contra las guardadas
+// (secuencias/trazas, las "de oro") y se muestra la primera diferencia.
+// Una corrida completa de las ocho simula minutos en milisegundos.
+//
+// Uso: ledsim [-b biblioteca] [-d delay] [-t ms] (-o dir | -c dir) [id...]
+#include "motor.h"
+#include "secuencias.h"
+#include "gpio_hal.h"
+#include "reloj.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DELAY_MS    100
+#define DURACION_MS 20000
+
+int modoRemoto = 0;   // secuencias.c lo toma de main.c
+
+static long ahoraUs(void) {
+    struct timespec t;
+    reloj_ahora(&t);
+    return t.tv_sec * 1000000L + t.tv_nsec / 1000L;
+}
+
+static void linea(FILE *f, long ms, uint8_t frame) {
+    char leds[9];
+    for (int j = 0; j < 8; j++)
+        leds[j] = (frame >> j) & 1 ? '*' : '.';
+    leds[8] = '\0';
+    fprintf(f, "%8ld %s\n", ms, leds);
+}
+
+// 01_el_auto_fantastico.traza
+static void nombreTraza(int id, const char *dir, char *ruta, size_t tam) {
+    char base[64];
+    const char *n = secuencias_nombre(id);
+    size_t k = 0;
+
+    for (; *n && k < sizeof(base) - 1; n++)
+        if (isalnum((unsigned char)*n))
+            base[k++] = (char)tolower((unsigned char)*n);
+        else if (k > 0 && base[k - 1] != '_')
+            base[k++] = '_';
+    base[k] = '\0';
+    snprintf(ruta, tam, "%s/%02d_%s.traza", dir, id + 1, base);
+}
+
+// La traza de una secuencia en 'f'; devuelve los frames que cambiaron
+static long simular(int id, int delay, long duracionMs, FILE *f) {
+    long inicio = ahoraUs(), fin = inicio + duracionMs * 1000L;
+    long cambioVelocidad = inicio + duracionMs * 2000L / 3;
+    uint8_t frame;
+    long cambios = 1;
+
+    fprintf(f, "# %s: delay %d ms, %d ms desde %ld ms, %ld ms simulados\n",
+            secuencias_nombre(id), delay, delay / 2, duracionMs * 2 / 3, duracionMs);
+
+    motor_resetVelocidades();   // cada una arranca de cero, sin lo que dejó la anterior
+    motor_reproducir(id, delay);
+    frame = hal_frameActual();
+    linea(f, 0, frame);
+
+    for (int tramo = 0; tramo < 2; tramo++) {
+        long hasta = tramo == 0 ? cambioVelocidad : fin;
+        while (motor_simular(hasta)) {
+            if (hal_frameActual() == frame)
+                continue;
+            frame = hal_frameActual();
+            linea(f, (ahoraUs() - inicio) / 1000, frame);
+            cambios++;
+        }
+        if (tramo == 0)
+            motor_cambiarVelocidad(delay / 2);
+    }
+    fprintf(f, "%8ld fin%s\n", duracionMs, motor_activo() < 0 ? " (terminó sola)" : "");
+    motor_detener();
+    return cambios;
+}
+
+// Primera línea distinta entre lo simulado y la traza guardada
+static int comparar(const char *ruta, const char *simulada, size_t largo) {
+    FILE *f = fopen(ruta, "r");
+    if (!f) {
+        printf("%s: no existe (generarla con -o)\n", ruta);
+        return 1;
+    }
+
+    FILE *s = fmemopen((void *)simulada, largo, "r");
+    char esperada[128], salio[128];
+    int n = 0, distinta = 0;
+
+    while (!distinta) {
+        char *a = fgets(esperada, sizeof(esperada), f);
+        char *b = fgets(salio, sizeof(salio), s);
+        n++;
+        if (!a && !b)
+            break;
+        if (!a || !b || strcmp(a, b) != 0) {
+            esperada[strcspn(esperada, "\n")] = '\0';
+            salio[strcspn(salio, "\n")] = '\0';
+            printf("%s: línea %d\n  esperada: %s\n  salió:    %s\n", ruta, n,
+                   a ? esperada : "(fin)", b ? salio : "(fin)");
+            distinta = 1;
+        }
+    }
+    fclose(s);
+    fclose(f);
+    return distinta;
+}
+
+static double segundos(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    const char *biblioteca = getenv("LUCES_BIBLIOTECA");
+    const char *dirSalida = NULL, *dirOro = NULL;
+    int delay = DELAY_MS, opt;
+    long duracionMs = DURACION_MS;
+
+    while ((opt = getopt(argc, argv, "b:d:t:o:c:")) != -1) {
+        switch (opt) {
+        case 'b': biblioteca = optarg; break;
+        case 'd': delay = atoi(optarg); break;
+        case 't': duracionMs = atol(optarg); break;
+        case 'o': dirSalida = optarg; break;
+        case 'c': dirOro = optarg; break;
+        default:
+            dirSalida = dirOro = NULL;
+            break;
+        }
+    }
+    if ((!dirSalida == !dirOro) || delay < MOTOR_FRAME_MIN_MS || duracionMs <= 0) {
+        fprintf(stderr, "Uso: %s [-b biblioteca] [-d delay] [-t ms] (-o dir | -c dir) [id...]\n", argv[0]);
+        return 1;
+    }
+
+    if (hal_iniciar(HAL_SIMULADO, LEDS, 8) != 0 || motor_iniciarVirtual() != 0) {
+        fprintf(stderr, "No se pudo iniciar el motor virtual\n");
+        return 1;
+    }
+    secuencias_iniciar(biblioteca);
+
+    int ids[SEC_CANTIDAD], cant = 0;
+    for (int i = optind; i < argc && cant < SEC_CANTIDAD; i++)
+        ids[cant++] = atoi(argv[i]);
+    if (cant == 0)
+        for (; cant < SEC_CANTIDAD; cant++)
+            ids[cant] = cant;
+
+    int fallas = 0;
+    long frames = 0;
+    double t0 = segundos();
+
+    for (int i = 0; i < cant; i++) {
+        if (ids[i] < 0 || ids[i] >= secuencias_cantidad()) {
+            fprintf(stderr, "No hay secuencia %d\n", ids[i]);
+            return 1;
+        }
+
+        char ruta[512], *texto = NULL;
+        size_t largo = 0;
+        FILE *f = open_memstream(&texto, &largo);
+        if (!f) {
+            perror("open_memstream");
+            return 1;
+        }
+        frames += simular(ids[i], delay, duracionMs, f);
+        fclose(f);
+
+        nombreTraza(ids[i], dirSalida ? dirSalida : dirOro, ruta, sizeof(ruta));
+        if (dirSalida) {
+            FILE *o = fopen(ruta, "w");
+            if (!o || fwrite(texto, 1, largo, o) != largo || fclose(o) != 0) {
+                perror(ruta);
+                return 1;
+            }
+        } else {
+            fallas += comparar(ruta, texto, largo);
+        }
+        free(texto);
+    }
+    motor_cerrar();
+
+    double ms = (segundos() - t0) * 1e3;
+    printf("%d secuencias, %ld frames, %.0f s simulados en %.1f ms (%.0fx)%s\n", cant, frames,
+           cant * duracionMs / 1e3, ms, cant * duracionMs / ms,
+           dirOro ? (fallas ? "" : ": todas iguales a las guardadas") : "");
+    if (fallas)
+        printf("%d de %d distintas\n", fallas, cant);
+    return fallas != 0;
+}
@@ -0,0 +1,171 @@
+// ledstat.c
+// Muestra en vivo la telemetría del programa (ver telemetria.h): mapea el
+// segmento de memoria compartida solo para lectura y lo recorre cada tanto.
+// Del lado del programa no hay nada que atender: ni llamadas ni locks.
+//
+// Uso: ledstat [-n nombre] [-i ms] [-1]
+//   -n  nombre del segmento (por defecto TELE_NOMBRE o LUCES_TELEMETRIA)
+//   -i  intervalo entre pantallas en ms (1000)
+//   -1  una sola pasada, sin borrar la pantalla (para scripts)
+#include "telemetria.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+typedef struct {
+    const char *nombre;
+    size_t offset;
+} campo_t;
+
+static const campo_t contadores[] = {
+    { "salida.frames",              offsetof(telemetria_t, salida.frames) },
+    { "salida.perdidos",            offsetof(telemetria_t, salida.perdidos) },
+    { "salida.escrituras",          offsetof(telemetria_t, salida.escrituras) },
+    { "salida.ciclosBam",           offsetof(telemetria_t, salida.ciclosBam) },
+    { "salida.comandos",            offsetof(telemetria_t, salida.comandos) },
+    { "interfaz.despertares",       offsetof(telemetria_t, interfaz.despertares) },
+    { "interfaz.teclas",            offsetof(telemetria_t, interfaz.teclas) },
+    { "interfaz.bytesEntrada",      offsetof(telemetria_t, interfaz.bytesEntrada) },
+    { "interfaz.bytesSalida",       offsetof(telemetria_t, interfaz.bytesSalida) },
+    { "interfaz.bytesDescartados",  offsetof(telemetria_t, interfaz.bytesDescartados) },
+    { "interfaz.estadosColapsados", offsetof(telemetria_t, interfaz.estadosColapsados) },
+    { "interfaz.tramas",            offsetof(telemetria_t, interfaz.tramas) },
+    { "interfaz.tramasDescartadas", offsetof(telemetria_t, interfaz.tramasDescartadas) },
+    { "adc.muestras",               offsetof(telemetria_t, adc.muestras) },
+    { "adc.cambios",                offsetof(telemetria_t, adc.cambios) },
+};
+#define CANT_CONTADORES (int)(sizeof(contadores) / sizeof(contadores[0]))
+
+static const campo_t histogramas[] = {
+    { "salida.atraso",    offsetof(telemetria_t, salida.atraso) },
+    { "salida.escritura", offsetof(telemetria_t, salida.escritura) },
+    { "interfaz.entrada", offsetof(telemetria_t, interfaz.entrada) },
+    { "adc.lectura",      offsetof(telemetria_t, adc.lectura) },
+};
+#define CANT_HISTOGRAMAS (int)(sizeof(histogramas) / sizeof(histogramas[0]))
+
+static uint64_t leer(const teleContador_t *c) {
+    return atomic_load_explicit((teleContador_t *)c, memory_order_relaxed);
+}
+
+static const teleContador_t *contador(const telemetria_t *t, int i) {
+    return (const teleContador_t *)((const char *)t + contadores[i].offset);
+}
+
+static const teleHistograma_t *histograma(const telemetria_t *t, int i) {
+    return (const teleHistograma_t *)((const char *)t + histogramas[i].offset);
+}
+
+// Límite superior (us) del casillero donde cae el percentil 'p'
+static uint64_t percentil(const uint64_t *casilleros, uint64_t total, int p) {
+    uint64_t objetivo = (total * (uint64_t)p + 99) / 100, acumulado = 0;
+
+    for (int b = 0; b < TELE_CASILLEROS; b++) {
+        acumulado += casilleros[b];
+        if (acumulado >= objetivo)
+            return b == 0 ? 1 : (uint64_t)1 << b;
+    }
+    return (uint64_t)1 << (TELE_CASILLEROS - 1);
+}
+
+static void mostrar(const telemetria_t *t, const uint64_t *anteriores, double segs, int vivo) {
+    printf("luces pid %d%s - %.0f s desde el arranque\n\n", t->pid, vivo ? "" : " (terminó)",
+           (tele_ahoraNs() - t->inicioNs) / 1e9);
+
+    printf("%-28s %14s %12s\n", "contador", "total", "por segundo");
+    for (int i = 0; i < CANT_CONTADORES; i++) {
+        uint64_t v = leer(contador(t, i));
+        printf("%-28s %14llu", contadores[i].nombre, (unsigned long long)v);
+        if (anteriores && segs > 0)
+            printf(" %12.1f", (double)(v - anteriores[i]) / segs);
+        printf("\n");
+    }
+
+    printf("\n%-28s %10s %8s %8s %8s %8s  (us)\n", "histograma", "cuenta", "prom", "p50", "p99", "max");
+    for (int i = 0; i < CANT_HISTOGRAMAS; i++) {
+        const teleHistograma_t *h = histograma(t, i);
+        uint64_t casilleros[TELE_CASILLEROS], total = 0;
+
+        // La cuenta se arma con los casilleros leídos, no con h->cuenta: así
+        // los percentiles son coherentes aunque el hilo esté escribiendo
+        for (int b = 0; b < TELE_CASILLEROS; b++)
+            total += casilleros[b] = leer(&h->casilleros[b]);
+
+        printf("%-28s %10llu", histogramas[i].nombre, (unsigned long long)total);
+        if (total) {
+            // Los percentiles son el borde del casillero: nunca más que el máximo visto
+            uint64_t max = leer(&h->maximoUs);
+            uint64_t p50 = percentil(casilleros, total, 50), p99 = percentil(casilleros, total, 99);
+            printf(" %8.1f %8llu %8llu %8llu", (double)leer(&h->sumaUs) / total,
+                   (unsigned long long)(p50 < max ? p50 : max),
+                   (unsigned long long)(p99 < max ? p99 : max), (unsigned long long)max);
+        }
+        printf("\n");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const char *nombre = getenv("LUCES_TELEMETRIA");
+    int intervaloMs = 1000, unaVez = 0;
+    int opt;
+
+    if (!nombre)
+        nombre = TELE_NOMBRE;
+    while ((opt = getopt(argc, argv, "n:i:1")) != -1) {
+        switch (opt) {
+        case 'n': nombre = optarg; break;
+        case 'i': intervaloMs = atoi(optarg); break;
+        case '1': unaVez = 1; break;
+        default:
+            fprintf(stderr, "Uso: %s [-n nombre] [-i ms] [-1]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (intervaloMs <= 0)
+        intervaloMs = 1000;
+
+    int fd = shm_open(nombre, O_RDONLY, 0);
+    if (fd < 0) {
+        fprintf(stderr, "No hay telemetría en %s (¿está corriendo luces?)\n", nombre);
+        return 1;
+    }
+    const telemetria_t *t = mmap(NULL, sizeof(telemetria_t), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (t == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    if (t->magia != TELE_MAGIA || t->version != TELE_VERSION || t->tamanio != sizeof(telemetria_t)) {
+        fprintf(stderr, "%s: versión de telemetría distinta (recompilar ledstat)\n", nombre);
+        return 1;
+    }
+
+    uint64_t anteriores[CANT_CONTADORES];
+    uint64_t antes = 0;
+    int primera = 1;
+
+    while (1) {
+        int vivo = kill(t->pid, 0) == 0;
+        uint64_t ahora = tele_ahoraNs();
+
+        if (!unaVez)
+            printf("\x1b[H\x1b[2J");
+        mostrar(t, primera ? NULL : anteriores, (ahora - antes) / 1e9, vivo);
+        fflush(stdout);
+
+        if (unaVez || !vivo)
+            return 0;
+
+        for (int i = 0; i < CANT_CONTADORES; i++)
+            anteriores[i] = leer(contador(t, i));
+        antes = ahora;
+        primera = 0;
+        usleep((useconds_t)intervaloMs * 1000);
+    }
+}
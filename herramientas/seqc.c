@@ -0,0 +1,244 @@
+// seqc.c
+// Compilador de secuencias: traduce archivos de texto .sec a la biblioteca
+// binaria que el programa principal abre con mmap (ver biblioteca.h).
+//
+// Uso: seqc salida.lsb entrada1.sec [entrada2.sec ...]
+//
+// Formato de entrada (una secuencia empieza en cada "nombre"):
+//   # comentario
+//   nombre  La carrera
+//   delay   0            delay por defecto en ms (0 = el delay inicial del menú)
+//   modo    bucle        bucle | una_vez
+//   2  10000000 01000000 duración y uno o más frames con esa duración
+//   1000ms 11111111      duración fija en ms
+// Duración: mitades del delay de la secuencia (2 = un delay) o "<n>ms".
+// Frame: 8 dígitos 0/1 (LED0 primero, como FRAME8) o hexadecimal 0xNN (bit j = LED j).
+#include "biblioteca.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define MAX_PASOS_TOTAL (1 << 20)
+
+typedef struct {
+    bibEntrada_t entrada;
+    int primerPaso;
+} secuencia_t;
+
+static secuencia_t secuencias[MOTOR_MAX_PROGRAMAS];
+static int cantSecuencias = 0;
+
+static paso_t pasos[MAX_PASOS_TOTAL];
+static int cantPasos = 0;
+
+static const char *archivoActual;
+static int lineaActual;
+
+static void error(const char *msg) {
+    fprintf(stderr, "%s:%d: %s\n", archivoActual, lineaActual, msg);
+    exit(1);
+}
+
+static secuencia_t *actual(void) {
+    if (cantSecuencias == 0)
+        error("falta 'nombre' antes de la secuencia");
+    return &secuencias[cantSecuencias - 1];
+}
+
+static int leerFrame(const char *tok, uint8_t *frame) {
+    if (tok[0] == '0' && (tok[1] == 'x' || tok[1] == 'X')) {
+        char *fin;
+        long v = strtol(tok + 2, &fin, 16);
+        if (*fin != '\0' || fin == tok + 2 || v < 0 || v > 0xFF)
+            return 1;
+        *frame = (uint8_t)v;
+        return 0;
+    }
+
+    if (strlen(tok) != 8)
+        return 1;
+
+    uint8_t f = 0;
+    for (int j = 0; j < 8; j++) {
+        if (tok[j] != '0' && tok[j] != '1')
+            return 1;
+        if (tok[j] == '1')
+            f |= (uint8_t)(1u << j);
+    }
+    *frame = f;
+    return 0;
+}
+
+static void leerDuracion(const char *tok, paso_t *base) {
+    char *fin;
+    long v = strtol(tok, &fin, 10);
+
+    base->medios = 0;
+    base->fijoMs = 0;
+
+    if (fin == tok || v <= 0)
+        error("duración inválida");
+
+    if (strcmp(fin, "ms") == 0) {
+        if (v > 65535)
+            error("duración fija mayor a 65535 ms");
+        base->fijoMs = (uint16_t)v;
+    } else if (*fin == '\0') {
+        if (v > 255)
+            error("duración mayor a 255 medios delays");
+        base->medios = (uint8_t)v;
+    } else {
+        error("duración inválida");
+    }
+}
+
+static void directiva(const char *clave, char *resto) {
+    if (strcmp(clave, "nombre") == 0) {
+        if (cantSecuencias == MOTOR_MAX_PROGRAMAS)
+            error("demasiadas secuencias");
+        if (*resto == '\0' || strlen(resto) >= BIB_NOMBRE)
+            error("nombre vacío o demasiado largo");
+
+        secuencia_t *s = &secuencias[cantSecuencias++];
+        memset(s, 0, sizeof(*s));
+        strcpy(s->entrada.nombre, resto);
+        s->entrada.bucle = 1;
+        s->primerPaso = cantPasos;
+    } else if (strcmp(clave, "delay") == 0) {
+        long v = strtol(resto, NULL, 10);
+        if (v < 0 || v > 65535)
+            error("delay fuera de rango");
+        actual()->entrada.delayMs = (uint16_t)v;
+    } else if (strcmp(clave, "modo") == 0) {
+        if (strcmp(resto, "bucle") == 0)
+            actual()->entrada.bucle = 1;
+        else if (strcmp(resto, "una_vez") == 0)
+            actual()->entrada.bucle = 0;
+        else
+            error("modo debe ser 'bucle' o 'una_vez'");
+    } else {
+        error("directiva desconocida");
+    }
+}
+
+static void lineaDePasos(char *linea) {
+    secuencia_t *s = actual();
+    paso_t base;
+    char *tok = strtok(linea, " \t");
+
+    leerDuracion(tok, &base);
+
+    int frames = 0;
+    while ((tok = strtok(NULL, " \t")) != NULL) {
+        if (cantPasos == MAX_PASOS_TOTAL || cantPasos - s->primerPaso == 65535)
+            error("demasiados pasos");
+        if (leerFrame(tok, &base.frame) != 0)
+            error("frame inválido");
+        pasos[cantPasos++] = base;
+        frames++;
+    }
+    if (frames == 0)
+        error("falta al menos un frame");
+}
+
+static void compilarArchivo(const char *ruta) {
+    FILE *f = fopen(ruta, "r");
+    if (!f) {
+        perror(ruta);
+        exit(1);
+    }
+
+    char linea[1024];
+    archivoActual = ruta;
+    lineaActual = 0;
+
+    while (fgets(linea, sizeof(linea), f)) {
+        lineaActual++;
+
+        char *c = strchr(linea, '#');
+        if (c)
+            *c = '\0';
+
+        // Recortar espacios al principio y al final
+        char *ini = linea;
+        while (isspace((unsigned char)*ini))
+            ini++;
+        char *fin = ini + strlen(ini);
+        while (fin > ini && isspace((unsigned char)fin[-1]))
+            *--fin = '\0';
+        if (*ini == '\0')
+            continue;
+
+        if (isdigit((unsigned char)*ini)) {
+            lineaDePasos(ini);
+        } else {
+            char *resto = ini;
+            while (*resto && !isspace((unsigned char)*resto))
+                resto++;
+            if (*resto) {
+                *resto++ = '\0';
+                while (isspace((unsigned char)*resto))
+                    resto++;
+            }
+            directiva(ini, resto);
+        }
+    }
+    fclose(f);
+}
+
+static void escribir(FILE *f, const void *p, size_t n) {
+    if (fwrite(p, 1, n, f) != n) {
+        perror("escritura");
+        exit(1);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Uso: %s salida.lsb entrada.sec [...]\n", argv[0]);
+        return 1;
+    }
+
+    for (int i = 2; i < argc; i++)
+        compilarArchivo(argv[i]);
+
+    for (int i = 0; i < cantSecuencias; i++) {
+        int fin = (i + 1 < cantSecuencias) ? secuencias[i + 1].primerPaso : cantPasos;
+        if (fin == secuencias[i].primerPaso) {
+            fprintf(stderr, "secuencia '%s' sin pasos\n", secuencias[i].entrada.nombre);
+            return 1;
+        }
+        secuencias[i].entrada.cantPasos = (uint16_t)(fin - secuencias[i].primerPaso);
+    }
+
+    uint32_t offsetPasos = sizeof(bibCabecera_t) + cantSecuencias * sizeof(bibEntrada_t);
+    bibCabecera_t cab = {
+        .magia = BIB_MAGIA,
+        .version = BIB_VERSION,
+        .cantSecuencias = (uint16_t)cantSecuencias,
+        .largo = offsetPasos + cantPasos * sizeof(paso_t),
+    };
+
+    FILE *f = fopen(argv[1], "wb");
+    if (!f) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    escribir(f, &cab, sizeof(cab));
+    for (int i = 0; i < cantSecuencias; i++) {
+        secuencias[i].entrada.offsetPasos = offsetPasos + secuencias[i].primerPaso * sizeof(paso_t);
+        escribir(f, &secuencias[i].entrada, sizeof(bibEntrada_t));
+    }
+    escribir(f, pasos, cantPasos * sizeof(paso_t));
+
+    if (fclose(f) != 0) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    printf("%s: %d secuencias, %d pasos, %u bytes\n", argv[1], cantSecuencias, cantPasos, cab.largo);
+    return 0;
+}
@@ -6,56 +6,212 @@
 #include <string.h>
 #include <unistd.h>
 #include <termios.h>
+#include <strings.h>
+#include <pthread.h>
 
 #include "nocanonico.h"
 #include "secuencias.h"
+#include "gpio_hal.h"
+#include "reactor.h"
+#include "motor.h"
+#include "uart_tx.h"
+#include "decodificador.h"
+#include "adc.h"
+#include "pantalla.h"
+#include "protocolo.h"
+#include "control.h"
+#include "estado.h"
+#include "telemetria.h"
+#include "grabador.h"
+#include "arranque.h"
 
 #define BASE 120
 #define ADDR 0x48
+#define ADC_HZ 50      // muestras por segundo del potenciómetro
+#define ADC_JUEGOS 8   // con LUCES_I2C: juegos de 4 canales por ráfaga
+#define ERROR_WIRINGPI 1   // de iniciarDispositivos()
+#define ERROR_ADC      2
+#define DELAY_ARRANQUE 500   // secuencia de LUCES_INICIO sin velocidad guardada (el ADC todavía no leyó)
 #define FD_STDIN 0
 #define CLAVE_CORRECTA "renzo123"
 
+#define CANALES_SPI 64        // ancho por defecto de la cadena de 74HC595
+#define SPI_HZ      8000000   // 64 canales salen en ~8 us
+
 #define UART "/dev/ttyAMA0"
 #define BAUDRATE 38400
 
-extern int map(int x, int in_min, int in_max, int out_min, int out_max);
+#define BIBLIOTECA "secuencias.lsb"   // biblioteca compilada por herramientas/seqc
+#define CONTROL_SOCKET "/tmp/luces.sock"   // socket Unix del servidor de control
+#define ESTADO "luces.estado"              // velocidades guardadas entre ejecuciones (estado.h)
 
 int autenticar();
 int ajustar_velocidad_inicial(int delay_actual);
+void leerLinea(char *buf, int tam);
+void leerLineaRemota(char *buf, int tam);
+int hayEnter(entrada_t *e);
+void mostrarMenuPrincipal(int delay_inicial, int invalida);
+void mostrarMensaje(const char *linea1, const char *linea2);
+void ejecutarSecuencia(int id, int delay_inicial);
+void otrasSecuencias(int delay_inicial);
+void abrirUart(void);
+int secuenciaInicio(const char *nombre);
+void *iniciarDispositivos(void *arg);
+int esperarDispositivos(void);
 
 
 int serial_fd = -1;     // descriptor UART (se usa en modo remoto)
 int modoRemoto = 0;    // 0 = local, 1 = remoto
+int id_arranque = -1;  // la de LUCES_INICIO mientras no se elija otra
+pthread_t *dispositivos_hilo = NULL;   // hasta que esperarDispositivos() lo junta
+int dispositivos_error = 0;
 
 int main() {
     int opcion;
     int modo = 0;           // 1 = local, 2 = remoto
     int modo_forzado = 0;   // para cambiar de modo desde la opción 12
 
-    system("clear");
-
-    // Iniciar GPIO
-    if (wiringPiSetupGpio() == -1) {
-        fprintf(stderr, "Error al inicializar wiringPi\n");
+    arranque_iniciar();
+
+    // Contadores para herramientas/ledstat (LUCES_TELEMETRIA cambia el nombre
+    // del segmento). Antes que cualquier hilo: después 'tele' ya no cambia.
+    int fase = arranque_fase("telemetría");
+    const char *nombre_tele = getenv("LUCES_TELEMETRIA");
+    if (tele_iniciar(nombre_tele ? nombre_tele : TELE_NOMBRE) != 0)
+        fprintf(stderr, "Aviso: sin segmento de telemetría\n");
+    arranque_fin(fase);
+
+    // wiringPi, el PCF8591 y la primera lectura del ADC no hacen falta para
+    // encender las luces: van en otro hilo mientras se pide la contraseña
+    pthread_t hilo_dispositivos;
+    if (pthread_create(&hilo_dispositivos, NULL, iniciarDispositivos, NULL) != 0) {
+        fprintf(stderr, "Error al iniciar los dispositivos\n");
         return 1;
     }
-
-    // LEDs como salida y en "LOW"
-    for (int i = 0; i < 8; i++) {
-        pinMode(LEDS[i], OUTPUT);
-        digitalWrite(LEDS[i], LOW);
+    dispositivos_hilo = &hilo_dispositivos;
+
+    // LEDs como salida y en "LOW": registros directos, wiringPi como respaldo,
+    // o backend simulado si se pide con LUCES_SIMULADO=1. Con LUCES_SPI la
+    // salida es una cadena de 74HC595 de LUCES_CANALES canales (un archivo
+    // común en LUCES_SPI hace de spidev falso); las secuencias siguen siendo
+    // de 8 posiciones y cada una prende un bloque de LUCES_CANALES/8 (ver
+    // frame.h). Solo el respaldo de wiringPi tiene que esperar al otro hilo.
+    fase = arranque_fase("salida de LEDs");
+    int hal_ok;
+    const char *ruta_spi = getenv("LUCES_SPI");
+    if (ruta_spi) {
+        const char *canales = getenv("LUCES_CANALES");
+        hal_ok = hal_iniciarSpi(ruta_spi, canales ? atoi(canales) : CANALES_SPI, SPI_HZ) == 0;
+    } else if (getenv("LUCES_SIMULADO"))
+        hal_ok = hal_iniciar(HAL_SIMULADO, LEDS, 8) == 0;
+    else
+        hal_ok = hal_iniciar(HAL_GPIOMEM, LEDS, 8) == 0 ||
+                 (esperarDispositivos() != ERROR_WIRINGPI && hal_iniciar(HAL_WIRINGPI, LEDS, 8) == 0);
+    if (!hal_ok) {
+        fprintf(stderr, "Error al inicializar la salida de LEDs\n");
+        return 1;
+    }
+    arranque_fin(fase);
+
+    // Con LUCES_GRABACION cada frame que sale queda en ese archivo, para
+    // repasarlo o volver a mostrarlo con herramientas/ledplay
+    const char *ruta_grabacion = getenv("LUCES_GRABACION");
+    fase = arranque_fase("grabación");
+    if (ruta_grabacion && grab_abrir(ruta_grabacion, hal_canales()) != 0)
+        fprintf(stderr, "Aviso: no se pudo grabar la salida en %s\n", ruta_grabacion);
+    arranque_fin(fase);
+
+    fase = arranque_fase("reactor");
+    if (reactor_iniciar() != 0) {
+        fprintf(stderr, "Error al inicializar el reactor de eventos\n");
+        return 1;
+    }
+    arranque_fin(fase);
+
+    // Velocidades de la ejecución anterior (LUCES_ESTADO cambia el archivo).
+    // Se abre antes del hilo de salida, que lo lee al arrancar.
+    fase = arranque_fase("estado");
+    const char *ruta_estado = getenv("LUCES_ESTADO");
+    if (estado_abrir(ruta_estado ? ruta_estado : ESTADO) != 0)
+        fprintf(stderr, "Aviso: sin archivo de estado, las velocidades no se guardan\n");
+    arranque_fin(fase);
+
+    // Hilo de salida de LEDs (SCHED_FIFO si hay permisos)
+    fase = arranque_fase("biblioteca de secuencias");
+    const char *ruta_biblioteca = getenv("LUCES_BIBLIOTECA");
+    secuencias_iniciar(ruta_biblioteca ? ruta_biblioteca : BIBLIOTECA);
+    // Opción 14: LUCES_AUDIO es un .wav o un dispositivo ALSA (si no, "default")
+    secuencias_fuenteAudio(getenv("LUCES_AUDIO"));
+    arranque_fin(fase);
+    fase = arranque_fase("hilo de salida");
+    if (motor_iniciar() != 0) {
+        fprintf(stderr, "Error al iniciar el hilo de salida de LEDs\n");
+        return 1;
+    }
+    reactor_vigilar(EV_MOTOR, motor_fdAviso());
+    arranque_fin(fase);
+
+    // LUCES_INICIO (nombre o número de secuencia) la pone en marcha ya, antes
+    // de la contraseña: tras un corte de luz las luces vuelven solas. Sigue
+    // hasta que se elija otra en el menú.
+    const char *inicio = getenv("LUCES_INICIO");
+    if (inicio) {
+        id_arranque = secuenciaInicio(inicio);
+        if (id_arranque >= 0) {
+            int delay = estado_leer(ESTADO_DELAY_INICIAL);
+            motor_reproducir(id_arranque, delay > 0 ? delay : DELAY_ARRANQUE);
+            arranque_hito("primer frame");   // motor_reproducir() vuelve con el frame en los pines
+        } else {
+            fprintf(stderr, "Aviso: LUCES_INICIO=%s no es una secuencia\n", inicio);
+        }
     }
 
-    pcf8591Setup(BASE, ADDR);
-    
     // Iniciar sesión
+    fase = arranque_fase("contraseña");
     if (!autenticar()) {
+        motor_cerrar();
+        hal_cerrar();
         return 1;
     }
+    arranque_fin(fase);
 
-    // Leer velocidad inicial desde el ADC
-    int val_adc    = analogRead(BASE + 0);
-    int delay_inicial = map(val_adc, 0, 255, 50, 2000); // Función externa map desde map.s
+    fase = arranque_fase("esperar dispositivos");
+    switch (esperarDispositivos()) {
+    case ERROR_WIRINGPI:
+        fprintf(stderr, "Error al inicializar wiringPi\n");
+        return 1;
+    case ERROR_ADC:
+        fprintf(stderr, "Error al iniciar el muestreo del ADC\n");
+        return 1;
+    }
+    reactor_vigilar(EV_ADC, adc_fdCambio());
+    arranque_fin(fase);
+    // El que se confirmó con la opción 9 la última vez, si no el del potenciómetro
+    int delay_inicial = estado_leer(ESTADO_DELAY_INICIAL);
+    if (delay_inicial == 0)
+        delay_inicial = adc_delay(); // map() de map.s sobre la lectura filtrada
+
+    // Servidor de control para tableros y bancos de prueba (recién después de
+    // la contraseña). LUCES_CONTROL cambia la ruta del socket Unix y
+    // LUCES_CONTROL_TCP abre además un puerto TCP, solo en 127.0.0.1 salvo
+    // que LUCES_CONTROL_DIRECCION diga otra (el TCP no pide contraseña).
+    const char *ruta_control = getenv("LUCES_CONTROL");
+    const char *puerto_control = getenv("LUCES_CONTROL_TCP");
+    fase = arranque_fase("servidor de control");
+    if (control_iniciar(ruta_control ? ruta_control : CONTROL_SOCKET, puerto_control ? atoi(puerto_control) : 0,
+                        getenv("LUCES_CONTROL_DIRECCION")) != 0)
+        fprintf(stderr, "Aviso: no se pudo abrir el servidor de control\n");
+    arranque_fin(fase);
+
+    // LUCES_ARRANQUE: archivo ("-" = stderr) con lo que tardó cada fase hasta el menú
+    arranque_hito("menú");
+    const char *ruta_arranque = getenv("LUCES_ARRANQUE");
+    if (ruta_arranque && arranque_informe(ruta_arranque) != 0)
+        fprintf(stderr, "Aviso: no se pudo escribir %s\n", ruta_arranque);
+
+    // Lo que escribió autenticar() queda abajo del primer dibujo: se borra todo
+    pantalla_destino(PANTALLA_LOCAL);
+    pantalla_invalidar();
 
     // void loop()
     while (1) {
@@ -66,405 +222,252 @@ int main() {
             modo = modo_forzado;
             modo_forzado = 0;
         } else {
-            // Menú normal de selección de modo
+            // Menú normal de selección de modo (siempre en la terminal local)
+            pantalla_destino(PANTALLA_LOCAL);
+            modoRemoto = 0;
+
             do {
-                system("clear");
-                printf("Seleccione modo de trabajo:\n");
-                printf("1. LOCAL  (teclado de la Raspberry)\n");
-                printf("2. REMOTO (PC via Arduino + UART TTL)\n\n");
-                printf("Opcion: ");
+                pantalla_limpiar();
+                pantalla_linea(0, "Seleccione modo de trabajo:");
+                pantalla_linea(1, "1. LOCAL  (teclado de la Raspberry)");
+                pantalla_linea(2, "2. REMOTO (PC via Arduino + UART TTL)");
+                pantalla_linea(4, "Opcion: ");
+                pantalla_cursor(4, -1);
+                pantalla_dibujar();
 
                 char buf_modo[16];
-                if (!fgets(buf_modo, sizeof(buf_modo), stdin)) {
-                    clearerr(stdin);
+                leerLinea(buf_modo, sizeof(buf_modo));
+                if (sscanf(buf_modo, "%d", &modo) != 1)
                     modo = 0;
-                } else {
-                    if (sscanf(buf_modo, "%d", &modo) != 1)
-                        modo = 0;
-                }
 
             } while (modo != 1 && modo != 2);
         }
 
         // Configurar según modo elegido / forzado
-        if (modo == 2) {
-            // ------ MODO REMOTO ------
-            modoRemoto = 1;
-
-            // Inicializar UART
-            if (serial_fd < 0) {
-                int fd = serialOpen(UART, BAUDRATE);
-                if (fd < 0) {
-                    fprintf(stderr, "Error al abrir /dev/ttyAMA0 en modo remoto\n");
-                    modoRemoto = 0;
-                } else {
-                    serial_fd = fd;
-                }
-            }
+        abrirUart();
+        modoRemoto = (modo == 2 && serial_fd >= 0);
+
+        // El aviso sale en la terminal local y, si hay UART, también en el PC
+        pantalla_limpiar();
+        if (modo == 2 && serial_fd < 0)
+            pantalla_linea(0, "Error al abrir %s en modo remoto", UART);
+        pantalla_linea(1, modoRemoto ? "Ejecutando modo remoto..." : "Ejecutando modo local...");
+
+        pantalla_destino(PANTALLA_LOCAL);
+        pantalla_dibujar();
+        if (serial_fd >= 0) {
+            pantalla_destino(PANTALLA_REMOTA);
+            pantalla_dibujar();
+        }
+        pantalla_destino(modoRemoto ? PANTALLA_REMOTA : PANTALLA_LOCAL);
 
-            system("clear");
-            printf("Ejecutando modo remoto...\n");
+        // ------------- MENÚ PRINCIPAL (el mismo para local y remoto) -------------
+        int volver_a_modos = 0;
+        int invalida = 0;
 
-            if (serial_fd >= 0) {
-                serialPuts(serial_fd, "\033[2J\033[H");
-                serialPuts(serial_fd, "Ejecutando modo remoto...\r\n");
-            }
+        while (!volver_a_modos) {
+            mostrarMenuPrincipal(delay_inicial, invalida);
 
-        } else {
-            // ------ MODO LOCAL ------
-            modoRemoto = 0;
+            char buffer[32];
+            leerLinea(buffer, sizeof(buffer));
+            if (sscanf(buffer, "%d", &opcion) != 1)
+                opcion = 0;
+            invalida = 0;
+
+            switch (opcion) {
+            case 1: case 2: case 3: case 4:
+            case 5: case 6: case 7: case 8:
+                // Mismo orden que SEC_AUTO..SEC_ESCALERA
+                ejecutarSecuencia(opcion - 1, delay_inicial);
+                break;
+
+            case 9:
+                delay_inicial = ajustar_velocidad_inicial(delay_inicial);
+                estado_guardar(ESTADO_DELAY_INICIAL, delay_inicial);
+                estado_sincronizar();
+                break;
+
+            case 10: {
+                char aux[96];
+                resetVelocidades();
+                estado_sincronizar();
+                snprintf(aux, sizeof(aux), "Ahora comenzarán nuevamente con un retardo inicial de (%d ms).", delay_inicial);
+                mostrarMensaje("Velocidades de las secuencias reseteadas.", aux);
+                break;
+            }
 
-            if (serial_fd < 0) {
-                int fd = serialOpen(UART, BAUDRATE);
-                if (fd >= 0) {
-                    serial_fd = fd;
+            case 11:
+                pantalla_limpiar();
+                pantalla_linea(0, "Saliendo del programa...");
+                pantalla_cursor(1, 0);
+                pantalla_dibujar();
+                if (modoRemoto) {
+                    // La terminal local también se entera
+                    pantalla_destino(PANTALLA_LOCAL);
+                    pantalla_dibujar();
                 }
-            }
+                control_cerrar();
+                adc_cerrar();
+                motor_cerrar();
+                estado_cerrar();
+                hal_cerrar();
+                grab_cerrar();
+                uart_drenar(500);
+                tele_cerrar();
+                return 0;
+
+            case 12:
+                // Cambiar directamente al otro modo
+                modo_forzado = modoRemoto ? 1 : 2;
+                volver_a_modos = 1;
+                break;
 
-            system("clear");
-            printf("Ejecutando modo local...\n");
+            case 13:
+                otrasSecuencias(delay_inicial);
+                break;
 
-            if (serial_fd >= 0) {
-                serialPuts(serial_fd, "\033[2J\033[H");
-                serialPuts(serial_fd, "Ejecutando modo local...\r\n");
+            case 14:
+                ejecutarSecuencia(secuencias_idAudio(), delay_inicial);
+                break;
+
+            default:
+                invalida = 1;
+                break;
             }
         }
+    }
+    return 0;
+}
 
-        // ------------------------ MODO LOCAL ------------------------
-        if (!modoRemoto) {
-            int volver_a_modos = 0;
-
-            while (!volver_a_modos) {
-
-                do {
-                    system("clear");
-                    printf("Menu principal del proyecto final (secuencias de luces) [LOCAL]\n");
-                    printf("1. El auto fantástico\n");
-                    printf("2. El choque\n");
-                    printf("3. La apilada\n");
-                    printf("4. La carrera\n");
-                    printf("5. Contador binario completo\n");
-                    printf("6. Danza de luces\n");
-                    printf("7. First On - First Off\n");
-                    printf("8. Escalera central\n");
-                    printf("9. Ajustar velocidad inicial de las secuencias\n");
-                    printf("10. Resetear velocidades de las secuencias\n");
-                    printf("11. Salir\n");
-                    printf("12. Cambiar al modo remoto\n\n");
-                    printf("Delay inicial = %d ms - Velocidad inicial = %.2f Hz\n", delay_inicial, 1000.0 / (double)(delay_inicial));
-                    printf("Seleccione una opcion: ");
-
-                    char buffer[32];
-                    if (!fgets(buffer, sizeof(buffer), stdin)) {
-                        clearerr(stdin);
-                        opcion = 0;
-                    } else {
-                        if (sscanf(buffer, "%d", &opcion) != 1)
-                            opcion = 0;
-                    }
-
-                } while(opcion <= 0 || opcion > 12);
-                
-                switch(opcion){
-                case 1:
-                    system("clear");
-                    printf("Ejecutando secuencia 'El auto fantástico'\n");   
-                    printf("Presione 'q' para salir, flechas ↑/↓ para velocidad.\n"); 
-                    runAutoFantastico(delay_inicial);
-                    break;
-
-                case 2: 
-                    system("clear");
-                    printf("Ejecutando secuencia 'El choque'\n");   
-                    printf("Presione 'q' para salir, flechas ↑/↓ para velocidad.\n"); 
-                    runChoque(delay_inicial);
-                    break;
-
-                case 3:
-                    system("clear");
-                    printf("Ejecutando secuencia 'La apilada'\n");   
-                    printf("Presione 'q' para salir, flechas ↑/↓ para velocidad.\n"); 
-                    runApilada(delay_inicial);
-                    break;     
-
-                case 4:
-                    system("clear");
-                    printf("Ejecutando secuencia 'La carrera'\n");   
-                    printf("Presione 'q' para salir, flechas ↑/↓ para velocidad.\n"); 
-                    runCarrera(delay_inicial);
-                    break;
-
-                case 5:
-                    system("clear");
-                    printf("Ejecutando secuencia 'Contador binario completo'\n");
-                    printf("Presione 'q' para salir, flechas ↑/↓ para velocidad.\n");
-                    runBinarioCompleto(delay_inicial);
-                    break;
-
-                case 6:
-                    system("clear");
-                    printf("Ejecutando secuencia 'Danza de luces'\n");
-                    printf("Presione 'q' para salir, flechas ↑/↓ para velocidad.\n");
-                    runDanza(delay_inicial);
-                    break;
-
-                case 7:
-                    system("clear");
-                    printf("Ejecutando secuencia 'First On - First Off'\n");
-                    printf("Presione 'q' para salir, flechas ↑/↓ para velocidad.\n");
-                    runFirstOnFirstOff(delay_inicial);
-                    break;
-
-                case 8:
-                    system("clear");
-                    printf("Ejecutando secuencia 'Escalera central'\n");
-                    printf("Presione 'q' para salir, flechas ↑/↓ para velocidad.\n");
-                    runEscaleraCentral(delay_inicial);
-                    break;
-
-                case 9:
-                    delay_inicial = ajustar_velocidad_inicial(delay_inicial);
-                    break;
-
-                case 10:
-                    resetVelocidades();
-                    system("clear");
-                    printf("Velocidades de las secuencias reseteadas.\n");
-                    printf("Ahora comenzarán nuevamente con un retardo inicial de (%d ms).\n", delay_inicial);
-                    printf("Presione ENTER para volver al menu...\n");
-                    getchar();
-                    break;
-
-                case 11:
-                    system("clear");
-                    printf("Saliendo del programa...\n");
-                    return 0;
-
-                case 12:
-                    // Cambiar directamente al modo REMOTO
-                    modo_forzado = 2;
-                    volver_a_modos = 1;
-                    break;
-
-                default:
-                    break;
-                }
-            }
-        } 
-
-        // ------------------------ MODO REMOTO ------------------------
-        else {
-            int volver_a_modos = 0;
-
-            while (!volver_a_modos) {
-
-                if (serial_fd >= 0) {
-                    serialPuts(serial_fd, "\033[2J\033[H");
-
-                    // Enviar menú por UART al PC
-                    serialPuts(serial_fd, "Menu principal del proyecto final (secuencias de luces) [REMOTO]\r\n");
-                    serialPuts(serial_fd, "1. El auto fantastico\r\n");
-                    serialPuts(serial_fd, "2. El choque\r\n");
-                    serialPuts(serial_fd, "3. La apilada\r\n");
-                    serialPuts(serial_fd, "4. La carrera\r\n");
-                    serialPuts(serial_fd, "5. Contador binario completo\r\n");
-                    serialPuts(serial_fd, "6. Danza de luces\r\n");
-                    serialPuts(serial_fd, "7. First On - First Off\r\n");
-                    serialPuts(serial_fd, "8. Escalera central\r\n");
-                    serialPuts(serial_fd, "9. Ajustar velocidad inicial de las secuencias\r\n");
-                    serialPuts(serial_fd, "10. Resetear velocidades de las secuencias\r\n");
-                    serialPuts(serial_fd, "11. Salir\r\n");
-                    serialPuts(serial_fd, "12. Cambiar al modo local\r\n\r\n");
-
-                    char linea[80];
-                    snprintf(linea, sizeof(linea),
-                             "Velocidad inicial = %d ms\r\n", delay_inicial);
-                    serialPuts(serial_fd, linea);
-
-                    serialPuts(serial_fd, "Seleccione una opcion: ");
-                }
+// -------------------- Pantallas del menú --------------------
+void mostrarMenuPrincipal(int delay_inicial, int invalida) {
+    pantalla_limpiar();
+    pantalla_linea(0, "Menu principal del proyecto final (secuencias de luces) [%s]", modoRemoto ? "REMOTO" : "LOCAL");
+    pantalla_linea(1, "1. El auto fantástico");
+    pantalla_linea(2, "2. El choque");
+    pantalla_linea(3, "3. La apilada");
+    pantalla_linea(4, "4. La carrera");
+    pantalla_linea(5, "5. Contador binario completo");
+    pantalla_linea(6, "6. Danza de luces");
+    pantalla_linea(7, "7. First On - First Off");
+    pantalla_linea(8, "8. Escalera central");
+    pantalla_linea(9, "9. Ajustar velocidad inicial de las secuencias");
+    pantalla_linea(10, "10. Resetear velocidades de las secuencias");
+    pantalla_linea(11, "11. Salir");
+    pantalla_linea(12, "12. Cambiar al modo %s", modoRemoto ? "local" : "remoto");
+    pantalla_linea(13, "13. Otras secuencias (biblioteca)");
+    pantalla_linea(14, "14. Luces al ritmo de la música");
+    pantalla_linea(15, "Delay inicial = %d ms - Velocidad inicial = %.2f Hz", delay_inicial, 1000.0 / (double)(delay_inicial));
+    pantalla_linea(16, "Seleccione una opcion: ");
+    if (id_arranque >= 0 && motor_activo() == id_arranque)
+        pantalla_linea(17, "En marcha desde el arranque: %s", secuencias_nombre(id_arranque));
+    if (invalida)
+        pantalla_linea(18, "Opcion invalida.");
+    pantalla_cursor(16, -1);
+    pantalla_dibujar();
+}
 
-                // Leer una línea desde el PC
-                char buf[16];
-                int idx = 0;
-                opcion = 0;
+// Dos líneas de aviso y espera ENTER
+void mostrarMensaje(const char *linea1, const char *linea2) {
+    char buf[16];
+
+    pantalla_limpiar();
+    pantalla_linea(0, "%s", linea1);
+    if (linea2)
+        pantalla_linea(1, "%s", linea2);
+    pantalla_linea(2, "Presione ENTER para volver al menu...");
+    pantalla_cursor(3, 0);
+    pantalla_dibujar();
+    leerLinea(buf, sizeof(buf));
+}
 
-                memset(buf, 0, sizeof(buf));
-
-                while (1) {
-                    if (serial_fd >= 0 && serialDataAvail(serial_fd)) {
-                        unsigned char c = (unsigned char)serialGetchar(serial_fd);
-            
-                        if (c == 127 || c == 8) {
-                            if (idx > 0) {
-                                idx--;
-                                buf[idx] = '\0';
-                                serialPuts(serial_fd, "\b \b");
-                            }
-                            continue;
-                        }
-
-                        if (c == '\r' || c == '\n') {
-                            buf[idx] = '\0';
-                            serialPuts(serial_fd, "\r\n");
-                            break;
-                        }
-
-                        // Guardar caracteres normales
-                        if (idx < (int)sizeof(buf) - 1) {
-                            buf[idx++] = c;
-                            serialPutchar(serial_fd, c);  // Eco del carácter
-                        }
-                    }
-                    delay(10);
-                }
+void ejecutarSecuencia(int id, int delay_inicial) {
+    pantalla_limpiar();
+    pantalla_linea(0, "Ejecutando secuencia '%s'", secuencias_nombre(id));
+    pantalla_linea(1, "Presione 'q' para salir, ↑/↓ velocidad, ←/→ brillo, 'e' estela, 'p' pausa.");
+    pantalla_dibujar();
+    if (runPrograma(id, delay_inicial) == 0)
+        id_arranque = -1;   // la reemplazó y al salir quedó detenida
+    else if (id == secuencias_idAudio())
+        mostrarMensaje("No se pudo abrir la entrada de audio.",
+                       "Definir LUCES_AUDIO con un .wav o un dispositivo ALSA.");
+}
 
-                if (sscanf(buf, "%d", &opcion) != 1) {
-                    opcion = 0;
-                }
+// Abre el UART la primera vez que hace falta (en local también, para que el
+// PC pueda ver los avisos). En modo remoto el mismo enlace acepta, mezcladas
+// con el texto, las tramas binarias de protocolo.h.
+void abrirUart(void) {
+    if (serial_fd >= 0)
+        return;
+
+    int fd = serialOpen(UART, BAUDRATE);
+    if (fd < 0)
+        return;
+
+    serial_fd = fd;
+    uart_iniciar(serial_fd);
+    entrada_iniciar(&entradaSerial, serial_fd);
+    entradaSerial.filtro = proto_byte;   // tramas binarias del controlador (protocolo.h)
+    entradaSerial.bytes = &tele->interfaz.bytesEntrada;
+    reactor_vigilar(EV_SERIAL, serial_fd);
+}
 
-                switch (opcion) {
-                case 1:
-                    serialPuts(serial_fd, "\033[2J\033[H");
-                    serialPuts(serial_fd, "Ejecutando secuencia 'El auto fantastico'\r\n");
-                    serialPuts(serial_fd, "Presione 'q' para salir, flechas ↑/↓ para velocidad.\r\n");
-                    runAutoFantastico(delay_inicial);
-                    break;
-
-                case 2:
-                    serialPuts(serial_fd, "\033[2J\033[H");
-                    serialPuts(serial_fd, "Ejecutando secuencia 'El choque'\r\n");
-                    serialPuts(serial_fd, "Presione 'q' para salir, flechas ↑/↓ para velocidad.\r\n");
-                    runChoque(delay_inicial);
-                    break;
-
-                case 3:
-                    serialPuts(serial_fd, "\033[2J\033[H");
-                    serialPuts(serial_fd, "Ejecutando secuencia 'La apilada'\r\n");
-                    serialPuts(serial_fd, "Presione 'q' para salir, flechas ↑/↓ para velocidad.\r\n");
-                    runApilada(delay_inicial);
-                    break;
-
-                case 4:
-                    serialPuts(serial_fd, "\033[2J\033[H");
-                    serialPuts(serial_fd, "Ejecutando secuencia 'La carrera'\r\n");
-                    serialPuts(serial_fd, "Presione 'q' para salir, flechas ↑/↓ para velocidad.\r\n");
-                    runCarrera(delay_inicial);
-                    break;
-
-                case 5:
-                    serialPuts(serial_fd, "\033[2J\033[H");
-                    serialPuts(serial_fd, "Ejecutando secuencia 'Contador binario completo'\r\n");
-                    serialPuts(serial_fd, "Presione 'q' para salir, flechas ↑/↓ para velocidad.\r\n");
-                    runBinarioCompleto(delay_inicial);
-                    break;
-
-                case 6:
-                    serialPuts(serial_fd, "\033[2J\033[H");
-                    serialPuts(serial_fd, "Ejecutando secuencia 'Danza de luces'\r\n");
-                    serialPuts(serial_fd, "Presione 'q' para salir, flechas ↑/↓ para velocidad.\r\n");
-                    runDanza(delay_inicial);
-                    break;
-
-                case 7:
-                    serialPuts(serial_fd, "\033[2J\033[H");
-                    serialPuts(serial_fd, "Ejecutando secuencia 'First On - First Off'\r\n");
-                    serialPuts(serial_fd, "Presione 'q' para salir, flechas ↑/↓ para velocidad.\r\n");
-                    runFirstOnFirstOff(delay_inicial);
-                    break;
-
-                case 8:
-                    serialPuts(serial_fd, "\033[2J\033[H");
-                    serialPuts(serial_fd, "Ejecutando secuencia 'Escalera central'\r\n");
-                    serialPuts(serial_fd, "Presione 'q' para salir, flechas ↑/↓ para velocidad.\r\n");
-                    runEscaleraCentral(delay_inicial);
-                    break;
-
-                case 9: {
-                    int nuevo_delay = delay_inicial;
-
-                    serialPuts(serial_fd, "\033[2J\033[H");
-                    serialPuts(serial_fd, "AJUSTE DE VELOCIDAD INICIAL (REMOTO)\r\n");
-                    serialPuts(serial_fd, "-----------------------------------\r\n");
-                    serialPuts(serial_fd, "Gire el potenciometro para cambiar la velocidad.\r\n");
-                    serialPuts(serial_fd, "Presione ENTER para confirmar y volver al menu.\r\n\r\n");
-                    serialPuts(serial_fd, "Lectura ADC actual y velocidad:\r\n");
-
-                    while (1) {
-                        int val_adc_r = analogRead(BASE + 0);
-                        nuevo_delay = map(val_adc_r, 0, 255, 50, 2000);
-
-                        char msg[200];
-                        snprintf(msg, sizeof(msg), "ADC: %4d   Velocidad inicial medida: %4d ms   \r", val_adc_r, nuevo_delay);
-                        serialPuts(serial_fd, msg);
-
-                        // Ventana de tiempo corta para ver ENTER sin frenar todo
-                        int confirmado = 0;
-                        unsigned long t0 = millis();
-                        while (millis() - t0 < 150) { // ~150 ms
-                            if (serialDataAvail(serial_fd)) {
-                                char c = (char)serialGetchar(serial_fd);
-                                if (c == '\r' || c == '\n') {
-                                    confirmado = 1;
-                                    break;
-                                }
-                            }
-                            delay(5);
-                        }
-                        if (confirmado) {
-                            delay_inicial = nuevo_delay;
-                            serialPuts(serial_fd, "\r\n");
-                            break;
-                        }
-                    }
-                    break;
-                }
+// -------------------- Arranque --------------------
+// wiringPi y el PCF8591 (o el bus de LUCES_I2C), con la primera lectura del
+// ADC, en paralelo con la salida de LEDs y la contraseña
+void *iniciarDispositivos(void *arg) {
+    (void)arg;
 
-                case 10:
-                    resetVelocidades();
-                    serialPuts(serial_fd, "\033[2J\033[H");
-                    {
-                        char aux[160];
-                        snprintf(aux, sizeof(aux),
-                            "Velocidades de las secuencias reseteadas.\r\n"
-                            "Ahora comenzaran nuevamente con un retardo inicial de (%d ms).\r\n"
-                            "Presione ENTER para volver al menu...\r\n",
-                            delay_inicial);
-                        serialPuts(serial_fd, aux);
-                    }
-                    while (1) {
-                        if (serialDataAvail(serial_fd)) {
-                            char c = (char)serialGetchar(serial_fd);
-                            if (c == '\r' || c == '\n') break;
-                        }
-                        delay(10);
-                    }
-                    break;
-
-                case 11:
-                    serialPuts(serial_fd, "\033[2J\033[H");
-                    serialPuts(serial_fd, "Saliendo del programa (modo remoto)...\r\n");
-                    system("clear");
-                    printf("Saliendo del programa...\n");
-                    return 0;
-
-                case 12:
-                    // Cambiar al modo LOCAL
-                    serialPuts(serial_fd, "\033[2J\033[H");
-                    serialPuts(serial_fd, "Cambiando al modo local...\r\n");
-                    modo_forzado = 1;
-                    volver_a_modos = 1;
-                    break;
-
-                default:
-                    serialPuts(serial_fd, "\r\nOpcion invalida.\r\n");
-                    break;
-                }
-            }
+    int fase = arranque_fase("wiringPi");
+    if (wiringPiSetupGpio() == -1) {
+        dispositivos_error = ERROR_WIRINGPI;
+        return NULL;
+    }
+    arranque_fin(fase);
+
+    // Muestreo del potenciómetro en segundo plano y velocidad inicial desde el ADC.
+    // LUCES_I2C (p.ej. /dev/i2c-1) lee el PCF8591 en ráfagas directo por i2c-dev.
+    fase = arranque_fase("ADC");
+    const char *ruta_i2c = getenv("LUCES_I2C");
+    busI2c_t bus_i2c;
+    int error;
+    if (ruta_i2c && i2c_abrir(&bus_i2c, ruta_i2c, ADDR) == 0) {
+        error = adc_iniciarRafaga(&bus_i2c, ADC_HZ, ADC_JUEGOS, 50, 2000);
+        if (error != 0)
+            i2c_cerrar(&bus_i2c);   // si arrancó, lo cierra adc_cerrar()
+    } else {
+        if (ruta_i2c)
+            fprintf(stderr, "Aviso: no se pudo abrir LUCES_I2C=%s, el ADC se lee por wiringPi\n", ruta_i2c);
+        pcf8591Setup(BASE, ADDR);
+        error = adc_iniciar(BASE + 0, ADC_HZ, 50, 2000);
+    }
+    if (error != 0)
+        dispositivos_error = ERROR_ADC;
+    arranque_fin(fase);
+    return NULL;
+}
 
-        }
+// Espera a que termine iniciarDispositivos() (una sola vez) y devuelve su error
+int esperarDispositivos(void) {
+    if (dispositivos_hilo) {
+        pthread_join(*dispositivos_hilo, NULL);
+        dispositivos_hilo = NULL;
     }
-    return 0;
+    return dispositivos_error;
+}
+
+// Nombre (sin importar mayúsculas) o número en el orden del menú y de "Otras
+// secuencias"; -1 si no hay ninguna así. El de audio no: necesita la captura.
+int secuenciaInicio(const char *nombre) {
+    char *fin;
+    long n = strtol(nombre, &fin, 10);
+    if (*nombre && *fin == '\0')
+        return n >= 1 && n <= secuencias_cantidad() && n - 1 != secuencias_idAudio() ? (int)n - 1 : -1;
+
+    for (int id = 0; id < secuencias_cantidad(); id++)
+        if (id != secuencias_idAudio() && strcasecmp(nombre, secuencias_nombre(id)) == 0)
+            return id;
+    return -1;
 }
 
 // -------------------- Función para autenticar al usuario --------------------
@@ -520,45 +523,160 @@ int autenticar() {
     return 0;
 }
 
-// Ajuste de velocidad inicial
+// Ajuste de velocidad inicial (local o remoto): se redibuja cuando el hilo
+// del ADC avisa que el potenciómetro se movió, no cada 100 ms
 int ajustar_velocidad_inicial(int delay_actual) {
     struct termios orig_t;
-    int orig_flags;
+    int orig_flags = -1;
+    entrada_t *e = modoRemoto ? &entradaSerial : &entradaTeclado;
 
     // Modo no canónico no bloqueante para leer ENTER
-    if (setup_nocanonico_nobloq(&orig_t, &orig_flags) != 0) {
-        printf("Error configurando terminal para ajuste de velocidad.\n");
+    if (!modoRemoto && setup_nocanonico_nobloq(&orig_t, &orig_flags) != 0) {
+        mostrarMensaje("Error configurando terminal para ajuste de velocidad.", NULL);
         return delay_actual;
     }
 
+    pantalla_limpiar();
+    pantalla_linea(0, "AJUSTE DE VELOCIDAD INICIAL%s", modoRemoto ? " (REMOTO)" : "");
+    pantalla_linea(1, "----------------------------");
+    pantalla_linea(2, "Gire el potenciómetro para cambiar la velocidad.");
+    pantalla_linea(3, "Presione ENTER para confirmar y volver al menú.");
+    pantalla_dibujar();
+
     int nuevo_delay = delay_actual;
+    reactor_fuentes((modoRemoto ? EV_SERIAL : EV_TECLADO) | EV_ADC);
 
     while (1) {
-        int val_adc = analogRead(BASE + 0);
-        nuevo_delay = map(val_adc, 0, 255, 50, 2000);
-
-        system("clear");
-        printf("AJUSTE DE VELOCIDAD INICIAL\n");
-        printf("----------------------------\n");
-        printf("Gire el potenciómetro para cambiar la velocidad.\n");
-        printf("Presione ENTER para confirmar y volver al menú.\n\n");
-        printf("Lectura ADC actual : %d\n", val_adc);
-        printf("Delay inicial medido: %d ms\n", nuevo_delay);
-        printf("Velocidad inicial medida: %.2f Hz\n", 1000.0 / (double)(nuevo_delay));
+        nuevo_delay = adc_delay();
+        pantalla_estado(5, "Lectura ADC actual : %d", adc_filtrado());
+        pantalla_estado(6, "Delay inicial medido: %d ms", nuevo_delay);
+        pantalla_estado(7, "Velocidad inicial medida: %.2f Hz", 1000.0 / (double)(nuevo_delay));
 
         // Ver si se presionó ENTER
-        char c;
-        ssize_t n = read(STDIN_FILENO, &c, 1);
-        if (n == 1 && (c == '\n' || c == '\r')) {
+        if (hayEnter(e)) {
             break; // Confirmar velocidad y salir
         }
 
-        // Pequeño delay de refresco (100 ms)
-        usleep(100000);
+        // Duerme hasta una tecla, un cambio del ADC o el próximo redibujo permitido
+        int ev = reactor_esperar(pantalla_refrescar());
+        if (ev & EV_ADC)
+            adc_consumirCambio();
     }
+    pantalla_dibujar();   // que quede a la vista el valor confirmado
 
     // Restaurar terminal
-    restaurarTerminal(&orig_t, orig_flags);
+    if (!modoRemoto)
+        restaurarTerminal(&orig_t, orig_flags);
 
     return nuevo_delay;
 }
+
+// Lee una línea del lado que corresponda al modo actual
+void leerLinea(char *buf, int tam) {
+    if (modoRemoto) {
+        leerLineaRemota(buf, tam);
+        return;
+    }
+
+    // La línea se espera en el reactor (que mientras tanto atiende a los
+    // clientes de control y vacía el UART); fgets ya no bloquea
+    reactor_fuentes(EV_TECLADO);
+    while (!(reactor_esperar(-1) & EV_TECLADO))
+        ;
+    if (!fgets(buf, tam, stdin)) {
+        clearerr(stdin);
+        buf[0] = '\0';
+    }
+}
+
+// Lee una línea desde el PC (con eco y backspace) durmiendo en el reactor.
+// Lo que llegue después del ENTER queda en entradaSerial para la próxima lectura.
+void leerLineaRemota(char *buf, int tam) {
+    int idx = 0;
+    tecla_t t;
+    memset(buf, 0, tam);
+
+    // Acá solo interesa lo que llega por el UART
+    reactor_fuentes(EV_SERIAL);
+
+    while (1) {
+        // Dormir hasta que llegue algo por el UART
+        if (entrada_siguiente(&entradaSerial, &t) <= 0) {
+            reactor_esperar(-1);
+            continue;
+        }
+
+        if (t.tipo == TEC_BORRAR) {
+            if (idx > 0) {
+                idx--;
+                buf[idx] = '\0';
+                uart_puts("\b \b");
+            }
+            continue;
+        }
+
+        if (t.tipo == TEC_ENTER) {
+            buf[idx] = '\0';
+            uart_puts("\r\n");
+            break;
+        }
+
+        // Guardar caracteres normales (las flechas no cuentan)
+        if (t.tipo == TEC_CARACTER && idx < tam - 1) {
+            buf[idx++] = t.c;
+            uart_putchar(t.c);  // Eco del carácter
+        }
+    }
+}
+
+// Consume lo que haya llegado y devuelve 1 si entre eso hubo un ENTER
+int hayEnter(entrada_t *e) {
+    tecla_t t;
+
+    while (entrada_siguiente(e, &t) > 0) {
+        if (t.tipo == TEC_ENTER)
+            return 1;
+    }
+    return 0;
+}
+
+// Id de la extra número 'i' (desde 0), salteando la de audio: esa tiene su
+// opción propia, que arranca la captura
+static int idExtra(int i) {
+    int id = SEC_CANTIDAD + i;
+    int audio = secuencias_idAudio();
+    return audio >= SEC_CANTIDAD && id >= audio ? id + 1 : id;
+}
+
+// Secuencias extra de la biblioteca (después de las 8 del menú principal)
+void otrasSecuencias(int delay_inicial) {
+    int extras = secuencias_cantidad() - SEC_CANTIDAD;
+    extras -= secuencias_idAudio() >= SEC_CANTIDAD;
+    int opcion;
+    char buffer[32];
+
+    if (extras <= 0) {
+        mostrarMensaje("No hay secuencias adicionales en la biblioteca.", NULL);
+        return;
+    }
+
+    // Las que no entran en pantalla igual se pueden elegir por número
+    int visibles = extras < PANTALLA_FILAS - 4 ? extras : PANTALLA_FILAS - 5;
+
+    pantalla_limpiar();
+    pantalla_linea(0, "Otras secuencias de la biblioteca");
+    for (int i = 0; i < visibles; i++)
+        pantalla_linea(1 + i, "%d. %s", i + 1, secuencias_nombre(idExtra(i)));
+    if (visibles < extras)
+        pantalla_linea(1 + visibles, "... (%d más)", extras - visibles);
+    int filaPregunta = 2 + (visibles < extras ? visibles + 1 : visibles);
+    pantalla_linea(filaPregunta, "Seleccione una secuencia (0 para volver): ");
+    pantalla_cursor(filaPregunta, -1);
+    pantalla_dibujar();
+
+    leerLinea(buffer, sizeof(buffer));
+    if (sscanf(buffer, "%d", &opcion) != 1 || opcion <= 0 || opcion > extras)
+        return;
+
+    ejecutarSecuencia(idExtra(opcion - 1), delay_inicial);
+}
@@ -0,0 +1,6 @@
+// map.c
+// Versión en C de map.s para compilar fuera de ARM (misma cuenta: división
+// entera truncada, como sdiv).
+int map(int x, int in_min, int in_max, int out_min, int out_max) {
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
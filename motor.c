@@ -0,0 +1,894 @@
+// motor.c
+// Hilo de salida de LEDs: reproduce los programas registrados contra deadlines
+// absolutos y es el único que escribe en el HAL. La interfaz le habla por una
+// cola SPSC sin locks y lee su estado con atómicos y un buffer triple, así una
+// escritura lenta al UART o a la terminal no estira los frames.
+#include "motor.h"
+#include "cola_spsc.h"
+#include "gpio_hal.h"
+#include "bam.h"
+#include "compositor.h"
+#include "estado.h"
+#include "grabador.h"
+#include "telemetria.h"
+
+#include <string.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+#define PRIORIDAD_FIFO 80
+#define GAMMA          2.2
+
+enum {
+    CMD_REPRODUCIR,
+    CMD_VELOCIDAD,
+    CMD_DETENER,
+    CMD_PAUSAR,
+    CMD_REANUDAR,
+    CMD_MEZCLA,
+    CMD_RESET_VELOCIDADES,
+    CMD_INTENSIDAD,
+    CMD_SALIR
+};
+
+static const programa_t *programas[MOTOR_MAX_PROGRAMAS];
+static _Atomic int cantProgramas = 0;
+
+// Velocidad guardada por programa (0 = usar delay inicial). Solo la escribe el
+// hilo de salida; al archivo de estado (estado.h) la lleva la interfaz con
+// motor_guardarEstado(): un store del hilo de tiempo real en la página
+// mapeada justo después de un msync() puede quedar esperando al disco.
+static _Atomic int velocidades[MOTOR_MAX_PROGRAMAS];
+static _Atomic int activos[MOTOR_PISTAS];      // programa de cada pista (-1 = libre)
+static _Atomic int pausadas[MOTOR_PISTAS];
+static _Atomic long framesPista[MOTOR_PISTAS]; // copia de reloj.frames para otros hilos
+static _Atomic unsigned int confirmados = 0;   // comandos ya aplicados
+static _Atomic int refrescoPedido = 0;         // motor_refrescar() de otro hilo
+static _Atomic int confirmacionPedida = 0;     // marcar confirmaFd al aplicar
+static unsigned int pedidos = 0;               // comandos encolados (solo la interfaz)
+static int esperar = 1;                        // motor_esperarConfirmacion()
+static int guardarPendiente = 0;               // velocidades cambiadas sin esperar
+static unsigned int marcaGuardar;              // ... hasta este comando
+
+static colaSpsc_t comandos;
+static bufferTriple_t frames;
+
+static pthread_t hilo;
+static int hiloCorriendo = 0;
+static int esTiempoReal  = 0;
+static int sinHilo       = 0;   // motor_iniciarVirtual(): todo corre en quien llama
+
+static int timbreFd = -1;   // interfaz -> hilo: hay comandos
+static int avisoFd  = -1;   // hilo -> interfaz: terminó un programa
+static int confirmaFd = -1; // hilo -> interfaz: aplicó comandos (motor_pedirConfirmacion)
+static int timerFd  = -1;
+
+// Intensidad: con brillo < máximo o con estela los pasos se muestran por BAM.
+// La interfaz guarda lo pedido en los atómicos; el hilo usa sus copias.
+static _Atomic int brilloPedido = MOTOR_BRILLO_MAX;
+static _Atomic int estelaPedida = 0;
+static _Atomic unsigned long ciclosBam = 0;
+
+static int brillo = MOTOR_BRILLO_MAX;
+static int estela = 0;                 // en medios delays, como 'medios'
+static int modoBam = 0;
+static uint16_t niveles[8];            // intensidad actual por posición (8.8)
+static struct timespec ultimoCiclo;
+
+// -------------------- Lado hilo de salida --------------------
+// Cada pista es una máquina de estados (programa, paso, vencimiento) que el
+// hilo avanza cuando vence su paso; ninguna tiene un bucle propio, así varias
+// conviven en un solo timer y cualquiera se puede pausar y retomar.
+typedef struct {
+    const programa_t *prog;   // NULL = pista libre
+    int id;
+    int paso;
+    int delay_ms;
+    uint8_t grupo;            // posiciones del frame que muestra (bit j = posición j)
+    uint8_t mezcla;           // cómo se aplica sobre las pistas anteriores (COMP_OR...)
+    int pausada;
+    long restanteUs;          // lo que le faltaba al paso al pausarla
+    uint8_t congelado;        // frame de un programa vivo al pausarla
+    relojFrames_t reloj;
+} pista_t;
+
+// Dónde quedó cada programa la última vez que dejó una pista
+typedef struct {
+    uint16_t paso;
+    uint16_t restanteMs;
+} posicion_t;
+
+static pista_t pistas[MOTOR_PISTAS];
+static posicion_t posiciones[MOTOR_MAX_PROGRAMAS];
+static uint32_t numeroFrame = 0;
+
+static void avisar(int fd) {
+    uint64_t uno = 1;
+    if (write(fd, &uno, sizeof(uno)) < 0) {
+        // el contador del eventfd no puede desbordar en la práctica
+    }
+}
+
+static long usDesde(const struct timespec *a, const struct timespec *b) {
+    return (b->tv_sec - a->tv_sec) * 1000000L + (b->tv_nsec - a->tv_nsec) / 1000L;
+}
+
+// Cada frame lógico pasa por acá una vez, también en BAM (que escribe
+// varios planos por frame): es lo que se graba
+static void publicar(uint8_t frame) {
+    grab_patron(frame);
+
+    frameInfo_t *f = bt_escritura(&frames);
+    f->frame     = frame;
+    f->secuencia = pistas[0].prog ? pistas[0].id : -1;
+    f->paso      = pistas[0].paso;
+    f->numero    = ++numeroFrame;
+    bt_publicar(&frames);
+}
+
+static void armarVencimiento(const struct timespec *t) {
+    if (sinHilo)
+        return;   // los vencimientos los recorre motor_simular()
+
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    if (t)
+        its.it_value = *t;
+    timerfd_settime(timerFd, t ? TFD_TIMER_ABSTIME : 0, &its, NULL);
+}
+
+static int hayPistas(void) {
+    for (int i = 0; i < MOTOR_PISTAS; i++)
+        if (pistas[i].prog)
+            return 1;
+    return 0;
+}
+
+// El vencimiento más cercano entre las pistas que corren (NULL si ninguna)
+static const struct timespec *proximoVencimiento(void) {
+    const struct timespec *t = NULL;
+
+    for (int i = 0; i < MOTOR_PISTAS; i++) {
+        const pista_t *p = &pistas[i];
+        if (!p->prog || p->pausada)
+            continue;
+        if (!t || usDesde(&p->reloj.proximo, t) > 0)
+            t = &p->reloj.proximo;
+    }
+    return t;
+}
+
+// Lo que muestra la pista ahora: el paso, o el frame vivo si el programa lo tiene
+static uint8_t framePista(const pista_t *p) {
+    if (!p->prog->vivo)
+        return p->prog->pasos[p->paso].frame;
+    return p->pausada ? p->congelado : atomic_load_explicit(p->prog->vivo, memory_order_relaxed);
+}
+
+// Frame de salida: las pistas son capas que se aplican en orden, cada una
+// con su mezcla y solo sobre las posiciones de su grupo. Se compone en 8
+// posiciones: cada capa es un patrón de 8 estirado, y estirar después de
+// mezclar da el mismo frame que mezclar los estirados. La intensidad es una
+// por posición y la saca cicloBam() con bam_planos8().
+static uint8_t componer(void) {
+    uint8_t frame = 0;
+
+    for (int i = 0; i < MOTOR_PISTAS; i++) {
+        const pista_t *p = &pistas[i];
+        if (!p->prog)
+            continue;
+        uint8_t capa = comp_aplicar8(p->mezcla, frame, framePista(p));
+        frame = (uint8_t)((frame & ~p->grupo) | (capa & p->grupo));
+    }
+    return frame;
+}
+
+// Escribe el frame compuesto y arma el timer para el próximo vencimiento
+static void actualizarSalida(void) {
+    uint8_t frame = componer();
+
+    // En BAM lo dibuja cicloBam() mientras quede alguna pista
+    if (!modoBam || !hayPistas()) {
+        uint64_t t0 = tele_ahoraNs();
+        hal_escribirFrame(frame);
+        tele_registrar(&tele->salida.escritura, (long)((tele_ahoraNs() - t0) / 1000));
+        tele_sumar(&tele->salida.escrituras, 1);
+    }
+    if (!modoBam)
+        armarVencimiento(proximoVencimiento());
+    publicar(frame);
+}
+
+// Programa el vencimiento del paso actual; 'restanteMs' > 0 retoma un paso a medias
+static void iniciarPaso(pista_t *p, int restanteMs) {
+    const paso_t *paso = &p->prog->pasos[p->paso];
+    int dur = paso->fijoMs ? paso->fijoMs : paso->medios * p->delay_ms / 2;
+
+    if (dur < MOTOR_FRAME_MIN_MS)
+        dur = MOTOR_FRAME_MIN_MS;
+    if (restanteMs > 0 && restanteMs < dur)
+        dur = restanteMs;
+    reloj_programar(&p->reloj, dur);
+}
+
+static void guardarPosicion(const pista_t *p) {
+    struct timespec ahora;
+    long us = p->restanteUs;
+
+    if (!p->pausada) {
+        reloj_ahora(&ahora);
+        us = usDesde(&ahora, &p->reloj.proximo);
+    }
+    posiciones[p->id].paso = (uint16_t)p->paso;
+    posiciones[p->id].restanteMs = us > 0 ? (uint16_t)((us + 999) / 1000) : 0;
+}
+
+static void liberarPista(int i) {
+    pista_t *p = &pistas[i];
+
+    for (int j = 0; j < 8; j++)
+        if (p->grupo >> j & 1)
+            niveles[j] = 0;
+    p->prog = NULL;
+    p->pausada = 0;
+    atomic_store(&activos[i], -1);
+    atomic_store(&pausadas[i], 0);
+}
+
+// Pasa al paso siguiente de la pista cuando vence el actual
+static void avanzarPaso(int i) {
+    pista_t *p = &pistas[i];
+
+    p->paso++;
+    if (p->paso >= p->prog->cantPasos) {
+        if (p->prog->bucle) {
+            p->paso = 0;
+        } else {
+            // Terminó: la próxima vez arranca de nuevo
+            posiciones[p->id].paso = 0;
+            posiciones[p->id].restanteMs = 0;
+            liberarPista(i);
+            avisar(avisoFd);
+            return;
+        }
+    }
+    long atraso = reloj_marcarVencimiento(&p->reloj);
+    atomic_store_explicit(&framesPista[i], p->reloj.frames, memory_order_relaxed);
+    tele_registrar(&tele->salida.atraso, atraso);
+    tele_sumar(&tele->salida.frames, 1);
+    if (atraso > TELE_PERDIDO_US)
+        tele_sumar(&tele->salida.perdidos, 1);
+    iniciarPaso(p, 0);
+}
+
+// Avanza todas las pistas vencidas; devuelve 1 si alguna cambió
+static int vencerPistas(void) {
+    struct timespec ahora;
+    int cambio = 0;
+
+    reloj_ahora(&ahora);
+    for (int i = 0; i < MOTOR_PISTAS; i++) {
+        pista_t *p = &pistas[i];
+        if (p->prog && !p->pausada && usDesde(&p->reloj.proximo, &ahora) >= 0) {
+            avanzarPaso(i);
+            cambio = 1;
+        }
+    }
+    return cambio;
+}
+
+// -------------------- Intensidad por BAM --------------------
+static void cambiarIntensidad(int nuevoBrillo, int nuevaEstela) {
+    int antes = modoBam;
+
+    brillo  = nuevoBrillo;
+    estela  = nuevaEstela;
+    // Sin hilo no hay quien dibuje los ciclos: los frames salen enteros
+    modoBam = !sinHilo && (brillo < MOTOR_BRILLO_MAX || estela > 0);
+
+    if (!hayPistas() || antes == modoBam)
+        return;
+
+    if (modoBam) {
+        // Desde ahora los vencimientos los mira cicloBam()
+        armarVencimiento(NULL);
+        reloj_ahora(&ultimoCiclo);
+        memset(niveles, 0, sizeof(niveles));
+    } else {
+        actualizarSalida();
+    }
+}
+
+// Un ciclo BAM del frame compuesto. Las posiciones encendidas van al máximo y
+// las apagadas decaen con una constante de 'estela' medios delays de la pista
+// dueña de esa posición, así cada estela sigue la velocidad de su secuencia.
+static void cicloBam(void) {
+    struct timespec ahora;
+
+    if (vencerPistas())
+        publicar(componer());
+    if (!hayPistas())
+        return;
+
+    reloj_ahora(&ahora);
+    long dtUs = usDesde(&ultimoCiclo, &ahora);
+    ultimoCiclo = ahora;
+
+    uint8_t frame = componer();
+    uint8_t intens[8], mascaras[BAM_BITS];
+
+    for (int j = 0; j < 8; j++) {
+        long tauUs = 0;
+        for (int i = 0; i < MOTOR_PISTAS; i++) {
+            if (pistas[i].prog && (pistas[i].grupo >> j & 1)) {
+                tauUs = (long)estela * pistas[i].delay_ms * 500;
+                break;
+            }
+        }
+
+        if (frame >> j & 1)
+            niveles[j] = 0xFFFF;
+        else if (dtUs >= tauUs)
+            niveles[j] = 0;
+        else
+            niveles[j] -= (uint16_t)(niveles[j] * dtUs / tauUs);
+        intens[j] = (uint8_t)((niveles[j] >> 8) * brillo / MOTOR_BRILLO_MAX);
+    }
+
+    // Con todas las pistas en pausa no hay vencimiento: el ciclo sale entero
+    bam_planos8(intens, mascaras);
+    bam_ciclo8(mascaras, proximoVencimiento());
+    atomic_fetch_add_explicit(&ciclosBam, 1, memory_order_relaxed);
+    tele_sumar(&tele->salida.ciclosBam, 1);
+}
+
+// -------------------- Comandos --------------------
+static void reproducir(const comando_t *cmd) {
+    int id = cmd->secuencia;
+    pista_t *p = &pistas[cmd->pista];
+
+    if (!hayPistas())
+        reloj_ahora(&ultimoCiclo);   // cicloBam() estaba quieto
+    if (p->prog)
+        guardarPosicion(p);   // el que estaba se retoma después desde acá
+    liberarPista(cmd->pista);
+
+    int guardada = atomic_load(&velocidades[id]);
+    p->prog  = programas[id];
+    p->id    = id;
+    p->grupo = cmd->grupo;
+    if (guardada > 0)
+        p->delay_ms = guardada;
+    else if (p->prog->delayMs > 0)
+        p->delay_ms = p->prog->delayMs;
+    else
+        p->delay_ms = cmd->valor;
+    atomic_store(&velocidades[id], p->delay_ms);
+    atomic_store(&activos[cmd->pista], id);
+
+    // Retoma el programa en el paso (y lo que le faltaba) donde quedó
+    const posicion_t *pos = &posiciones[id];
+    int retomar = pos->paso < p->prog->cantPasos;
+    p->paso = retomar ? pos->paso : 0;
+
+    reloj_iniciar(&p->reloj);
+    atomic_store_explicit(&framesPista[cmd->pista], 0, memory_order_relaxed);
+    iniciarPaso(p, retomar ? pos->restanteMs : 0);
+    actualizarSalida();
+}
+
+static void pausar(int i) {
+    pista_t *p = &pistas[i];
+    struct timespec ahora;
+
+    if (!p->prog || p->pausada)
+        return;
+
+    reloj_ahora(&ahora);
+    long us = usDesde(&ahora, &p->reloj.proximo);
+    p->restanteUs = us > 0 ? us : 0;
+    p->congelado = framePista(p);
+    p->pausada = 1;
+    atomic_store(&pausadas[i], 1);
+    actualizarSalida();   // el frame queda quieto y el timer pasa a la que sigue
+}
+
+static void reanudar(int i) {
+    pista_t *p = &pistas[i];
+
+    if (!p->prog || !p->pausada)
+        return;
+
+    // El paso termina lo que le faltaba, contado desde ahora
+    reloj_ahora(&p->reloj.proximo);
+    p->reloj.proximo.tv_sec  += p->restanteUs / 1000000L;
+    p->reloj.proximo.tv_nsec += (p->restanteUs % 1000000L) * 1000L;
+    if (p->reloj.proximo.tv_nsec >= 1000000000L) {
+        p->reloj.proximo.tv_sec++;
+        p->reloj.proximo.tv_nsec -= 1000000000L;
+    }
+    p->pausada = 0;
+    atomic_store(&pausadas[i], 0);
+    actualizarSalida();
+}
+
+// Devuelve 1 si hay que terminar el hilo
+static int procesarComandos(void) {
+    comando_t cmd;
+    int aplicados = 0;
+
+    while (cola_desencolar(&comandos, &cmd)) {
+        pista_t *p = &pistas[cmd.pista];
+        tele_sumar(&tele->salida.comandos, 1);
+
+        switch (cmd.tipo) {
+        case CMD_REPRODUCIR:
+            if (cmd.secuencia < atomic_load(&cantProgramas))
+                reproducir(&cmd);
+            break;
+
+        case CMD_VELOCIDAD:
+            // Rige desde el próximo frame, como el delay en curso ya fue programado
+            if (p->prog) {
+                p->delay_ms = cmd.valor;
+                atomic_store(&velocidades[p->id], cmd.valor);
+            }
+            break;
+
+        case CMD_DETENER:
+            if (p->prog) {
+                guardarPosicion(p);
+                liberarPista(cmd.pista);
+                actualizarSalida();
+            }
+            break;
+
+        case CMD_PAUSAR:
+            pausar(cmd.pista);
+            break;
+
+        case CMD_REANUDAR:
+            reanudar(cmd.pista);
+            break;
+
+        case CMD_MEZCLA:
+            p->mezcla = (uint8_t)cmd.valor;
+            if (p->prog)
+                actualizarSalida();
+            break;
+
+        case CMD_RESET_VELOCIDADES:
+            // Las secuencias vuelven a empezar de cero y con el delay inicial
+            for (int i = 0; i < MOTOR_MAX_PROGRAMAS; i++)
+                atomic_store(&velocidades[i], 0);
+            memset(posiciones, 0, sizeof(posiciones));
+            break;
+
+        case CMD_INTENSIDAD:
+            cambiarIntensidad(cmd.valor & 0xFF, cmd.valor >> 8);
+            break;
+
+        case CMD_SALIR:
+            for (int i = 0; i < MOTOR_PISTAS; i++)
+                liberarPista(i);
+            armarVencimiento(NULL);
+            hal_escribirFrame(0);
+            publicar(0);
+            return 1;
+        }
+        atomic_fetch_add(&confirmados, 1);
+        aplicados = 1;
+    }
+    if (aplicados && atomic_load(&confirmacionPedida))
+        avisar(confirmaFd);
+    return 0;
+}
+
+static void *hiloSalida(void *arg) {
+    (void)arg;
+
+    struct pollfd pfd[2] = {
+        { .fd = timbreFd, .events = POLLIN },
+        { .fd = timerFd,  .events = POLLIN },
+    };
+
+    while (1) {
+        if (procesarComandos())
+            break;
+
+        // Un programa vivo cambió su frame (en BAM ya se compone en cada ciclo)
+        if (atomic_exchange(&refrescoPedido, 0) && hayPistas()) {
+            if (modoBam)
+                publicar(componer());
+            else
+                actualizarSalida();
+        }
+
+        // En BAM el hilo no duerme en poll(): duerme entre planos y mira la
+        // cola (sin syscalls) una vez por ciclo
+        if (modoBam && hayPistas()) {
+            cicloBam();
+            continue;
+        }
+
+        if (poll(pfd, 2, -1) < 0)
+            continue;
+
+        if (pfd[1].revents & POLLIN) {
+            uint64_t vencidos;
+            if (read(timerFd, &vencidos, sizeof(vencidos)) == sizeof(vencidos) && vencerPistas())
+                actualizarSalida();
+        }
+
+        if (pfd[0].revents & POLLIN) {
+            uint64_t n;
+            if (read(timbreFd, &n, sizeof(n)) < 0) {
+                // EAGAIN: ya no quedaba nada pendiente
+            }
+        }
+    }
+    return NULL;
+}
+
+// -------------------- Lado interfaz --------------------
+static int enviarComando(const comando_t *cmd) {
+    if (cola_encolar(&comandos, cmd) != 0)
+        return 1;
+    pedidos++;
+    if (sinHilo)
+        procesarComandos();
+    else
+        avisar(timbreFd);
+    return 0;
+}
+
+static int enviar(int tipo, int pista, int valor) {
+    comando_t cmd = { .tipo = (uint16_t)tipo, .valor = valor, .pista = (uint8_t)pista };
+    return enviarComando(&cmd);
+}
+
+int motor_registrar(const programa_t *prog) {
+    int id = atomic_load(&cantProgramas);
+    if (id >= MOTOR_MAX_PROGRAMAS)
+        return -1;
+
+    programas[id] = prog;
+    atomic_store(&cantProgramas, id + 1);
+    return id;
+}
+
+// Lo que comparten el motor con hilo y el virtual
+static int prepararMotor(void) {
+    cola_iniciar(&comandos);
+    bt_iniciar(&frames);
+    bam_iniciar(GAMMA);
+
+    // Las velocidades de la última vez, si hay archivo de estado abierto
+    for (int i = 0; i < MOTOR_MAX_PROGRAMAS; i++)
+        atomic_store(&velocidades[i], estado_leer(ESTADO_VELOCIDAD(i)));
+    for (int i = 0; i < MOTOR_PISTAS; i++) {
+        reloj_iniciar(&pistas[i].reloj);
+        atomic_store(&activos[i], -1);
+    }
+
+    timbreFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    avisoFd  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    confirmaFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    timerFd  = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    return timbreFd < 0 || avisoFd < 0 || confirmaFd < 0 || timerFd < 0;
+}
+
+int motor_iniciar(void) {
+    if (hiloCorriendo || sinHilo)
+        return 0;
+    if (prepararMotor() != 0)
+        return 1;
+
+    // Intentar SCHED_FIFO con memoria bloqueada; sin permisos corre como hilo normal
+    pthread_attr_t attr;
+    struct sched_param sp = { .sched_priority = PRIORIDAD_FIFO };
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    pthread_attr_setschedparam(&attr, &sp);
+
+    if (pthread_create(&hilo, &attr, hiloSalida, NULL) == 0) {
+        esTiempoReal = 1;
+        // MCL_ONFAULT bloquea cada página al tocarla la primera vez: traer
+        // todo el proceso de una tardaba ~10 ms antes del primer frame
+        if (mlockall(MCL_CURRENT | MCL_FUTURE | MCL_ONFAULT) != 0)
+            mlockall(MCL_CURRENT | MCL_FUTURE);   // kernel anterior a 4.4
+    } else if (pthread_create(&hilo, NULL, hiloSalida, NULL) != 0) {
+        pthread_attr_destroy(&attr);
+        return 1;
+    }
+    pthread_attr_destroy(&attr);
+
+    hiloCorriendo = 1;
+    return 0;
+}
+
+// Sin hilo y con el reloj virtual: cada comando se aplica al enviarlo y el
+// tiempo solo corre con motor_simular(). Para simular secuencias sin placa.
+int motor_iniciarVirtual(void) {
+    if (hiloCorriendo || sinHilo)
+        return 0;
+
+    reloj_usarVirtual();
+    sinHilo = 1;
+    if (prepararMotor() != 0) {
+        sinHilo = 0;
+        return 1;
+    }
+    return 0;
+}
+
+// Lleva el reloj virtual al próximo vencimiento y lo atiende, si llega antes
+// de 'hastaUs' (desde el arranque del reloj virtual): devuelve 1. Si no,
+// deja el reloj en 'hastaUs' y devuelve 0.
+int motor_simular(long hastaUs) {
+    struct timespec limite = { .tv_sec = hastaUs / 1000000L, .tv_nsec = hastaUs % 1000000L * 1000L };
+    const struct timespec *t = proximoVencimiento();
+
+    if (!sinHilo)
+        return 0;
+    if (!t || usDesde(&limite, t) > 0) {
+        reloj_fijarVirtual(&limite);
+        return 0;
+    }
+
+    struct timespec vence = *t;
+    reloj_fijarVirtual(&vence);
+    if (vencerPistas())
+        actualizarSalida();
+    return 1;
+}
+
+void motor_cerrar(void) {
+    if (sinHilo) {
+        enviar(CMD_SALIR, 0, 0);
+        sinHilo = 0;
+        return;
+    }
+    if (!hiloCorriendo)
+        return;
+
+    while (enviar(CMD_SALIR, 0, 0) != 0)
+        usleep(1000);
+    pthread_join(hilo, NULL);
+    hiloCorriendo = 0;
+    motor_guardarEstado();
+}
+
+// Envía un comando y espera a que el hilo de salida lo aplique. Con
+// motor_esperarConfirmacion(0) no espera nada: si la cola está llena
+// devuelve 1 en el momento, para no frenar al servidor de control.
+static int enviarYEsperar(const comando_t *cmd) {
+    if (!esperar)
+        return enviarComando(cmd);
+
+    while (enviarComando(cmd) != 0)
+        usleep(1000);
+    motor_esperarMarca(pedidos);
+    motor_guardarEstado();
+    return 0;
+}
+
+void motor_guardarEstado(void) {
+    for (int i = 0; i < MOTOR_MAX_PROGRAMAS; i++)
+        estado_guardar(ESTADO_VELOCIDAD(i), atomic_load_explicit(&velocidades[i], memory_order_relaxed));
+}
+
+// Un cambio de velocidad o un reset que no esperó: se guarda cuando el hilo
+// de salida lo aplicó, desde quien vuelva a preguntar
+static void pedirGuardado(void) {
+    guardarPendiente = 1;
+    marcaGuardar = pedidos;
+}
+
+int motor_guardarPendiente(void) {
+    if (!guardarPendiente)
+        return 0;
+    if (!motor_aplicado(marcaGuardar))
+        return 1;
+    guardarPendiente = 0;
+    motor_guardarEstado();
+    return 0;
+}
+
+void motor_esperarConfirmacion(int si) {
+    esperar = si;
+}
+
+unsigned int motor_marca(void) {
+    return pedidos;
+}
+
+int motor_aplicado(unsigned int marca) {
+    return (int)(atomic_load(&confirmados) - marca) >= 0;
+}
+
+void motor_esperarMarca(unsigned int marca) {
+    while (!motor_aplicado(marca))
+        usleep(200);
+}
+
+int motor_fdConfirmacion(void) {
+    return confirmaFd;
+}
+
+void motor_pedirConfirmacion(int si) {
+    atomic_store(&confirmacionPedida, si);
+}
+
+void motor_consumirConfirmacion(void) {
+    uint64_t n;
+    if (read(confirmaFd, &n, sizeof(n)) < 0) {
+        // EAGAIN: nada pendiente
+    }
+}
+
+static int pistaValida(int pista) {
+    return pista >= 0 && pista < MOTOR_PISTAS;
+}
+
+static int ordenarPista(int tipo, int pista) {
+    if (!pistaValida(pista))
+        return 1;
+    comando_t cmd = { .tipo = (uint16_t)tipo, .pista = (uint8_t)pista };
+    return enviarYEsperar(&cmd);
+}
+
+void motor_reproducir(int id, int delayInicial) {
+    motor_reproducirEn(0, id, delayInicial, MOTOR_GRUPO_TODO);
+}
+
+int motor_cambiarVelocidad(int delay_ms) {
+    return motor_cambiarVelocidadEn(0, delay_ms);
+}
+
+// Detiene la secuencia en curso; al volver sus LEDs ya están apagados
+void motor_detener(void) {
+    motor_detenerPista(0);
+}
+
+int motor_resetVelocidades(void) {
+    comando_t cmd = { .tipo = CMD_RESET_VELOCIDADES };
+    if (enviarYEsperar(&cmd) != 0)
+        return 1;
+    if (!esperar)
+        pedirGuardado();
+    return 0;
+}
+
+// Reproduce 'id' en la pista sobre las posiciones de 'grupo'. Si el programa
+// ya había corrido, retoma en el paso donde quedó.
+int motor_reproducirEn(int pista, int id, int delayInicial, uint8_t grupo) {
+    if (!pistaValida(pista) || id < 0 || id >= MOTOR_MAX_PROGRAMAS)
+        return 1;
+
+    comando_t cmd = {
+        .tipo = CMD_REPRODUCIR,
+        .secuencia = (uint16_t)id,
+        .valor = delayInicial,
+        .pista = (uint8_t)pista,
+        .grupo = grupo,
+    };
+    return enviarYEsperar(&cmd);
+}
+
+int motor_cambiarVelocidadEn(int pista, int delay_ms) {
+    if (!pistaValida(pista) || enviar(CMD_VELOCIDAD, pista, delay_ms) != 0)
+        return 1;
+    pedirGuardado();
+    return 0;
+}
+
+int motor_detenerPista(int pista) {
+    return ordenarPista(CMD_DETENER, pista);
+}
+
+int motor_pausar(int pista) {
+    return ordenarPista(CMD_PAUSAR, pista);
+}
+
+int motor_reanudar(int pista) {
+    return ordenarPista(CMD_REANUDAR, pista);
+}
+
+// Cómo se combina la pista con las de número menor (compositor.h); por
+// defecto COMP_OR. Queda para lo que se reproduzca después.
+int motor_mezclarPista(int pista, int mezcla) {
+    if (!pistaValida(pista) || !COMP_VALIDA(mezcla))
+        return 1;
+    comando_t cmd = { .tipo = CMD_MEZCLA, .pista = (uint8_t)pista, .valor = mezcla };
+    return enviarYEsperar(&cmd);
+}
+
+void motor_refrescar(void) {
+    if (!atomic_exchange(&refrescoPedido, 1) && !sinHilo)
+        avisar(timbreFd);
+}
+
+int motor_activoEn(int pista) {
+    return pistaValida(pista) ? atomic_load(&activos[pista]) : -1;
+}
+
+int motor_pausada(int pista) {
+    return pistaValida(pista) ? atomic_load(&pausadas[pista]) : 0;
+}
+
+const relojFrames_t *motor_relojEn(int pista) {
+    return &pistas[pistaValida(pista) ? pista : 0].reloj;
+}
+
+long motor_framesEn(int pista) {
+    return pistaValida(pista) ? atomic_load_explicit(&framesPista[pista], memory_order_relaxed) : 0;
+}
+
+int motor_velocidad(int id) {
+    if (id < 0 || id >= MOTOR_MAX_PROGRAMAS)
+        return 0;
+    return atomic_load_explicit(&velocidades[id], memory_order_relaxed);
+}
+
+int motor_activo(void) {
+    return atomic_load(&activos[0]);
+}
+
+int motor_tiempoReal(void) {
+    return esTiempoReal;
+}
+
+int motor_leerFrame(frameInfo_t *f) {
+    return bt_leer(&frames, f);
+}
+
+const relojFrames_t *motor_reloj(void) {
+    return &pistas[0].reloj;
+}
+
+int motor_fdAviso(void) {
+    return avisoFd;
+}
+
+void motor_consumirAviso(void) {
+    uint64_t n;
+    if (read(avisoFd, &n, sizeof(n)) < 0) {
+        // EAGAIN: no había aviso pendiente
+    }
+}
+
+// brillo 0..MOTOR_BRILLO_MAX; estela en medios delays (0 = se apaga de golpe)
+int motor_configurarIntensidad(int nuevoBrillo, int nuevaEstela) {
+    if (nuevoBrillo < 0)
+        nuevoBrillo = 0;
+    if (nuevoBrillo > MOTOR_BRILLO_MAX)
+        nuevoBrillo = MOTOR_BRILLO_MAX;
+    if (nuevaEstela < 0)
+        nuevaEstela = 0;
+    if (nuevaEstela > 255)
+        nuevaEstela = 255;
+
+    atomic_store(&brilloPedido, nuevoBrillo);
+    atomic_store(&estelaPedida, nuevaEstela);
+    return enviar(CMD_INTENSIDAD, 0, nuevoBrillo | nuevaEstela << 8);
+}
+
+int motor_brillo(void) {
+    return atomic_load(&brilloPedido);
+}
+
+int motor_estela(void) {
+    return atomic_load(&estelaPedida);
+}
+
+unsigned long motor_ciclosBam(void) {
+    return atomic_load_explicit(&ciclosBam, memory_order_relaxed);
+}
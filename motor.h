@@ -0,0 +1,112 @@
+#ifndef MOTOR_H
+#define MOTOR_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "reloj.h"
+#include "buffer_triple.h"
+
+#define MOTOR_MAX_PROGRAMAS 512
+#define MOTOR_FRAME_MIN_MS  10   // duración mínima de un frame (ms)
+#define MOTOR_BRILLO_MAX    255
+#define MOTOR_PISTAS        4      // secuencias simultáneas, cada una en su grupo de LEDs
+#define MOTOR_GRUPO_TODO    0xFF   // las 8 posiciones del frame (ver frame.h)
+
+// Un paso de un programa: frame a mostrar y cuánto dura.
+// La duración es 'medios' mitades del delay de la secuencia, o 'fijoMs' si es > 0.
+typedef struct {
+    uint8_t  frame;
+    uint8_t  medios;
+    uint16_t fijoMs;
+} paso_t;
+
+typedef struct {
+    const char   *nombre;
+    const paso_t *pasos;
+    int           cantPasos;
+    int           bucle;      // 1 = se repite, 0 = termina al llegar al final
+    int           delayMs;    // delay por defecto (0 = el delay inicial del menú)
+    const _Atomic uint8_t *vivo;   // != NULL: el frame lo pone otro hilo (audio.h) y
+                                   // los pasos solo marcan el ritmo de la pista
+} programa_t;
+
+int  motor_registrar(const programa_t *prog);
+int  motor_iniciar(void);
+void motor_cerrar(void);
+
+// Sin hilo, con el reloj virtual (reloj.h): los comandos se aplican al
+// enviarlos y motor_simular() avanza de vencimiento en vencimiento. Las
+// secuencias corren miles de veces más rápido que en la placa, sin BAM.
+int  motor_iniciarVirtual(void);
+int  motor_simular(long hastaUs);
+
+// Comandos (hilo de interfaz -> hilo de salida)
+void motor_reproducir(int id, int delayInicial);
+int  motor_cambiarVelocidad(int delay_ms);
+void motor_detener(void);
+int  motor_resetVelocidades(void);
+int  motor_configurarIntensidad(int brillo, int estela);
+
+// Pistas: cada una reproduce su programa sobre un grupo de posiciones del
+// frame (bit j = posición j) a su propia velocidad, y el frame de salida es
+// la unión de todas. Las funciones de arriba manejan la pista 0 con las 8
+// posiciones. Un programa que deja una pista (otro lo reemplaza, se detiene o
+// se pausa) retoma después en el mismo paso.
+//
+// La unión es la mezcla por defecto: cada pista es una capa del compositor
+// (compositor.h) que se aplica sobre las anteriores con OR, AND, XOR o MASCARA.
+int  motor_reproducirEn(int pista, int id, int delayInicial, uint8_t grupo);
+int  motor_cambiarVelocidadEn(int pista, int delay_ms);
+int  motor_detenerPista(int pista);
+int  motor_pausar(int pista);
+int  motor_reanudar(int pista);
+int  motor_mezclarPista(int pista, int mezcla);
+int  motor_activoEn(int pista);
+int  motor_pausada(int pista);
+const relojFrames_t *motor_relojEn(int pista);   // lo escribe el hilo de salida: leerlo quieto
+long motor_framesEn(int pista);                   // frames de la pista, desde cualquier hilo
+
+// Desde cualquier hilo: cambió el frame de un programa 'vivo' y hay que
+// volver a componer la salida sin esperar al próximo paso
+void motor_refrescar(void);
+
+// Estado legible sin locks desde la interfaz
+int  motor_velocidad(int id);
+int  motor_activo(void);
+int  motor_tiempoReal(void);
+int  motor_leerFrame(frameInfo_t *f);
+const relojFrames_t *motor_reloj(void);
+int  motor_brillo(void);
+int  motor_estela(void);
+unsigned long motor_ciclosBam(void);
+
+// Lleva las velocidades al archivo de estado (estado.h). Solo la interfaz:
+// lo hacen solos los comandos que esperan y motor_cerrar(). Los que no
+// esperan (motor_cambiarVelocidad, o cualquiera con
+// motor_esperarConfirmacion(0)) dejan el guardado pendiente:
+// motor_guardarPendiente() lo hace si el hilo ya los aplicó y devuelve 1
+// mientras falte (se puede esperar con motor_esperarMarca o con el aviso de
+// motor_fdConfirmacion).
+void motor_guardarEstado(void);
+int  motor_guardarPendiente(void);
+
+// eventfd que el hilo de salida marca cuando un programa termina solo
+int  motor_fdAviso(void);
+void motor_consumirAviso(void);
+
+// Comandos sin esperar (el servidor de control): con 0 los reproducir,
+// detener, pausar... vuelven apenas quedan en la cola, o con 1 si la cola
+// está llena (no reintentan ni duermen). motor_marca() es el último
+// encolado y motor_aplicado() dice si el hilo ya llegó hasta ahí; con
+// motor_pedirConfirmacion(1) el hilo marca motor_fdConfirmacion() cada vez
+// que aplica comandos.
+void motor_esperarConfirmacion(int si);
+unsigned int motor_marca(void);
+int  motor_aplicado(unsigned int marca);
+void motor_esperarMarca(unsigned int marca);
+int  motor_fdConfirmacion(void);
+void motor_pedirConfirmacion(int si);
+void motor_consumirConfirmacion(void);
+
+#endif
@@ -0,0 +1,200 @@
+// pantalla.c
+// Renderizador por diferencias: el menú y los mensajes se arman en un modelo
+// de filas de texto, y al dibujar se manda a stdout o al UART solo lo que
+// cambió respecto de lo que ese destino ya muestra (posicionando el cursor con
+// escapes ANSI). Reemplaza a system("clear") + printf de la pantalla entera.
+#include "pantalla.h"
+#include "uart_tx.h"
+#include "reloj.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdint.h>
+
+#define LARGO_SALIDA (PANTALLA_FILAS * (PANTALLA_COLUMNAS + 16) + 32)
+#define LARGO_ESTADO_UART 160   // lo que acepta uart_estado()
+
+#define TODAS (~(uint64_t)0)
+#define SUCIA '\x01'   // marca de fila que el destino pudo haber tocado (eco)
+
+typedef struct {
+    char mostrado[PANTALLA_FILAS][PANTALLA_COLUMNAS + 1];
+    int valido;   // 0 = no se sabe qué hay en pantalla: se borra todo
+} destino_t;
+
+static char modelo[PANTALLA_FILAS][PANTALLA_COLUMNAS + 1];
+static destino_t destinos[2];
+static int destinoActual = PANTALLA_LOCAL;
+
+static int cursorFila = -1, cursorCol = -1;
+
+static uint64_t filasPendientes = 0;   // filas de estado sin dibujar
+static long ultimoEstadoMs = -PANTALLA_INTERVALO_MS;
+
+static char salida[LARGO_SALIDA];
+static unsigned long emitidos = 0;
+static uint64_t filasEstadoUart = 0;   // filas del último uart_estado()
+
+static long ahoraMs(void) {
+    return reloj_ms();
+}
+
+// Columnas que ocupa un texto UTF-8 (no cuenta los bytes de continuación)
+static int ancho(const char *s) {
+    int n = 0;
+    for (; *s; s++)
+        if (((unsigned char)*s & 0xC0) != 0x80)
+            n++;
+    return n;
+}
+
+// Copia sacando caracteres de control y sin cortar un carácter UTF-8 al medio
+static void copiarFila(char *dest, const char *texto) {
+    size_t n = 0;
+
+    for (; *texto && n < PANTALLA_COLUMNAS; texto++) {
+        if ((unsigned char)*texto < 0x20 || *texto == 0x7F)
+            continue;
+        dest[n++] = *texto;
+    }
+    if (*texto) {
+        while (n > 0 && ((unsigned char)dest[n - 1] & 0xC0) == 0x80)
+            n--;
+        if (n > 0 && ((unsigned char)dest[n - 1] & 0xC0) == 0xC0)
+            n--;
+    }
+    dest[n] = '\0';
+}
+
+void pantalla_destino(int destino) {
+    destinoActual = destino == PANTALLA_REMOTA ? PANTALLA_REMOTA : PANTALLA_LOCAL;
+}
+
+int pantalla_destinoActual(void) {
+    return destinoActual;
+}
+
+void pantalla_limpiar(void) {
+    memset(modelo, 0, sizeof(modelo));
+    cursorFila = cursorCol = -1;
+    filasPendientes = 0;
+}
+
+void pantalla_linea(int fila, const char *fmt, ...) {
+    char texto[PANTALLA_COLUMNAS * 2];
+    va_list ap;
+
+    if (fila < 0 || fila >= PANTALLA_FILAS)
+        return;
+
+    va_start(ap, fmt);
+    vsnprintf(texto, sizeof(texto), fmt, ap);
+    va_end(ap);
+
+    copiarFila(modelo[fila], texto);
+}
+
+void pantalla_cursor(int fila, int col) {
+    cursorFila = fila;
+    cursorCol = col;
+}
+
+void pantalla_invalidar(void) {
+    destinos[destinoActual].valido = 0;
+}
+
+// Arma en 'salida' los escapes para las filas cambiadas dentro de 'filas'
+static size_t armarSalida(destino_t *d, uint64_t filas) {
+    size_t n = 0;
+
+    if (!d->valido) {
+        n += (size_t)snprintf(salida + n, LARGO_SALIDA - n, "\033[2J");
+        memset(d->mostrado, 0, sizeof(d->mostrado));
+        d->valido = 1;
+        filas = TODAS;
+    }
+
+    for (int f = 0; f < PANTALLA_FILAS; f++) {
+        if (!(filas >> f & 1))
+            continue;
+        if (strcmp(d->mostrado[f], modelo[f]) == 0)
+            continue;
+
+        n += (size_t)snprintf(salida + n, LARGO_SALIDA - n, "\033[%d;1H%s\033[K", f + 1, modelo[f]);
+        memcpy(d->mostrado[f], modelo[f], sizeof(modelo[f]));
+    }
+
+    if (cursorFila >= 0 && cursorFila < PANTALLA_FILAS) {
+        int col = cursorCol >= 0 ? cursorCol : ancho(modelo[cursorFila]);
+        n += (size_t)snprintf(salida + n, LARGO_SALIDA - n, "\033[%d;%dH", cursorFila + 1, col + 1);
+
+        // Lo que se tipee ahí (eco de fgets o del menú remoto) queda en
+        // pantalla: la próxima vez esa fila se reescribe entera.
+        d->mostrado[cursorFila][0] = SUCIA;
+        d->mostrado[cursorFila][1] = '\0';
+    }
+    return n;
+}
+
+static void emitir(uint64_t filas) {
+    destino_t *d = &destinos[destinoActual];
+    size_t n = armarSalida(d, filas);
+
+    if (n == 0)
+        return;
+    emitidos += n;
+
+    if (destinoActual == PANTALLA_LOCAL) {
+        fwrite(salida, 1, n, stdout);
+        fflush(stdout);
+    } else if (filas != TODAS && filas == filasEstadoUart && n < LARGO_ESTADO_UART) {
+        // Mismas filas que el estado anterior: si aquel no salió, este lo reemplaza
+        salida[n] = '\0';
+        uart_estado(salida);
+    } else {
+        // uart_escribir() deja fijo cualquier estado anterior antes de encolar
+        uart_escribir(salida, n);
+        filasEstadoUart = filas != TODAS ? filas : 0;
+    }
+}
+
+void pantalla_dibujar(void) {
+    filasPendientes = 0;
+    emitir(TODAS);
+}
+
+void pantalla_estado(int fila, const char *fmt, ...) {
+    char texto[PANTALLA_COLUMNAS * 2];
+    va_list ap;
+
+    if (fila < 0 || fila >= PANTALLA_FILAS)
+        return;
+
+    va_start(ap, fmt);
+    vsnprintf(texto, sizeof(texto), fmt, ap);
+    va_end(ap);
+
+    copiarFila(modelo[fila], texto);
+    filasPendientes |= (uint64_t)1 << fila;
+}
+
+int pantalla_refrescar(void) {
+    if (!filasPendientes)
+        return -1;
+
+    long t = ahoraMs();
+    long falta = ultimoEstadoMs + PANTALLA_INTERVALO_MS - t;
+    if (falta > 0)
+        return (int)falta;
+
+    uint64_t filas = filasPendientes;
+    filasPendientes = 0;
+    ultimoEstadoMs = t;
+    emitir(filas);
+    return -1;
+}
+
+unsigned long pantalla_bytesEmitidos(void) {
+    return emitidos;
+}
@@ -0,0 +1,36 @@
+#ifndef PANTALLA_H
+#define PANTALLA_H
+
+// Modelo de pantalla compartido por la terminal local y el menú remoto
+#define PANTALLA_FILAS        48
+#define PANTALLA_COLUMNAS    128   // bytes por fila (UTF-8)
+#define PANTALLA_INTERVALO_MS 50   // mínimo entre redibujos de una línea de estado
+
+// Destinos del dibujo
+enum {
+    PANTALLA_LOCAL,    // stdout
+    PANTALLA_REMOTA    // UART (uart_tx)
+};
+
+void pantalla_destino(int destino);
+int  pantalla_destinoActual(void);
+
+// Armado del modelo (no escribe nada todavía)
+void pantalla_limpiar(void);
+void pantalla_linea(int fila, const char *fmt, ...);
+void pantalla_cursor(int fila, int col);   // col -1 = al final de la fila
+void pantalla_invalidar(void);             // alguien escribió por fuera: redibujo completo
+
+// Manda al destino actual solo las filas que cambiaron
+void pantalla_dibujar(void);
+
+// Filas de estado: pantalla_estado() cambia la fila y la deja pendiente, y
+// pantalla_refrescar() dibuja las pendientes como mucho cada
+// PANTALLA_INTERVALO_MS. Devuelve cuántos ms faltan para poder dibujarlas (o
+// -1 si no queda nada), listo para usar como timeout de reactor_esperar().
+void pantalla_estado(int fila, const char *fmt, ...);
+int  pantalla_refrescar(void);
+
+unsigned long pantalla_bytesEmitidos(void);
+
+#endif
@@ -0,0 +1,329 @@
+// protocolo.c
+// Tramas binarias de control por el UART (ver protocolo.h). El lector se
+// alimenta byte a byte desde el filtro de entradaSerial, así una trama puede
+// llegar partida en varios read() del puente Arduino; los comandos van al
+// hilo de salida por la misma cola que usa el menú.
+#include "protocolo.h"
+#include "crc.h"
+#include "motor.h"
+#include "compositor.h"
+#include "secuencias.h"
+#include "uart_tx.h"
+#include "adc.h"
+#include "telemetria.h"
+
+#include <string.h>
+#include <time.h>
+
+enum {
+    P_ESPERA,   // fuera de trama: los bytes son texto
+    P_LARGO,
+    P_DATOS     // largo, seq, comandos y crc
+};
+
+#define DELAY_MIN   10
+#define DELAY_MAX   10000
+
+static protoLector_t lector;
+static long ultimoByteMs;
+
+// Última respuesta, para contestar igual si el PC reintenta la misma trama
+static uint8_t  respuesta[PROTO_MAX_TRAMA];
+static size_t   largoRespuesta = 0;
+static uint8_t  ultimoSeq;
+static uint16_t ultimoCrc;
+
+static unsigned long recibidas = 0;
+static unsigned long descartadas = 0;
+
+static long ahoraMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+// Arma una trama completa en 'dest' (PROTO_MAX_TRAMA bytes); devuelve su largo
+size_t proto_armar(uint8_t *dest, uint8_t seq, const uint8_t *carga, size_t n) {
+    if (n > PROTO_MAX_CARGA - 1)
+        n = PROTO_MAX_CARGA - 1;
+
+    dest[0] = PROTO_STX;
+    dest[1] = (uint8_t)(n + 1);
+    dest[2] = seq;
+    memcpy(dest + 3, carga, n);
+
+    uint16_t crc = crc_ccitt(dest + 1, n + 2);
+    dest[n + 3] = (uint8_t)(crc >> 8);
+    dest[n + 4] = (uint8_t)crc;
+    return n + 5;
+}
+
+void proto_leerEstado(const uint8_t *d, protoEstado_t *e) {
+    e->activo         = (int16_t)(d[0] | d[1] << 8);
+    e->delayMs        = (uint16_t)(d[2] | d[3] << 8);
+    e->brillo         = d[4];
+    e->estela         = d[5];
+    e->cantSecuencias = (uint16_t)(d[6] | d[7] << 8);
+    e->frames         = (uint32_t)d[8] | (uint32_t)d[9] << 8 | (uint32_t)d[10] << 16 | (uint32_t)d[11] << 24;
+}
+
+// -------------------- Lector --------------------
+void proto_lectorIniciar(protoLector_t *l) {
+    l->estado = P_ESPERA;
+    l->pos = 0;
+}
+
+int proto_enTrama(const protoLector_t *l) {
+    return l->estado != P_ESPERA;
+}
+
+uint8_t proto_seq(const protoLector_t *l) {
+    return l->trama[1];
+}
+
+const uint8_t *proto_carga(const protoLector_t *l, int *largo) {
+    *largo = l->trama[0] - 1;
+    return l->trama + 2;
+}
+
+int proto_leer(protoLector_t *l, uint8_t b) {
+    switch (l->estado) {
+    case P_ESPERA:
+        if (b == PROTO_STX)
+            l->estado = P_LARGO;
+        return 0;
+
+    case P_LARGO:
+        if (b == 0 || b > PROTO_MAX_CARGA) {
+            // No puede ser una trama: se vuelve a buscar STX
+            l->estado = P_ESPERA;
+            l->pos = 0;
+            return -1;
+        }
+        l->trama[0] = b;
+        l->pos = 1;
+        l->estado = P_DATOS;
+        return 0;
+
+    case P_DATOS: {
+        l->trama[l->pos++] = b;
+        int total = l->trama[0] + 3;   // largo + datos + crc
+        if (l->pos < total)
+            return 0;
+
+        l->estado = P_ESPERA;
+        uint16_t crc = (uint16_t)(l->trama[total - 2] << 8 | l->trama[total - 1]);
+        return crc_ccitt(l->trama, (size_t)total - 2) == crc ? 1 : -1;
+    }
+    }
+    return 0;
+}
+
+// -------------------- Ejecución --------------------
+static int leer16(const uint8_t *p) {
+    return p[0] | p[1] << 8;
+}
+
+static void escribirEstado(uint8_t *d, int pista) {
+    int activo = motor_activoEn(pista);
+    int delay = activo >= 0 ? motor_velocidad(activo) : 0;
+    uint32_t frames = activo >= 0 ? (uint32_t)motor_framesEn(pista) : 0;
+
+    int cantidad = secuencias_cantidad();
+
+    d[0]  = (uint8_t)activo;   // -1 queda 0xFFFF
+    d[1]  = (uint8_t)(activo >> 8);
+    d[2]  = (uint8_t)delay;
+    d[3]  = (uint8_t)(delay >> 8);
+    d[4]  = (uint8_t)motor_brillo();
+    d[5]  = (uint8_t)motor_estela();
+    d[6]  = (uint8_t)cantidad;
+    d[7]  = (uint8_t)(cantidad >> 8);
+    d[8]  = (uint8_t)frames;
+    d[9]  = (uint8_t)(frames >> 8);
+    d[10] = (uint8_t)(frames >> 16);
+    d[11] = (uint8_t)(frames >> 24);
+}
+
+// Ejecuta los comandos de una trama en orden hasta el primer error y arma la
+// respuesta en 'resp' (sin STX/CRC); devuelve su largo
+int proto_ejecutar(const uint8_t *c, int n, uint8_t *resp, int *consulta) {
+    int i = 0, ejecutados = 0, resultado = PROTO_OK, consultar = 0;
+    int pista = 0;
+    uint8_t grupo = MOTOR_GRUPO_TODO;
+
+    motor_esperarConfirmacion(0);
+
+    while (i < n && resultado == PROTO_OK) {
+        int cmd = c[i++];
+        int args = cmd == PROTO_SELECCIONAR ? 4 :
+                   cmd == PROTO_VELOCIDAD || cmd == PROTO_INTENSIDAD || cmd == PROTO_PISTA ? 2 :
+                   cmd == PROTO_MEZCLA ? 1 : 0;
+
+        if (i + args > n) {
+            resultado = PROTO_ERROR_COMANDO;
+            break;
+        }
+
+        switch (cmd) {
+        case PROTO_SELECCIONAR: {
+            int id = leer16(c + i), delay = leer16(c + i + 2);
+            if (delay == 0)
+                delay = adc_delay();
+            // La de audio necesita su hilo de captura, que vive mientras el
+            // menú la atiende (runPrograma): por acá quedaría muda
+            if (id >= secuencias_cantidad() || id == secuencias_idAudio() ||
+                delay < DELAY_MIN || delay > DELAY_MAX) {
+                resultado = PROTO_ERROR_ARGUMENTO;
+                break;
+            }
+            if (motor_reproducirEn(pista, id, delay, grupo) != 0)
+                resultado = PROTO_ERROR_OCUPADO;
+            break;
+        }
+
+        case PROTO_VELOCIDAD: {
+            int delay = leer16(c + i);
+            if (delay < DELAY_MIN || delay > DELAY_MAX) {
+                resultado = PROTO_ERROR_ARGUMENTO;
+                break;
+            }
+            if (motor_cambiarVelocidadEn(pista, delay) != 0)
+                resultado = PROTO_ERROR_OCUPADO;
+            break;
+        }
+
+        case PROTO_DETENER:
+            if (motor_detenerPista(pista) != 0)
+                resultado = PROTO_ERROR_OCUPADO;
+            break;
+
+        case PROTO_PISTA:
+            if (c[i] >= MOTOR_PISTAS || c[i + 1] == 0) {
+                resultado = PROTO_ERROR_ARGUMENTO;
+                break;
+            }
+            pista = c[i];
+            grupo = c[i + 1];
+            break;
+
+        case PROTO_PAUSAR:
+            if (motor_pausar(pista) != 0)
+                resultado = PROTO_ERROR_OCUPADO;
+            break;
+
+        case PROTO_REANUDAR:
+            if (motor_reanudar(pista) != 0)
+                resultado = PROTO_ERROR_OCUPADO;
+            break;
+
+        case PROTO_MEZCLA:
+            if (!COMP_VALIDA(c[i]))
+                resultado = PROTO_ERROR_ARGUMENTO;
+            else if (motor_mezclarPista(pista, c[i]) != 0)
+                resultado = PROTO_ERROR_OCUPADO;
+            break;
+
+        case PROTO_RESET:
+            if (motor_resetVelocidades() != 0)
+                resultado = PROTO_ERROR_OCUPADO;
+            break;
+
+        case PROTO_INTENSIDAD:
+            if (motor_configurarIntensidad(c[i], c[i + 1]) != 0)
+                resultado = PROTO_ERROR_OCUPADO;
+            break;
+
+        case PROTO_CONSULTAR:
+            consultar = 1;
+            break;
+
+        default:
+            resultado = PROTO_ERROR_COMANDO;
+            break;
+        }
+
+        if (resultado == PROTO_OK) {
+            ejecutados++;
+            i += args;
+        }
+    }
+
+    motor_esperarConfirmacion(1);
+    tele_sumar(&tele->interfaz.tramas, 1);
+    resp[0] = PROTO_RESPUESTA;
+    resp[1] = (uint8_t)resultado;
+    resp[2] = (uint8_t)ejecutados;
+    *consulta = consultar ? pista : -1;
+    return 3;
+}
+
+int proto_agregarEstado(uint8_t *resp, int pista) {
+    escribirEstado(resp + 3, pista);
+    return 3 + PROTO_LARGO_ESTADO;
+}
+
+int proto_byte(uint8_t b) {
+    // Una trama que quedó a medias no se come el texto que viene después
+    long t = ahoraMs();
+    if (proto_enTrama(&lector) && t - ultimoByteMs > PROTO_TIMEOUT_MS) {
+        proto_lectorIniciar(&lector);
+        descartadas++;
+        tele_sumar(&tele->interfaz.tramasDescartadas, 1);
+    }
+    ultimoByteMs = t;
+
+    if (!proto_enTrama(&lector) && b != PROTO_STX)
+        return 0;
+
+    int r = proto_leer(&lector, b);
+    if (r == 0)
+        return 1;
+
+    if (r < 0) {
+        // Solo se contesta si llegó entera: con el largo roto no hay seq
+        uint8_t nak[3] = { PROTO_RESPUESTA, PROTO_ERROR_CRC, 0 };
+        uint8_t trama[PROTO_MAX_TRAMA];
+        descartadas++;
+        tele_sumar(&tele->interfaz.tramasDescartadas, 1);
+        if (lector.pos > 0)
+            uart_escribir((const char *)trama, proto_armar(trama, proto_seq(&lector), nak, sizeof(nak)));
+        return 1;
+    }
+
+    recibidas++;
+    int n;
+    const uint8_t *carga = proto_carga(&lector, &n);
+    uint16_t crc = crc_ccitt(lector.trama, (size_t)n + 2);
+
+    // Reintento de la última trama (se perdió la respuesta): no se repite
+    if (largoRespuesta && proto_seq(&lector) == ultimoSeq && crc == ultimoCrc) {
+        uart_escribir((const char *)respuesta, largoRespuesta);
+        return 1;
+    }
+
+    // Un solo enlace: la consulta sí espera a que se apliquen sus comandos, y
+    // una velocidad nueva también, para quedar guardada antes de contestar
+    uint8_t resp[PROTO_MAX_RESPUESTA];
+    int consulta;
+    int largo = proto_ejecutar(carga, n, resp, &consulta);
+    if (consulta >= 0 || motor_guardarPendiente()) {
+        motor_esperarMarca(motor_marca());
+        motor_guardarPendiente();
+    }
+    if (consulta >= 0)
+        largo = proto_agregarEstado(resp, consulta);
+    ultimoSeq = proto_seq(&lector);
+    ultimoCrc = crc;
+    largoRespuesta = proto_armar(respuesta, ultimoSeq, resp, (size_t)largo);
+    uart_escribir((const char *)respuesta, largoRespuesta);
+    return 1;
+}
+
+unsigned long proto_tramasRecibidas(void) {
+    return recibidas;
+}
+
+unsigned long proto_tramasDescartadas(void) {
+    return descartadas;
+}
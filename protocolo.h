@@ -0,0 +1,97 @@
+#ifndef PROTOCOLO_H
+#define PROTOCOLO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Protocolo binario de control por el UART, para un controlador automático en
+// el PC. Convive con el menú de texto en el mismo serial_fd: una trama
+// empieza con STX (0x02), que no se tipea, y todo lo demás sigue siendo texto.
+//
+//   STX  largo  seq  comandos...  crc16 (alto, bajo)
+//
+// 'largo' cuenta seq + comandos (1..PROTO_MAX_CARGA) y el CRC-16/CCITT
+// (crc.h) cubre largo, seq y comandos. Una trama puede traer varios
+// comandos seguidos; se ejecutan en orden y se contesta una sola respuesta
+// con el mismo seq.
+#define PROTO_STX        0x02
+#define PROTO_MAX_CARGA  64
+#define PROTO_MAX_TRAMA  (PROTO_MAX_CARGA + 4)
+#define PROTO_TIMEOUT_MS 200   // una trama cortada más de esto se descarta
+
+// Comandos (argumentos de 16 bits en little endian)
+enum {
+    PROTO_SELECCIONAR = 0x01,   // id (16 bits), delay (0 = velocidad inicial del potenciómetro)
+    PROTO_VELOCIDAD   = 0x02,   // delay de la secuencia en curso
+    PROTO_DETENER     = 0x03,
+    PROTO_RESET       = 0x04,   // resetea las velocidades guardadas
+    PROTO_INTENSIDAD  = 0x05,   // brillo, estela
+    PROTO_CONSULTAR   = 0x06,   // agrega el estado a la respuesta
+    PROTO_PISTA       = 0x07,   // pista, grupo: a qué pista y LEDs van los que siguen
+    PROTO_PAUSAR      = 0x08,
+    PROTO_REANUDAR    = 0x09,
+    PROTO_MEZCLA      = 0x0A    // mezcla de la pista con las anteriores (COMP_OR...)
+};
+
+// Cada trama arranca sobre la pista 0 con las 8 posiciones; PROTO_PISTA
+// cambia eso para el resto de la trama (ver motor.h).
+
+// Respuesta: STX largo seq PROTO_RESPUESTA resultado ejecutados [estado]
+#define PROTO_RESPUESTA 0x80
+
+enum {
+    PROTO_OK,
+    PROTO_ERROR_CRC,         // la trama llegó dañada: no se ejecutó nada
+    PROTO_ERROR_COMANDO,     // comando desconocido o argumentos incompletos
+    PROTO_ERROR_ARGUMENTO,   // fuera de rango (id, delay) o la secuencia de audio
+    PROTO_ERROR_OCUPADO      // cola del hilo de salida llena: ese comando no se
+                             // aplicó (los 'ejecutados' anteriores sí); se
+                             // reintenta desde ahí con otro seq
+};
+
+// Estado que agrega PROTO_CONSULTAR (little endian, sin relleno en el cable)
+typedef struct {
+    int16_t  activo;          // secuencia en curso en la pista elegida o -1
+    uint16_t delayMs;         // su velocidad
+    uint8_t  brillo;
+    uint8_t  estela;
+    uint16_t cantSecuencias;  // hasta MOTOR_MAX_PROGRAMAS: no entra en un byte
+    uint32_t frames;          // frames que salieron desde que arrancó
+} protoEstado_t;
+
+#define PROTO_LARGO_ESTADO  12
+#define PROTO_MAX_RESPUESTA (3 + PROTO_LARGO_ESTADO)   // carga de la respuesta más larga
+
+// Lector incremental de tramas (sirve a los dos lados del cable)
+typedef struct {
+    uint8_t estado;
+    uint8_t pos;
+    uint8_t trama[PROTO_MAX_TRAMA];
+} protoLector_t;
+
+void     proto_lectorIniciar(protoLector_t *l);
+int      proto_leer(protoLector_t *l, uint8_t b);   // 1 trama válida, -1 CRC malo, 0 nada aún
+int      proto_enTrama(const protoLector_t *l);
+uint8_t  proto_seq(const protoLector_t *l);
+const uint8_t *proto_carga(const protoLector_t *l, int *largo);   // comandos (después de seq)
+
+size_t   proto_armar(uint8_t *dest, uint8_t seq, const uint8_t *carga, size_t n);
+void     proto_leerEstado(const uint8_t *datos, protoEstado_t *e);
+
+// Ejecuta los comandos de una trama recibida por cualquier enlace (UART o
+// control.c) y arma en 'resp' la carga de la respuesta; devuelve su largo.
+// Los comandos no esperan al hilo de salida: si la trama pidió el estado,
+// '*consulta' queda con la pista (si no, -1) y la respuesta se completa con
+// proto_agregarEstado() cuando motor_aplicado(motor_marca()) de ese momento.
+int proto_ejecutar(const uint8_t *comandos, int n, uint8_t *resp, int *consulta);
+int proto_agregarEstado(uint8_t *resp, int pista);   // nuevo largo
+
+// Lado del programa: filtro de entradaSerial. Devuelve 1 si el byte era
+// parte de una trama (no llega al decodificador de teclas); al completarla
+// ejecuta los comandos y encola la respuesta con uart_escribir().
+int proto_byte(uint8_t b);
+
+unsigned long proto_tramasRecibidas(void);
+unsigned long proto_tramasDescartadas(void);
+
+#endif
@@ -0,0 +1,130 @@
+// puente.c
+// Núcleo del puente serie (ver puente.h). Nada de Arduino acá: los puertos
+// llegan como funciones, así el mismo código corre en la placa y en la PC.
+#include "puente.h"
+
+#include <string.h>
+
+#define MASCARA (PUENTE_ANILLO - 1)
+
+#define PAUSA_LLENO 0x01   // su anillo de entrada pasó de PUENTE_ALTO
+#define PAUSA_ENVIO 0x02   // semidúplex: se le está mandando
+
+static uint16_t libres(const anilloPuente_t *a) {
+    return (uint16_t)(PUENTE_ANILLO - a->ocupados);
+}
+
+// -------------------- Entrada --------------------
+// Pasa al anillo todo lo que el puerto ya tiene, mientras entre
+static void recibir(puertoPuente_t *pt, anilloPuente_t *a, sentidoPuente_t *s) {
+    int n = pt->disponibles(pt->ctx);
+
+    while (n-- > 0 && libres(a) > 0) {
+        int b = pt->leer(pt->ctx);
+        if (b < 0)
+            break;
+        a->datos[(a->inicio + a->ocupados) & MASCARA] = (uint8_t)b;
+        a->ocupados++;
+        s->recibidos++;
+    }
+    if (a->ocupados > s->maxOcupados)
+        s->maxOcupados = a->ocupados;
+}
+
+// El RTS hacia un lado se baja por cualquiera de dos motivos y se sube
+// cuando no queda ninguno
+static void senalar(puertoPuente_t *pt, uint8_t *motivos, uint8_t motivo, uint8_t activo) {
+    uint8_t antes = *motivos;
+
+    *motivos = activo ? (uint8_t)(antes | motivo) : (uint8_t)(antes & ~motivo);
+    if (!antes != !*motivos)
+        pt->pausar(pt->ctx, *motivos != 0);
+}
+
+// Frena al lado que llena 'a' cuando se acerca a lleno
+static void regularFlujo(puente_t *p, puertoPuente_t *origen, uint8_t *motivos,
+                         const anilloPuente_t *a, sentidoPuente_t *s) {
+    if (!p->flujo || !origen->pausar)
+        return;
+
+    if (!(*motivos & PAUSA_LLENO) && a->ocupados >= PUENTE_ALTO) {
+        senalar(origen, motivos, PAUSA_LLENO, 1);
+        s->pausas++;
+    } else if ((*motivos & PAUSA_LLENO) && a->ocupados <= PUENTE_BAJO) {
+        senalar(origen, motivos, PAUSA_LLENO, 0);
+    }
+}
+
+// -------------------- Salida --------------------
+// Escribe hasta 'max' bytes del anillo en uno o dos tramos contiguos
+static void escribirAnillo(puertoPuente_t *pt, anilloPuente_t *a, int max, sentidoPuente_t *s) {
+    while (max > 0 && a->ocupados > 0) {
+        int tramo = PUENTE_ANILLO - a->inicio;
+        if (tramo > a->ocupados)
+            tramo = a->ocupados;
+        if (tramo > max)
+            tramo = max;
+
+        pt->escribir(pt->ctx, a->datos + a->inicio, tramo);
+        a->inicio = (uint16_t)((a->inicio + tramo) & MASCARA);
+        a->ocupados = (uint16_t)(a->ocupados - tramo);
+        s->enviados += (unsigned long)tramo;
+        max -= tramo;
+    }
+}
+
+static void enviar(puente_t *p, puertoPuente_t *destino, uint8_t *motivos,
+                   anilloPuente_t *a, anilloPuente_t *deDestino, sentidoPuente_t *s,
+                   sentidoPuente_t *sDeDestino) {
+    if (a->ocupados == 0 || (destino->detenido && destino->detenido(destino->ctx)))
+        return;
+
+    int max = destino->espacio(destino->ctx);
+    if (!destino->semiduplex) {
+        escribirAnillo(destino, a, max, s);
+        return;
+    }
+
+    // Semidúplex: ráfagas cortas (mientras dura una no se lee la otra
+    // entrada). Con flujo se lo frena antes de la primera y recién se lo
+    // suelta cuando no queda nada para él: lo que mande espera de su lado.
+    if (max > PUENTE_RAFAGA)
+        max = PUENTE_RAFAGA;
+
+    int frenar = p->flujo && destino->pausar;
+    if (frenar && !(*motivos & PAUSA_ENVIO)) {
+        senalar(destino, motivos, PAUSA_ENVIO, 1);
+        recibir(destino, deDestino, sDeDestino);   // lo que ya venía en camino
+    }
+    escribirAnillo(destino, a, max, s);
+    if (frenar && a->ocupados == 0)
+        senalar(destino, motivos, PAUSA_ENVIO, 0);
+}
+
+// -------------------- API --------------------
+void puente_iniciar(puente_t *p, const puertoPuente_t *pc, const puertoPuente_t *raspi, uint8_t flujo) {
+    memset(p, 0, sizeof(*p));
+    p->pc = *pc;
+    p->raspi = *raspi;
+    p->flujo = flujo;
+
+    if (flujo) {
+        if (p->pc.pausar)
+            p->pc.pausar(p->pc.ctx, 0);
+        if (p->raspi.pausar)
+            p->raspi.pausar(p->raspi.ctx, 0);
+    }
+}
+
+void puente_atender(puente_t *p) {
+    recibir(&p->pc, &p->haciaRaspi, &p->pcRaspi);
+    recibir(&p->raspi, &p->haciaPc, &p->raspiPc);
+    regularFlujo(p, &p->pc, &p->pausaPc, &p->haciaRaspi, &p->pcRaspi);
+    regularFlujo(p, &p->raspi, &p->pausaRaspi, &p->haciaPc, &p->raspiPc);
+
+    enviar(p, &p->pc, &p->pausaPc, &p->haciaPc, &p->haciaRaspi, &p->raspiPc, &p->pcRaspi);
+    enviar(p, &p->raspi, &p->pausaRaspi, &p->haciaRaspi, &p->haciaPc, &p->pcRaspi, &p->raspiPc);
+
+    regularFlujo(p, &p->pc, &p->pausaPc, &p->haciaRaspi, &p->pcRaspi);
+    regularFlujo(p, &p->raspi, &p->pausaRaspi, &p->haciaPc, &p->raspiPc);
+}
@@ -0,0 +1,67 @@
+#ifndef PUENTE_H
+#define PUENTE_H
+
+#include <stdint.h>
+
+// Núcleo del puente serie PC <-> Raspberry del Arduino (ProyectoFinalUART.ino),
+// en C común para que compile igual con avr-gcc y en Linux
+// (bench/bench_puente.c lo prueba contra líneas simuladas).
+//
+// Cada sentido tiene su anillo. En cada pasada se vacía todo lo que los
+// puertos ya recibieron (no un byte por loop()) y se manda en ráfagas de lo
+// que entre sin bloquear. Con 'flujo' el puente además maneja una señal tipo
+// RTS hacia cada lado: la baja cuando su anillo pasa de PUENTE_ALTO y la
+// vuelve a subir por debajo de PUENTE_BAJO. Hacia un puerto semidúplex (la
+// SoftwareSerial de la Raspberry, que no recibe mientras transmite) la señal
+// también lo frena mientras haya algo para escribirle.
+#define PUENTE_ANILLO 256   // bytes por sentido (potencia de 2)
+#define PUENTE_ALTO   (PUENTE_ANILLO * 3 / 4)
+#define PUENTE_BAJO   (PUENTE_ANILLO / 4)
+#define PUENTE_RAFAGA 32    // máximo por escritura a un puerto semidúplex
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int  (*disponibles)(void *ctx);              // bytes ya recibidos
+    int  (*leer)(void *ctx);
+    int  (*espacio)(void *ctx);                  // cuántos se pueden escribir sin bloquear
+    void (*escribir)(void *ctx, const uint8_t *d, int n);
+    void (*pausar)(void *ctx, uint8_t pausa);    // RTS hacia ese lado (NULL = sin señal)
+    int  (*detenido)(void *ctx);                 // su CTS: 1 = no mandarle (NULL = nunca)
+    void *ctx;
+    uint8_t semiduplex;
+} puertoPuente_t;
+
+typedef struct {
+    uint8_t  datos[PUENTE_ANILLO];
+    uint16_t inicio;
+    uint16_t ocupados;
+} anilloPuente_t;
+
+typedef struct {
+    unsigned long recibidos;
+    unsigned long enviados;
+    unsigned long pausas;       // veces que se bajó el RTS del lado que manda
+    uint16_t maxOcupados;
+} sentidoPuente_t;
+
+typedef struct {
+    puertoPuente_t pc, raspi;
+    anilloPuente_t haciaRaspi, haciaPc;
+    sentidoPuente_t pcRaspi, raspiPc;
+    uint8_t flujo;
+    uint8_t pausaPc, pausaRaspi;       // por qué está bajado el RTS hacia cada lado
+} puente_t;
+
+void puente_iniciar(puente_t *p, const puertoPuente_t *pc, const puertoPuente_t *raspi, uint8_t flujo);
+
+// Una pasada: llamarla en cada loop()
+void puente_atender(puente_t *p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,154 @@
+// reactor.c
+// Un único epoll para stdin, el UART (entrada y salida), los avisos del motor,
+// el potenciómetro y el servidor de control: el proceso queda dormido en el
+// kernel hasta que llega un byte, el UART acepta más datos o vence el
+// timeout. Los deadlines de los frames son del hilo de salida. Las fuentes con un manejador
+// (reactor_atender) se escuchan siempre y se atienden acá adentro, sin que
+// cada pantalla tenga que saber de ellas.
+#include "reactor.h"
+#include "telemetria.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+
+static int epfd = -1;
+
+// Fuentes de entrada que se pueden vigilar y el fd de cada una (-1 = sin fd)
+static const int fuentesEntrada[] = { EV_TECLADO, EV_SERIAL, EV_MOTOR, EV_ADC, EV_CONTROL };
+#define CANT_FUENTES (int)(sizeof(fuentesEntrada) / sizeof(fuentesEntrada[0]))
+static int fdFuente[CANT_FUENTES] = { STDIN_FILENO, -1, -1, -1, -1 };
+static void (*manejador[CANT_FUENTES])(void);   // NULL = la atiende quien llamó
+
+static uint32_t eventosActivos[CANT_FUENTES];  // eventos registrados en el epoll (0 = no está)
+static int fuentesPedidas = EV_TECLADO;         // fuentes que se quieren escuchar
+static int salidaSerial   = 0;                  // hay bytes esperando para salir por el UART
+static void (*antesDeEsperar)(void) = NULL;
+
+// Ajusta el epoll a las fuentes pedidas (solo hace syscalls si algo cambió)
+static void sincronizarFuentes(void) {
+    for (int i = 0; i < CANT_FUENTES; i++) {
+        int f = fuentesEntrada[i];
+        uint32_t quiere = 0;
+
+        if (fdFuente[i] >= 0) {
+            if ((fuentesPedidas & f) || manejador[i])
+                quiere |= EPOLLIN;
+            if (f == EV_SERIAL && salidaSerial)
+                quiere |= EPOLLOUT;
+        }
+        if (quiere == eventosActivos[i])
+            continue;
+
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events   = quiere;
+        ev.data.u32 = f;
+
+        int op = !quiere ? EPOLL_CTL_DEL : (eventosActivos[i] ? EPOLL_CTL_MOD : EPOLL_CTL_ADD);
+        if (epoll_ctl(epfd, op, fdFuente[i], &ev) == 0)
+            eventosActivos[i] = quiere;
+    }
+}
+
+int reactor_iniciar(void) {
+    if (epfd >= 0)
+        return 0;
+
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0)
+        return 1;
+
+    sincronizarFuentes();
+    return 0;
+}
+
+// Asocia un fd a una fuente (EV_SERIAL, EV_MOTOR, EV_ADC o EV_CONTROL); -1 la deja sin fd
+void reactor_vigilar(int fuente, int fd) {
+    if (reactor_iniciar() != 0)
+        return;
+
+    for (int i = 0; i < CANT_FUENTES; i++) {
+        if (fuentesEntrada[i] != fuente || fdFuente[i] == fd)
+            continue;
+
+        if (eventosActivos[i]) {
+            epoll_ctl(epfd, EPOLL_CTL_DEL, fdFuente[i], NULL);
+            eventosActivos[i] = 0;
+        }
+        fdFuente[i] = fd;
+        sincronizarFuentes();
+    }
+}
+
+// Elige qué entradas despiertan al reactor (EV_TECLADO, EV_SERIAL, EV_MOTOR, EV_ADC)
+void reactor_fuentes(int fuentes) {
+    fuentesPedidas = fuentes & (EV_TECLADO | EV_SERIAL | EV_MOTOR | EV_ADC);
+    if (epfd >= 0)
+        sincronizarFuentes();
+}
+
+// Pide (o deja de pedir) EV_SERIAL_TX cuando el UART vuelva a aceptar bytes
+void reactor_salidaPendiente(int pendiente) {
+    if (salidaSerial == !!pendiente)
+        return;
+    salidaSerial = !!pendiente;
+    if (epfd >= 0)
+        sincronizarFuentes();
+}
+
+// Función que se llama cada vez antes de dormir (p.ej. vaciar la cola del UART)
+void reactor_antesDeEsperar(void (*fn)(void)) {
+    antesDeEsperar = fn;
+}
+
+// La fuente queda escuchada siempre y 'fn' la atiende dentro de
+// reactor_esperar(), que no la devuelve en la máscara (NULL lo deshace)
+void reactor_atender(int fuente, void (*fn)(void)) {
+    for (int i = 0; i < CANT_FUENTES; i++)
+        if (fuentesEntrada[i] == fuente)
+            manejador[i] = fn;
+    if (epfd >= 0)
+        sincronizarFuentes();
+}
+
+// Bloquea hasta que haya entrada o pasen timeout_ms (-1 = sin límite).
+// Devuelve la máscara de EV_* ocurridos, 0 si fue por timeout o si solo hubo
+// fuentes con manejador.
+int reactor_esperar(int timeout_ms) {
+    if (reactor_iniciar() != 0)
+        return 0;
+
+    if (antesDeEsperar)
+        antesDeEsperar();
+
+    struct epoll_event evs[CANT_FUENTES];
+    int n;
+    do {
+        n = epoll_wait(epfd, evs, CANT_FUENTES, timeout_ms);
+    } while (n < 0 && errno == EINTR);
+    tele_sumar(&tele->interfaz.despertares, 1);
+
+    int ocurridos = 0;
+    for (int i = 0; i < n; i++) {
+        int f = (int)evs[i].data.u32;
+
+        if (evs[i].events & EPOLLOUT)
+            ocurridos |= EV_SERIAL_TX;
+        if (!(evs[i].events & ~(uint32_t)EPOLLOUT))
+            continue;
+
+        int atendida = 0;
+        for (int k = 0; k < CANT_FUENTES; k++) {
+            if (fuentesEntrada[k] == f && manejador[k]) {
+                manejador[k]();
+                atendida = 1;
+            }
+        }
+        if (!atendida)
+            ocurridos |= f;
+    }
+    return ocurridos;
+}
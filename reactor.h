@@ -0,0 +1,20 @@
+#ifndef REACTOR_H
+#define REACTOR_H
+
+// Fuentes de eventos del reactor
+#define EV_TECLADO  0x01   // stdin con datos
+#define EV_SERIAL   0x02   // serial_fd con datos
+#define EV_MOTOR    0x08   // aviso del hilo de salida (motor_fdAviso)
+#define EV_SERIAL_TX 0x10  // serial_fd acepta más bytes (ver uart_tx.c)
+#define EV_ADC      0x20   // el potenciómetro se movió (adc_fdCambio)
+#define EV_CONTROL  0x40   // clientes del servidor de control (control_fd)
+
+int  reactor_iniciar(void);
+void reactor_vigilar(int fuente, int fd);
+void reactor_fuentes(int fuentes);
+void reactor_salidaPendiente(int pendiente);
+void reactor_antesDeEsperar(void (*fn)(void));
+void reactor_atender(int fuente, void (*fn)(void));
+int  reactor_esperar(int timeout_ms);
+
+#endif
@@ -0,0 +1,130 @@
+// reloj.c
+#include "reloj.h"
+
+#include <errno.h>
+#include <string.h>
+
+const long reloj_limitesUs[RELOJ_CASILLEROS - 1] = {100, 250, 500, 1000, 5000};
+
+static int esVirtual = 0;
+static struct timespec virtualActual;
+
+// -------------------- Aritmética de timespec --------------------
+static void sumarMs(struct timespec *t, long ms) {
+    t->tv_sec  += ms / 1000;
+    t->tv_nsec += (ms % 1000) * 1000000L;
+    if (t->tv_nsec >= 1000000000L) {
+        t->tv_nsec -= 1000000000L;
+        t->tv_sec++;
+    }
+}
+
+static long long difUs(const struct timespec *a, const struct timespec *b) {
+    return (long long)(a->tv_sec - b->tv_sec) * 1000000LL + (a->tv_nsec - b->tv_nsec) / 1000;
+}
+
+static int antes(const struct timespec *a, const struct timespec *b) {
+    return a->tv_sec < b->tv_sec || (a->tv_sec == b->tv_sec && a->tv_nsec < b->tv_nsec);
+}
+
+static long registrarAtraso(relojFrames_t *r, long atraso) {
+    if (atraso < 0)
+        atraso = 0;
+
+    r->frames++;
+    r->atrasoTotalUs += atraso;
+    if (atraso > r->atrasoMaxUs)
+        r->atrasoMaxUs = atraso;
+
+    int i = 0;
+    while (i < RELOJ_CASILLEROS - 1 && atraso >= reloj_limitesUs[i])
+        i++;
+    r->histograma[i]++;
+    return atraso;
+}
+
+// -------------------- Hora --------------------
+void reloj_ahora(struct timespec *t) {
+    if (esVirtual)
+        *t = virtualActual;
+    else
+        clock_gettime(CLOCK_MONOTONIC, t);
+}
+
+long reloj_ms(void) {
+    struct timespec t;
+    reloj_ahora(&t);
+    return t.tv_sec * 1000L + t.tv_nsec / 1000000L;
+}
+
+void reloj_usarVirtual(void) {
+    memset(&virtualActual, 0, sizeof(virtualActual));
+    esVirtual = 1;
+}
+
+int reloj_esVirtual(void) {
+    return esVirtual;
+}
+
+void reloj_fijarVirtual(const struct timespec *t) {
+    if (antes(&virtualActual, t))
+        virtualActual = *t;
+}
+
+// -------------------- API --------------------
+void reloj_iniciar(relojFrames_t *r) {
+    memset(r, 0, sizeof(*r));
+    reloj_ahora(&r->proximo);
+}
+
+// Fija el vencimiento del próximo frame a periodo_ms del anterior (no de "ahora").
+// Si el programa estuvo parado más de un periodo se resincroniza en vez de
+// disparar una ráfaga de frames atrasados.
+void reloj_programar(relojFrames_t *r, int periodo_ms) {
+    struct timespec ahora;
+    reloj_ahora(&ahora);
+
+    sumarMs(&r->proximo, periodo_ms);
+
+    if (difUs(&ahora, &r->proximo) > (long long)periodo_ms * 1000LL) {
+        r->proximo = ahora;
+        sumarMs(&r->proximo, periodo_ms);
+        r->resincronizaciones++;
+    }
+}
+
+// Duerme hasta el vencimiento o, como máximo, max_ms (para atender entradas).
+// Devuelve 1 si el frame venció (y registra su atraso), 0 si solo pasó max_ms.
+int reloj_esperar(relojFrames_t *r, int max_ms) {
+    struct timespec ahora, hasta;
+    reloj_ahora(&ahora);
+
+    hasta = ahora;
+    sumarMs(&hasta, max_ms);
+    int esVencimiento = !antes(&hasta, &r->proximo);
+    if (esVencimiento)
+        hasta = r->proximo;
+
+    if (esVirtual)
+        reloj_fijarVirtual(&hasta);
+    else
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &hasta, NULL) == EINTR)
+            ;
+
+    if (!esVencimiento)
+        return 0;
+
+    reloj_marcarVencimiento(r);
+    return 1;
+}
+
+// Registra el atraso del frame cuando la espera la hizo otro (p.ej. el reactor)
+long reloj_marcarVencimiento(relojFrames_t *r) {
+    struct timespec ahora;
+    reloj_ahora(&ahora);
+    return registrarAtraso(r, (long)difUs(&ahora, &r->proximo));
+}
+
+long reloj_atrasoPromedioUs(const relojFrames_t *r) {
+    return r->frames ? (long)(r->atrasoTotalUs / r->frames) : 0;
+}
@@ -0,0 +1,38 @@
+#ifndef RELOJ_H
+#define RELOJ_H
+
+#include <time.h>
+
+// Límites (us) de los casilleros del histograma de atraso por frame
+#define RELOJ_CASILLEROS 6
+extern const long reloj_limitesUs[RELOJ_CASILLEROS - 1];
+
+// Reloj de frames: cada frame vence en un instante absoluto de CLOCK_MONOTONIC,
+// así el tiempo de trabajo entre frames no se acumula como deriva.
+typedef struct {
+    struct timespec proximo;        // vencimiento absoluto del frame en curso
+    long frames;                    // frames vencidos
+    long atrasoMaxUs;               // peor atraso observado
+    long long atrasoTotalUs;        // para el promedio
+    long histograma[RELOJ_CASILLEROS];
+    long resincronizaciones;        // veces que se perdió más de un periodo
+} relojFrames_t;
+
+// Hora de los relojes de frames, del hilo de salida y de los límites de la
+// interfaz: CLOCK_MONOTONIC o, después de reloj_usarVirtual(), un reloj
+// virtual que arranca en 0 y solo avanza con reloj_fijarVirtual() o cuando
+// alguien "duerme" con reloj_esperar(). Con el virtual el motor corre sin
+// hilo (motor_iniciarVirtual) tan rápido como dé la CPU.
+void reloj_ahora(struct timespec *t);
+long reloj_ms(void);
+void reloj_usarVirtual(void);
+int  reloj_esVirtual(void);
+void reloj_fijarVirtual(const struct timespec *t);   // solo hacia adelante
+
+void reloj_iniciar(relojFrames_t *r);
+void reloj_programar(relojFrames_t *r, int periodo_ms);
+int  reloj_esperar(relojFrames_t *r, int max_ms);
+long reloj_marcarVencimiento(relojFrames_t *r);   // devuelve el atraso (us)
+long reloj_atrasoPromedioUs(const relojFrames_t *r);
+
+#endif
@@ -1,465 +1,289 @@
 // secuencias.c
 #include "secuencias.h"
 #include "nocanonico.h"
+#include "gpio_hal.h"
+#include "motor.h"
+#include "reactor.h"
+#include "biblioteca.h"
+#include "tablas.h"
+#include "decodificador.h"
+#include "adc.h"
+#include "pantalla.h"
+#include "estado.h"
+#include "telemetria.h"
+#include "audio.h"
 
 #include <wiringPi.h>
-#include <wiringSerial.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <termios.h>
-#include <errno.h>
 #include <string.h>
+#include <stdint.h>
 
-// Variables definidas en main.c (compartidas porque se incluye este .c allí)
-extern int serial_fd;
+// Variable definida en main.c (compartida porque se incluye este .c allí)
 extern int modoRemoto;
 
 // -------------------- Parámetros globales de control de velocidad --------------------
 const int pasoDelay      = 50;    // Paso de ajuste (ms)
 const int delayMin       = 50;    // Límite inferior (más rápido)
 const int delayMax       = 2000;  // Límite superior (más lento)
-const int pasoSubDelay   = 10;    // Paso de subdelay (ms) para respuesta rápida
-
-// Velocidades guardadas por secuencia (persisten entre llamadas)
-static int vel_auto      = 0;
-static int vel_choque    = 0;
-static int vel_apilada   = 0;
-static int vel_carrera   = 0;
-static int vel_binario   = 0;
-static int vel_danza     = 0;
-static int vel_firstinfirstoff  = 0;
-static int vel_escalera  = 0;
+
+// Intensidad (ver bam.h): brillo de 0 a MOTOR_BRILLO_MAX y estela en medios delays
+const int pasoBrillo     = 32;
+const int brilloMin      = 15;
+const int estelaMax      = 16;    // 'e' recorre 0, 2, 4, 8, 16
+
+// Las velocidades guardadas por secuencia (antes vel_auto, vel_choque, ...) las
+// mantiene el hilo de salida; se leen sin locks con motor_velocidad(SEC_*).
 
 // Definición de LEDs
 const unsigned char LEDS[8] = {23, 24, 25, 12, 16, 20, 21, 26};
 
-// Tablas de secuencias
-// "La carrera" (tabla de datos)
-const unsigned char carrera[][8] = {
-    {1,0,0,0,0,0,0,0}, {0,1,0,0,0,0,0,0}, {0,0,1,0,0,0,0,0},
-    {1,0,0,1,0,0,0,0}, {0,1,0,0,1,0,0,0}, {0,0,1,0,1,0,0,0},
-    {0,0,0,1,0,1,0,0}, {0,0,0,0,1,1,0,0}, {0,0,0,0,0,1,1,0},
-    {0,0,0,0,0,0,1,0}, {0,0,0,0,0,0,0,1}
-};
-
-// "El choque" (tabla de datos)
-const unsigned char choque[][8] = {
-    {1,0,0,0,0,0,0,1}, {0,1,0,0,0,0,1,0}, {0,0,1,0,0,1,0,0},
-    {0,0,0,1,1,0,0,0}, {0,0,0,1,1,0,0,0}, {0,0,1,0,0,1,0,0},
-    {0,1,0,0,0,0,1,0}, {1,0,0,0,0,0,0,1}
-};
-
-// "Salto intermedio" (tabla de datos: LED de por medio)
-const unsigned char danza[][8] = {
-    {0,0,1,1,0,0,1,1},
-    {1,1,0,0,1,1,0,0},
-    {0,0,1,1,1,1,0,0},
-    {1,1,0,0,0,0,1,1},
-    {1,1,1,1,1,1,1,1},
-    {1,1,0,0,0,0,1,1},
-    {0,0,1,1,1,1,0,0},
-    {1,1,0,0,1,1,0,0},
-    {0,0,1,1,0,0,1,1},
-};
-
-// "Escalera central" (tabla de datos: se llena hacia el centro y vuelve)
-const unsigned char escaleraCentral[][8] = {
-    {0,0,0,0,0,0,0,0},
-    {1,0,0,0,0,0,0,1},
-    {1,1,0,0,0,0,1,1},
-    {1,1,1,0,0,1,1,1},
-    {1,1,1,1,1,1,1,1},
-    {1,1,1,0,0,1,1,1},
-    {1,1,0,0,0,0,1,1},
-    {1,0,0,0,0,0,0,1}
-};
-
-const int cantEstados_Carrera          = sizeof(carrera) / sizeof(carrera[0]);
-const int cantEstados_Choque           = sizeof(choque) / sizeof(choque[0]);
-const int cantEstados_Danza            = sizeof(danza) / sizeof(danza[0]);
-const int cantEstados_EscaleraCentral  = sizeof(escaleraCentral) / sizeof(escaleraCentral[0]);
-
-// Funciones auxiliares
-
-static void apagarLeds(void) {
-    for (int i = 0; i < 8; i++)
-        digitalWrite(LEDS[i], LOW);
-}
-
-static void aplicarEstado(const unsigned char frame[8]) {
-    for (int j = 0; j < 8; j++)
-        digitalWrite(LEDS[j], frame[j]);
-}
+// Programas registrados en el motor (descriptores; los pasos pueden vivir en el mmap)
+static programa_t programas[MOTOR_MAX_PROGRAMAS];
+static int cantProgramas = 0;
+static int idAudio = -1;                 // el programa vivo de audio.h, después de la biblioteca
+static const char *fuenteAudio = NULL;   // NULL = ALSA "default"
 
 // Maneja teclado o UART:
 // - LOCAL: flechas ↑/↓ ajustan delay, 'q' sale.
 // - REMOTO: flechas ↑/↓ (enviadas por el terminal) ajustan delay, 'q' sale.
+// - En los dos: ←/→ cambian el brillo, 'e' la estela y 'p' pausa.
+// Ambos lados se leen de a bloques con el mismo decodificador, así una flecha
+// que llega partida por el puente Arduino no se pierde.
 static int manejarTeclado(struct termios *orig_t, int orig_flags, int *delay_ms) {
-    char c;
-    ssize_t n;
-
-    // MODO LOCAL
-    if (!modoRemoto) {
-        static unsigned int ultimoCambioTiempo = 0;
-        const unsigned int intervaloTiempo = 80; // ms mínimos entre cambios grandes
-
-        while (1) {
-            n = read(STDIN_FILENO, &c, 1);
-
-            if (n == -1) {
-                if (errno == EAGAIN || errno == EWOULDBLOCK)
-                    break; // No hay más datos
-                else
-                    break; // Otro error
-            } else if (n == 0) {
-                break; // EOF o sin datos
-            }
-
-            // Salir con 'q'
-            if (c == 'q' || c == 'Q') {
-                restaurarTerminal(orig_t, orig_flags);
-                apagarLeds();
-                return 1;
-            }
-
-            // Flechas ESC [ A / ESC [ B
-            if (c == 27) { // ESC
-                char seq[2];
-                ssize_t n1 = read(STDIN_FILENO, &seq[0], 1);
-                ssize_t n2 = read(STDIN_FILENO, &seq[1], 1);
-
-                if (n1 == 1 && n2 == 1 && seq[0] == '[') {
-                    unsigned int tiempoActual = millis();
-                    if (tiempoActual - ultimoCambioTiempo < intervaloTiempo) {
-                        continue;
-                    }
-                    ultimoCambioTiempo = tiempoActual;
-
-                    if (seq[1] == 'A') {        // flecha arriba
-                        *delay_ms -= pasoDelay;
-                        if (*delay_ms < delayMin)
-                            *delay_ms = delayMin;
-                    } else if (seq[1] == 'B') { // flecha abajo
-                        *delay_ms += pasoDelay;
-                        if (*delay_ms > delayMax)
-                            *delay_ms = delayMax;
-                    }
-                }
-            }
-        }
+    const long intervaloTiempo = 80; // ms mínimos entre cambios grandes
+    static long ultimoCambioTiempo = -80;
 
-        return 0;
-    }
-
-    // MODO REMOTO (PC via UART)
-    if (serial_fd < 0)
-        return 0;
+    entrada_t *e = modoRemoto ? &entradaSerial : &entradaTeclado;
+    tecla_t t;
 
-    static unsigned int ultimoCambioTiempo_Remoto = 0;
-    const unsigned int intervaloTiempo_Remoto = 80;
+    while (entrada_siguiente(e, &t) > 0) {
+        tele_sumar(&tele->interfaz.teclas, 1);
 
-    while (serialDataAvail(serial_fd)) {
-        c = (char)serialGetchar(serial_fd);
-
-        if (c == 'q' || c == 'Q') {
+        // Salir con 'q'
+        if (t.tipo == TEC_CARACTER && (t.c == 'q' || t.c == 'Q')) {
             restaurarTerminal(orig_t, orig_flags);
-            apagarLeds();
             return 1;
         }
 
-        if (c == 27) { // ESC
-            char seq[2];
-            // Intentamos leer los siguientes dos bytes si están disponibles
-            ssize_t n1 = 0, n2 = 0;
-            if (serialDataAvail(serial_fd)) {
-                seq[0] = (char)serialGetchar(serial_fd);
-                n1 = 1;
-            }
-            if (serialDataAvail(serial_fd)) {
-                seq[1] = (char)serialGetchar(serial_fd);
-                n2 = 1;
-            }
-
-            if (n1 == 1 && n2 == 1 && seq[0] == '[') {
-                unsigned int tiempoActual = millis();
-                if (tiempoActual - ultimoCambioTiempo_Remoto < intervaloTiempo_Remoto) {
-                    continue;
-                }
-                ultimoCambioTiempo_Remoto = tiempoActual;
-
-                if (seq[1] == 'A') {        // flecha arriba
-                    *delay_ms -= pasoDelay;
-                    if (*delay_ms < delayMin)
-                        *delay_ms = delayMin;
-                } else if (seq[1] == 'B') { // flecha abajo
-                    *delay_ms += pasoDelay;
-                    if (*delay_ms > delayMax)
-                        *delay_ms = delayMax;
-                }
-            }
+        // ←/→ brillo y 'e' estela: el hilo de salida pasa a BAM si hace falta
+        if (t.tipo == TEC_IZQUIERDA || t.tipo == TEC_DERECHA) {
+            int brillo = motor_brillo() + (t.tipo == TEC_DERECHA ? pasoBrillo : -pasoBrillo);
+            if (brillo < brilloMin)
+                brillo = brilloMin;
+            motor_configurarIntensidad(brillo, motor_estela());
+            continue;
         }
-    }
-
-    return 0;
-}
-
-// Espera con subdelays para respuesta inmediata al teclado
-static int delayInteligente(int total_ms, struct termios *orig_t, int orig_flags, int *delay_ms) {
-    if (total_ms < pasoSubDelay)
-        total_ms = pasoSubDelay;
-
-    // Para remoto: solo actualiza cuando cambia y evita spamear el UART
-    int ultimaVelocidadMostrada = -1;
-
-    for (int t = 0; t < total_ms; t += pasoSubDelay) {
-
-        if (!modoRemoto) {
-            printf("\rDelay secuencia: %d ms - Velocidad secuencia: %.2f Hz   ", *delay_ms, 1000.0 / (double)(*delay_ms));
-            fflush(stdout);
+        // 'p' pausa y retoma en el mismo paso
+        if (t.tipo == TEC_CARACTER && (t.c == 'p' || t.c == 'P')) {
+            if (motor_pausada(0))
+                motor_reanudar(0);
+            else
+                motor_pausar(0);
+            continue;
         }
-
-        // En modo remoto, imprimir UNA sola vez por delayInteligente o cuando cambie
-        if (modoRemoto && serial_fd >= 0) {
-            if (*delay_ms != ultimaVelocidadMostrada) {
-                char msg[64];
-                snprintf(msg, sizeof(msg),"\rDelay secuencia: %d ms - Velocidad secuencia: %.2f Hz   ", *delay_ms, 1000.0 / (double)(*delay_ms));
-                serialPuts(serial_fd, msg);
-                ultimaVelocidadMostrada = *delay_ms;
-            }
+        if (t.tipo == TEC_CARACTER && (t.c == 'e' || t.c == 'E')) {
+            int estela = motor_estela() ? motor_estela() * 2 : 2;
+            motor_configurarIntensidad(motor_brillo(), estela > estelaMax ? 0 : estela);
+            continue;
         }
 
-        if (manejarTeclado(orig_t, orig_flags, delay_ms))
-            return 1; // salir
-
-        delay(pasoSubDelay);
-    }
-    return 0;
-}
-
-// Ejecutar tablas de datos
-static int ejecutarSecuenciaTabla(const unsigned char seq[][8], int n_frames, int *delayGuardado, int delayInicial) {
-    struct termios orig_t;
-    int orig_flags;
-
-    if (setup_nocanonico_nobloq(&orig_t, &orig_flags) != 0)
-        return 1;
-
-    int delay_ms = (*delayGuardado > 0) ? *delayGuardado : delayInicial;
-
-    while (1) {
-        for (int i = 0; i < n_frames; i++) {
-            aplicarEstado(seq[i]);
-
-            if (delayInteligente(delay_ms, &orig_t, orig_flags, &delay_ms)) {
-                *delayGuardado = delay_ms;
-                return 0;
-            }
+        if (t.tipo != TEC_ARRIBA && t.tipo != TEC_ABAJO)
+            continue;
+
+        long tiempoActual = reloj_ms();   // virtual si se está simulando
+        if (tiempoActual - ultimoCambioTiempo < intervaloTiempo)
+            continue;
+        ultimoCambioTiempo = tiempoActual;
+
+        if (t.tipo == TEC_ARRIBA) {        // flecha arriba
+            *delay_ms -= pasoDelay;
+            if (*delay_ms < delayMin)
+                *delay_ms = delayMin;
+        } else {                           // flecha abajo
+            *delay_ms += pasoDelay;
+            if (*delay_ms > delayMax)
+                *delay_ms = delayMax;
         }
     }
 
-    *delayGuardado = delay_ms;
-    restaurarTerminal(&orig_t, orig_flags);
-    apagarLeds();
     return 0;
 }
 
-// -------------------- Secuencia 1: Auto fantástico --------------------
-int runAutoFantastico(int delayInicial) {
-    struct termios orig_t;
-    int orig_flags;
-
-    if (setup_nocanonico_nobloq(&orig_t, &orig_flags) != 0)
-        return 1;
-
-    int delay_ms = (vel_auto > 0) ? vel_auto : delayInicial;
-    int indice = 0, direccion = 1;
+// Fila de estado debajo del título que deja armado main.c
+#define FILA_ESTADO 3
 
-    while (1) {
+static void mostrarVelocidad(int delay_ms, uint8_t frame) {
+    if (!modoRemoto) {
+        // En la terminal local también se ve el estado de los LEDs
+        char leds[9];
         for (int j = 0; j < 8; j++)
-            digitalWrite(LEDS[j], (j == indice) ? HIGH : LOW);
+            leds[j] = (frame >> j) & 1 ? '*' : '.';
+        leds[8] = '\0';
 
-        if (delayInteligente(delay_ms, &orig_t, orig_flags, &delay_ms)) {
-            vel_auto = delay_ms;
-            return 0;
-        }
-
-        indice += direccion;
-        if (indice == 7 || indice == 0)
-            direccion = -direccion;
+        pantalla_estado(FILA_ESTADO, "Delay secuencia: %d ms - Velocidad secuencia: %.2f Hz  [%s]", delay_ms, 1000.0 / (double)(delay_ms), leds);
+    } else {
+        pantalla_estado(FILA_ESTADO, "Delay secuencia: %d ms - Velocidad secuencia: %.2f Hz", delay_ms, 1000.0 / (double)(delay_ms));
+    }
+    pantalla_estado(FILA_ESTADO + 1, "Brillo: %d%% - Estela: %d%s", motor_brillo() * 100 / MOTOR_BRILLO_MAX, motor_estela(),
+                    motor_pausada(0) ? " - EN PAUSA" : "");
+
+    if (audio_activo()) {
+        estadAudio_t ea;
+        audio_estadisticas(&ea);
+        pantalla_estado(FILA_ESTADO + 2, "Audio: %d Hz - latencia max %.1f ms - CPU %.1f%% - golpes %ld",
+                        ea.hz, ea.latenciaUsMax / 1000.0, ea.cpu * 100, ea.golpes);
     }
-
-    vel_auto = delay_ms;
-    restaurarTerminal(&orig_t, orig_flags);
-    apagarLeds();
-    return 0;
-}
-
-// -------------------- Secuencia 2: El choque --------------------
-int runChoque(int delayInicial) {
-    return ejecutarSecuenciaTabla(choque, cantEstados_Choque, &vel_choque, delayInicial);
 }
 
-// -------------------- Secuencia 3: La apilada --------------------
-int runApilada(int delayInicial) {
+// Lanza la secuencia en el hilo de salida y atiende teclado/UART hasta 'q' o
+// hasta que la secuencia termine sola. Acá ya no se mide ni se espera el frame:
+// la terminal y el UART pueden tardar lo que quieran sin estirar los LEDs.
+static int atenderPrograma(int id, int delayInicial) {
     struct termios orig_t;
     int orig_flags;
 
     if (setup_nocanonico_nobloq(&orig_t, &orig_flags) != 0)
         return 1;
 
-    int delay_ms = (vel_apilada > 0) ? vel_apilada : delayInicial;
-    unsigned char estado[8] = {0};
-    int apilados = 0;
+    reactor_fuentes((modoRemoto ? EV_SERIAL : EV_TECLADO) | EV_MOTOR | EV_ADC);
+    adc_consumirCambio();
+    motor_reproducir(id, delayInicial);
 
-    while (apilados < 8) {
-        int destino = 7 - apilados;
+    int delay_ms = motor_velocidad(id);
+    frameInfo_t fi;
+    motor_leerFrame(&fi);
+    mostrarVelocidad(delay_ms, fi.frame);
 
-        for (int pos = 0; pos <= destino; pos++) {
-            if (delayInteligente(delay_ms, &orig_t, orig_flags, &delay_ms)) {
-                vel_apilada = delay_ms;
+    while (1) {
+        // En local se refresca la fila de LEDs hasta 10 veces por segundo; si
+        // quedó un estado sin dibujar por el límite de ritmo, se despierta antes
+        int espera = modoRemoto ? -1 : 100;
+        int pendiente = pantalla_refrescar();
+        if (pendiente >= 0 && (espera < 0 || pendiente < espera))
+            espera = pendiente;
+
+        int ev = reactor_esperar(espera);
+        uint64_t despertar = tele_ahoraNs();
+        motor_guardarEstado();   // lo que cambió el hilo de salida desde la vuelta anterior
+
+        if (ev & (EV_TECLADO | EV_SERIAL)) {
+            int anterior = delay_ms;
+
+            if (manejarTeclado(&orig_t, orig_flags, &delay_ms)) {
+                motor_detener();
+                estado_sincronizar();   // la velocidad que quedó, ya en el archivo
                 return 0;
             }
+            if (delay_ms != anterior)
+                motor_cambiarVelocidad(delay_ms);
+            else
+                delay_ms = motor_velocidad(id);   // pudo cambiarla una trama binaria
+            tele_registrar(&tele->interfaz.entrada, (long)((tele_ahoraNs() - despertar) / 1000));
+            mostrarVelocidad(delay_ms, fi.frame);
+        }
 
-            for (int j = 0; j < 8; j++) {
-                if (estado[j])
-                    digitalWrite(LEDS[j], HIGH);
-                else if (j == pos)
-                    digitalWrite(LEDS[j], HIGH);
-                else
-                    digitalWrite(LEDS[j], LOW);
+        // Girar el potenciómetro durante la secuencia también cambia la velocidad
+        if (ev & EV_ADC) {
+            adc_consumirCambio();
+            int nuevo = adc_delay();
+            if (nuevo < delayMin)
+                nuevo = delayMin;
+            if (nuevo > delayMax)
+                nuevo = delayMax;
+            if (nuevo != delay_ms) {
+                delay_ms = nuevo;
+                motor_cambiarVelocidad(delay_ms);
+                mostrarVelocidad(delay_ms, fi.frame);
             }
         }
 
-        for (int k = 0; k < 4; k++) {
-            if (delayInteligente(delay_ms / 2, &orig_t, orig_flags, &delay_ms)) {
-                vel_apilada = delay_ms;
-                return 0;
-            }
+        if (ev & EV_MOTOR)
+            motor_consumirAviso();
 
-            for (int j = 0; j < 8; j++) {
-                if (estado[j])
-                    digitalWrite(LEDS[j], HIGH);
-                else if (j == destino)
-                    digitalWrite(LEDS[j], (k % 2 == 0) ? HIGH : LOW);
-                else
-                    digitalWrite(LEDS[j], LOW);
-            }
+        // Terminó sola (p.ej. la apilada), o una trama del UART o de un
+        // cliente de control eligió otra secuencia o la detuvo
+        if (motor_activo() != id) {
+            restaurarTerminal(&orig_t, orig_flags);
+            motor_guardarEstado();
+            estado_sincronizar();
+            return 0;
         }
 
-        estado[destino] = 1;
-        apilados++;
+        if (!modoRemoto && motor_leerFrame(&fi))
+            mostrarVelocidad(delay_ms, fi.frame);
     }
-
-    for (int j = 0; j < 8; j++)
-        digitalWrite(LEDS[j], HIGH);
-    delay(1000);
-
-    vel_apilada = delay_ms;
-    restaurarTerminal(&orig_t, orig_flags);
-    apagarLeds();
-    return 0;
 }
 
-// -------------------- Secuencia 4: La carrera --------------------
-int runCarrera(int delayInicial) {
-    return ejecutarSecuenciaTabla(carrera, cantEstados_Carrera, &vel_carrera, delayInicial);
-}
-
-// -------------------- Secuencia 5: Binario completo --------------------
-int runBinarioCompleto(int delayInicial) {
-    struct termios orig_t;
-    int orig_flags;
-    if (setup_nocanonico_nobloq(&orig_t, &orig_flags) != 0)
+// El de audio además necesita su hilo de captura mientras se reproduce: 1 si
+// no hay entrada (sin ALSA y sin .wav en secuencias_fuenteAudio)
+int runPrograma(int id, int delayInicial) {
+    if (id < 0 || id >= cantProgramas)
+        return 1;
+    if (id == idAudio && audio_iniciar(fuenteAudio, idAudio) != 0)
         return 1;
 
-    int delay_ms = (vel_binario > 0) ? vel_binario : delayInicial;
-    unsigned char frame[8];
-
-    while (1) {
-        for (unsigned int val = 0; val < 256; val++) {
-            for (int j = 0; j < 8; j++)
-                frame[j] = (val >> j) & 1;
+    int r = atenderPrograma(id, delayInicial);
+    audio_cerrar();
+    return r;
+}
 
-            aplicarEstado(frame);
+// El programa de audio va último, después de las de la biblioteca
+static void registrarAudio(void) {
+    programas[cantProgramas] = *audio_programa();
+    motor_registrar(&programas[cantProgramas]);
+    idAudio = cantProgramas++;
+}
 
-            if (delayInteligente(delay_ms, &orig_t, orig_flags, &delay_ms)) {
-                vel_binario = delay_ms;
-                return 0;
+// Registra las secuencias en el motor en el orden del menú (SEC_*). Si la
+// biblioteca compilada existe y trae al menos las 8 de siempre se usa tal cual
+// desde el mmap; si no, las incorporadas, que ya vienen expandidas en
+// tablas_generadas.c desde la compilación.
+int secuencias_iniciar(const char *rutaBiblioteca) {
+    if (rutaBiblioteca && biblioteca_abrir(rutaBiblioteca) == 0) {
+        if (biblioteca_cantidad() >= SEC_CANTIDAD) {
+            int n = biblioteca_cantidad();
+            if (n > MOTOR_MAX_PROGRAMAS - 1)
+                n = MOTOR_MAX_PROGRAMAS - 1;
+
+            for (int i = 0; i < n; i++) {
+                biblioteca_programa(i, &programas[i]);
+                motor_registrar(&programas[i]);
             }
+            cantProgramas = n;
+            registrarAudio();
+            return cantProgramas;
         }
+        biblioteca_cerrar();
     }
 
-    vel_binario = delay_ms;
-    restaurarTerminal(&orig_t, orig_flags);
-    apagarLeds();
-    return 0;
+    for (int i = 0; i < cantTablasGeneradas; i++) {
+        programas[i] = tablasGeneradas[i];
+        motor_registrar(&programas[i]);
+    }
+    cantProgramas = cantTablasGeneradas;
+    registrarAudio();
+    return cantProgramas;
 }
 
-// -------------------- Secuencia 6: Salto intermedio --------------------
-int runDanza(int delayInicial) {
-    return ejecutarSecuenciaTabla(danza, cantEstados_Danza, &vel_danza, delayInicial);
+int secuencias_idAudio(void) {
+    return idAudio;
 }
 
-// -------------------- Secuencia 7: FOFO (First On, First Off) --------------------
-int runFirstOnFirstOff(int delayInicial) {
-    struct termios orig_t;
-    int orig_flags;
-    if (setup_nocanonico_nobloq(&orig_t, &orig_flags) != 0)
-        return 1;
-
-    int delay_ms = (vel_firstinfirstoff > 0) ? vel_firstinfirstoff : delayInicial;
-
-    while (1) {
-        for (int i = 0; i < 8; i++) { // Encendido progresivo
-            // Enciende los LEDs desde el primero hasta el actual
-            for (int j = 0; j <= i; j++)
-                digitalWrite(LEDS[j], HIGH);
-            // Asegura que los siguientes permanezcan apagados
-            for (int j = i + 1; j < 8; j++)
-                digitalWrite(LEDS[j], LOW);
-
-            if (delayInteligente(delay_ms, &orig_t, orig_flags, &delay_ms)) {
-                vel_firstinfirstoff = delay_ms;
-                return 0;
-            }
-        }
-
-        delay(delay_ms);
-
-        for (int i = 0; i < 8; i++) { // Apagado progresivo
-            // Apaga los LEDs desde el primero hasta el actual
-            for (int j = 0; j <= i; j++)
-                digitalWrite(LEDS[j], LOW);
-            // Mantiene los siguientes encendidos hasta apagarlos después
-            for (int j = i + 1; j < 8; j++)
-                digitalWrite(LEDS[j], HIGH);
-
-            if (delayInteligente(delay_ms, &orig_t, orig_flags, &delay_ms)) {
-                vel_firstinfirstoff = delay_ms;
-                return 0;
-            }
-        }
-    }
+void secuencias_fuenteAudio(const char *fuente) {
+    fuenteAudio = fuente;
+}
 
-    vel_firstinfirstoff = delay_ms;
-    restaurarTerminal(&orig_t, orig_flags);
-    apagarLeds();
-    return 0;
+int secuencias_cantidad(void) {
+    return cantProgramas;
 }
 
-// -------------------- Secuencia 8: Escalera central --------------------
-int runEscaleraCentral(int delayInicial) {
-    return ejecutarSecuenciaTabla(escaleraCentral, cantEstados_EscaleraCentral, &vel_escalera, delayInicial);
+const char *secuencias_nombre(int id) {
+    return (id >= 0 && id < cantProgramas) ? programas[id].nombre : "";
 }
 
 // -------------------- Reset de velocidades --------------------
 void resetVelocidades(void) {
-    vel_auto      = 0;
-    vel_choque    = 0;
-    vel_apilada   = 0;
-    vel_carrera   = 0;
-    vel_binario   = 0;
-    vel_danza     = 0;
-    vel_firstinfirstoff  = 0;
-    vel_escalera  = 0;
+    motor_resetVelocidades();
 }
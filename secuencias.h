@@ -3,14 +3,28 @@
 
 extern const unsigned char LEDS[8];
 
-int runAutoFantastico(int delayInicial);
-int runChoque(int delayInicial);
-int runApilada(int delayInicial);
-int runCarrera(int delayInicial);
-int runBinarioCompleto(int delayInicial);
-int runDanza(int delayInicial);
-int runFirstOnFirstOff(int delayInicial);
-int runEscaleraCentral(int delayInicial);
+// Identificadores de secuencia (mismo orden que el menú)
+enum {
+    SEC_AUTO,
+    SEC_CHOQUE,
+    SEC_APILADA,
+    SEC_CARRERA,
+    SEC_BINARIO,
+    SEC_DANZA,
+    SEC_FOFO,
+    SEC_ESCALERA,
+    SEC_CANTIDAD
+};
+
+int secuencias_iniciar(const char *rutaBiblioteca);
+int secuencias_cantidad(void);
+const char *secuencias_nombre(int id);
+int runPrograma(int id, int delayInicial);
+
+// Luces al ritmo de la música (audio.h): un programa más, registrado después
+// de los de la biblioteca. La fuente es un .wav o un dispositivo ALSA.
+int  secuencias_idAudio(void);
+void secuencias_fuenteAudio(const char *fuente);
 
 void resetVelocidades(void);
 
@@ -0,0 +1,43 @@
+// pcf8591.c (simulado)
+// El potenciómetro del canal 0 se toma de LUCES_POT (0..255, 128 si no está).
+// Si LUCES_POT es la ruta de un archivo, se relee en cada muestra: así se puede
+// "girar" desde otra terminal con echo 200 > archivo.
+#include "pcf8591.h"
+#include "wiringPi.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static int leerCanal(int canal) {
+    const char *pot = getenv("LUCES_POT");
+    int valor = 128;
+
+    if (canal != 0)
+        return 0;
+
+    if (pot) {
+        char *fin;
+        long v = strtol(pot, &fin, 10);
+        if (*fin == '\0') {
+            valor = (int)v;
+        } else {
+            FILE *f = fopen(pot, "r");
+            if (f) {
+                if (fscanf(f, "%d", &valor) != 1)
+                    valor = 128;
+                fclose(f);
+            }
+        }
+    }
+
+    if (valor < 0)
+        valor = 0;
+    if (valor > 255)
+        valor = 255;
+    return valor;
+}
+
+int pcf8591Setup(int pinBase, int i2cAddress) {
+    (void)i2cAddress;
+    return sim_nodoAnalogico(pinBase, 4, leerCanal) == 0;
+}
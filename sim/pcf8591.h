@@ -0,0 +1,6 @@
+#ifndef PCF8591_H
+#define PCF8591_H
+
+int pcf8591Setup(int pinBase, int i2cAddress);
+
+#endif
@@ -0,0 +1,79 @@
+// wiringPi.c (simulado)
+// GPIO en memoria, reloj de millis() con CLOCK_MONOTONIC y lecturas analógicas
+// despachadas a los nodos registrados (p.ej. el PCF8591 simulado).
+#include "wiringPi.h"
+
+#include <time.h>
+#include <errno.h>
+
+#define MAX_GPIO 64
+#define MAX_NODOS 4
+
+typedef struct {
+    int base;
+    int cantPines;
+    int (*leer)(int canal);
+} nodoAnalogico_t;
+
+static unsigned char niveles[MAX_GPIO];
+static unsigned char modos[MAX_GPIO];
+static unsigned long escrituras = 0;
+
+static nodoAnalogico_t nodos[MAX_NODOS];
+static int cantNodos = 0;
+
+static struct timespec inicio;
+
+int wiringPiSetupGpio(void) {
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    return 0;
+}
+
+void pinMode(int pin, int modo) {
+    if (pin >= 0 && pin < MAX_GPIO)
+        modos[pin] = (unsigned char)modo;
+}
+
+void digitalWrite(int pin, int valor) {
+    if (pin >= 0 && pin < MAX_GPIO)
+        niveles[pin] = valor ? HIGH : LOW;
+    escrituras++;
+}
+
+int digitalRead(int pin) {
+    return (pin >= 0 && pin < MAX_GPIO) ? niveles[pin] : LOW;
+}
+
+int analogRead(int pin) {
+    for (int i = 0; i < cantNodos; i++)
+        if (pin >= nodos[i].base && pin < nodos[i].base + nodos[i].cantPines)
+            return nodos[i].leer(pin - nodos[i].base);
+    return 0;
+}
+
+unsigned int millis(void) {
+    struct timespec ahora;
+    clock_gettime(CLOCK_MONOTONIC, &ahora);
+    return (unsigned int)((ahora.tv_sec - inicio.tv_sec) * 1000 +
+                          (ahora.tv_nsec - inicio.tv_nsec) / 1000000);
+}
+
+void delay(unsigned int ms) {
+    struct timespec ts = { ms / 1000, (long)(ms % 1000) * 1000000L };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR)
+        ;
+}
+
+int sim_nodoAnalogico(int base, int cantPines, int (*leer)(int canal)) {
+    if (cantNodos >= MAX_NODOS)
+        return 1;
+    nodos[cantNodos].base = base;
+    nodos[cantNodos].cantPines = cantPines;
+    nodos[cantNodos].leer = leer;
+    cantNodos++;
+    return 0;
+}
+
+unsigned long sim_escriturasDigitales(void) {
+    return escrituras;
+}
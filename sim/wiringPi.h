@@ -0,0 +1,24 @@
+#ifndef WIRINGPI_H
+#define WIRINGPI_H
+
+// Reemplazo de wiringPi para compilar y correr sin la Raspberry
+// (cmake -DLUCES_SIMULADO=ON). Solo declara lo que usa el proyecto.
+
+#define INPUT  0
+#define OUTPUT 1
+#define LOW    0
+#define HIGH   1
+
+int  wiringPiSetupGpio(void);
+void pinMode(int pin, int modo);
+void digitalWrite(int pin, int valor);
+int  digitalRead(int pin);
+int  analogRead(int pin);
+unsigned int millis(void);
+void delay(unsigned int ms);
+
+// Extensiones del simulador
+int  sim_nodoAnalogico(int base, int cantPines, int (*leer)(int canal));
+unsigned long sim_escriturasDigitales(void);
+
+#endif
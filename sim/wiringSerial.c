@@ -0,0 +1,67 @@
+// wiringSerial.c (simulado)
+// En la PC no hay /dev/ttyAMA0: serialOpen() abre lo que diga LUCES_UART
+// (por ejemplo el esclavo de un PTY hecho con socat) y si no está, falla
+// igual que sin el UART conectado.
+#include "wiringSerial.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/ioctl.h>
+
+int serialOpen(const char *device, int baud) {
+    const char *ruta = getenv("LUCES_UART");
+    (void)device;
+    (void)baud;
+
+    if (!ruta)
+        return -1;
+
+    int fd = open(ruta, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+
+    // Modo crudo como deja wiringPi al puerto real
+    struct termios t;
+    if (tcgetattr(fd, &t) == 0) {
+        cfmakeraw(&t);
+        tcsetattr(fd, TCSANOW, &t);
+    }
+    return fd;
+}
+
+void serialClose(int fd) {
+    close(fd);
+}
+
+void serialFlush(int fd) {
+    tcflush(fd, TCIOFLUSH);
+}
+
+void serialPutchar(int fd, unsigned char c) {
+    if (write(fd, &c, 1) < 0) {
+        // igual que wiringPi: el error se ignora
+    }
+}
+
+void serialPuts(int fd, const char *s) {
+    if (write(fd, s, strlen(s)) < 0) {
+        // igual que wiringPi: el error se ignora
+    }
+}
+
+int serialDataAvail(int fd) {
+    int n;
+    if (ioctl(fd, FIONREAD, &n) == -1)
+        return -1;
+    return n;
+}
+
+int serialGetchar(int fd) {
+    unsigned char c;
+    if (read(fd, &c, 1) != 1)
+        return -1;
+    return c;
+}
@@ -0,0 +1,12 @@
+#ifndef WIRINGSERIAL_H
+#define WIRINGSERIAL_H
+
+int  serialOpen(const char *device, int baud);
+void serialClose(int fd);
+void serialFlush(int fd);
+void serialPutchar(int fd, unsigned char c);
+void serialPuts(int fd, const char *s);
+int  serialDataAvail(int fd);
+int  serialGetchar(int fd);
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef TABLAS_H
+#define TABLAS_H
+
+#include "motor.h"
+
+// Programas expandidos al compilar (tablas_generadas.c, lo escribe
+// herramientas/gentablas con los generadores de generadores.c), en el orden
+// del menú (SEC_*).
+extern const programa_t tablasGeneradas[];
+extern const int cantTablasGeneradas;
+
+#endif
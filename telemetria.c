@@ -0,0 +1,70 @@
+// telemetria.c
+// Segmento de telemetría (ver telemetria.h). Acá solo se crea y se suelta:
+// los contadores los escribe cada hilo directamente con tele_sumar().
+#include "telemetria.h"
+
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+static telemetria_t local;
+telemetria_t *tele = &local;
+
+static char nombreSegmento[64];
+
+uint64_t tele_ahoraNs(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+int tele_iniciar(const char *nombre) {
+    if (tele != &local)
+        return 0;
+    if (strlen(nombre) >= sizeof(nombreSegmento))
+        return 1;
+
+    int fd = shm_open(nombre, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return 1;
+
+    // Uno que quedó de una ejecución que no terminó bien arranca en cero
+    if (ftruncate(fd, 0) != 0 || ftruncate(fd, sizeof(telemetria_t)) != 0) {
+        close(fd);
+        shm_unlink(nombre);
+        return 1;
+    }
+
+    void *m = mmap(NULL, sizeof(telemetria_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) {
+        shm_unlink(nombre);
+        return 1;
+    }
+
+    telemetria_t *t = m;
+    t->version  = TELE_VERSION;
+    t->pid      = (int32_t)getpid();
+    t->tamanio  = sizeof(telemetria_t);
+    t->inicioNs = tele_ahoraNs();
+    atomic_thread_fence(memory_order_release);
+    t->magia    = TELE_MAGIA;   // ledstat espera a verla para confiar en el resto
+
+    strcpy(nombreSegmento, nombre);
+    tele = t;
+    return 0;
+}
+
+// Después de parar los hilos. Un ledstat que lo tenga abierto sigue viendo
+// los últimos valores; el nombre se borra para que no parezca vivo.
+void tele_cerrar(void) {
+    if (tele == &local)
+        return;
+
+    telemetria_t *t = tele;
+    tele = &local;
+    munmap(t, sizeof(*t));
+    shm_unlink(nombreSegmento);
+}
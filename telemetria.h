@@ -0,0 +1,102 @@
+#ifndef TELEMETRIA_H
+#define TELEMETRIA_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+// Telemetría del programa en un segmento de memoria compartida POSIX que
+// herramientas/ledstat lee en vivo. Cada hilo tiene su bloque y es el único
+// que lo escribe, así un contador es una carga y un store relajados (sin
+// lock ni instrucción atómica de lectura-modificación) y nunca una llamada
+// al sistema. Quien lee puede ver un histograma a medio actualizar en un
+// casillero, nunca un valor roto.
+//
+// Sin tele_iniciar() 'tele' apunta a un bloque local del proceso: los
+// caminos calientes escriben siempre sin preguntar.
+#define TELE_NOMBRE     "/luces.telemetria"
+#define TELE_MAGIA      0x454C4554u   // "TELE"
+#define TELE_VERSION    2
+#define TELE_CASILLEROS 16   // casillero b: [2^(b-1), 2^b) us; el 0 es < 1 us y el último junta el resto
+#define TELE_PERDIDO_US 1000 // un frame con más atraso que esto cuenta como vencimiento perdido
+
+typedef _Atomic uint64_t teleContador_t;
+
+typedef struct {
+    teleContador_t cuenta;
+    teleContador_t sumaUs;
+    teleContador_t maximoUs;
+    teleContador_t casilleros[TELE_CASILLEROS];
+} teleHistograma_t;
+
+// Hilo de salida (motor.c)
+typedef struct {
+    teleContador_t frames;             // pasos de secuencia que salieron
+    teleContador_t perdidos;           // con atraso > TELE_PERDIDO_US
+    teleContador_t escrituras;         // frames escritos al HAL fuera de BAM
+    teleContador_t ciclosBam;
+    teleContador_t comandos;           // recibidos de la interfaz
+    teleHistograma_t atraso;           // vencimiento -> paso aplicado
+    teleHistograma_t escritura;        // lo que tarda hal_escribirFrame()
+} teleSalida_t;
+
+// Hilo de la interfaz (reactor, menú, UART, protocolo, servidor de control)
+typedef struct {
+    teleContador_t despertares;        // vueltas del reactor
+    teleContador_t teclas;             // atendidas durante una secuencia
+    teleContador_t bytesEntrada;       // leídos del UART
+    teleContador_t bytesSalida;        // escritos al UART
+    teleContador_t bytesDescartados;   // que no entraron en la cola del UART
+    teleContador_t estadosColapsados;  // líneas de estado reemplazadas antes de salir
+    teleContador_t tramas;             // binarias (UART y control) ejecutadas
+    teleContador_t tramasDescartadas;  // con CRC malo o cortadas
+    teleHistograma_t entrada;          // despertar del reactor -> tecla aplicada
+} teleInterfaz_t;
+
+// Hilo muestreador del ADC (adc.c)
+typedef struct {
+    teleContador_t muestras;
+    teleContador_t cambios;            // que pasaron la histéresis
+    teleHistograma_t lectura;          // lo que tarda analogRead() por I2C
+} teleAdc_t;
+
+typedef struct {
+    uint32_t magia;
+    uint32_t version;
+    int32_t  pid;
+    uint32_t tamanio;                  // sizeof(telemetria_t)
+    uint64_t inicioNs;                 // CLOCK_MONOTONIC al crear el segmento
+
+    // Cada bloque en su propia línea de caché: los hilos no se pisan
+    _Alignas(64) teleSalida_t salida;
+    _Alignas(64) teleInterfaz_t interfaz;
+    _Alignas(64) teleAdc_t adc;
+} telemetria_t;
+
+extern telemetria_t *tele;
+
+// Crea el segmento (antes de arrancar los hilos). 1 si no se pudo: se sigue
+// con el bloque local.
+int  tele_iniciar(const char *nombre);
+void tele_cerrar(void);
+
+uint64_t tele_ahoraNs(void);
+
+// Un solo escritor por contador
+static inline void tele_sumar(teleContador_t *c, uint64_t n) {
+    atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+static inline void tele_registrar(teleHistograma_t *h, long us) {
+    uint64_t v = us > 0 ? (uint64_t)us : 0;
+    int b = v ? 64 - __builtin_clzll(v) : 0;
+
+    if (b >= TELE_CASILLEROS)
+        b = TELE_CASILLEROS - 1;
+    tele_sumar(&h->casilleros[b], 1);
+    tele_sumar(&h->cuenta, 1);
+    tele_sumar(&h->sumaUs, v);
+    if (v > atomic_load_explicit(&h->maximoUs, memory_order_relaxed))
+        atomic_store_explicit(&h->maximoUs, v, memory_order_relaxed);
+}
+
+#endif
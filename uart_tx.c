@@ -0,0 +1,165 @@
+// uart_tx.c
+// Salida hacia el UART sin bloquear: los textos se encolan en un anillo y se
+// mandan juntos en un solo writev() cada vez que la interfaz se va a dormir en
+// el reactor. Las líneas de estado (las que empiezan con '\r' y se redibujan)
+// ocupan un lugar aparte: si todavía no salieron, la nueva reemplaza a la vieja.
+#include "uart_tx.h"
+#include "reactor.h"
+#include "telemetria.h"
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#define LARGO_ESTADO 160
+
+static int fdUart = -1;
+
+static char anillo[UART_TX_CAPACIDAD];
+static size_t inicio = 0;     // primer byte pendiente
+static size_t ocupados = 0;
+
+// Línea de estado pendiente: solo sale la más reciente
+static char estado[LARGO_ESTADO];
+static size_t largoEstado = 0;
+static size_t enviadoEstado = 0;   // >0 si ya salió una parte
+
+static void encolar(const char *datos, size_t n) {
+    if (n > UART_TX_CAPACIDAD - ocupados) {
+        // Sin lugar: se descarta el texto entero en vez de esperar al UART
+        tele_sumar(&tele->interfaz.bytesDescartados, n);
+        return;
+    }
+
+    size_t fin = (inicio + ocupados) % UART_TX_CAPACIDAD;
+    size_t primero = UART_TX_CAPACIDAD - fin;
+    if (primero > n)
+        primero = n;
+
+    memcpy(anillo + fin, datos, primero);
+    memcpy(anillo, datos + primero, n - primero);
+    ocupados += n;
+}
+
+// Pasa lo que queda de la línea de estado al anillo para respetar el orden
+static void fijarEstado(void) {
+    if (largoEstado > enviadoEstado)
+        encolar(estado + enviadoEstado, largoEstado - enviadoEstado);
+    largoEstado = enviadoEstado = 0;
+}
+
+void uart_iniciar(int fd) {
+    fdUart = fd;
+    inicio = ocupados = 0;
+    largoEstado = enviadoEstado = 0;
+
+    if (fd >= 0) {
+        int flags = fcntl(fd, F_GETFL, 0);
+        if (flags != -1)
+            fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+        reactor_antesDeEsperar(uart_vaciar);
+    }
+}
+
+void uart_escribir(const char *datos, size_t n) {
+    if (fdUart < 0 || n == 0)
+        return;
+
+    if (largoEstado)
+        fijarEstado();
+    encolar(datos, n);
+}
+
+void uart_puts(const char *s) {
+    uart_escribir(s, strlen(s));
+}
+
+void uart_putchar(char c) {
+    uart_escribir(&c, 1);
+}
+
+// Línea de estado que reemplaza a la anterior si esta todavía no salió
+void uart_estado(const char *linea) {
+    if (fdUart < 0)
+        return;
+
+    size_t n = strlen(linea);
+    if (n > LARGO_ESTADO)
+        n = LARGO_ESTADO;
+
+    if (largoEstado) {
+        if (enviadoEstado == 0)   // la anterior nunca llegó a salir
+            tele_sumar(&tele->interfaz.estadosColapsados, 1);
+        else
+            fijarEstado();    // ya salió en parte: hay que terminarla
+    }
+
+    memcpy(estado, linea, n);
+    largoEstado = n;
+    enviadoEstado = 0;
+}
+
+// Manda todo lo pendiente en un solo writev() sin bloquear
+void uart_vaciar(void) {
+    if (fdUart < 0)
+        return;
+
+    struct iovec iov[3];
+    int cant = 0;
+
+    size_t primero = UART_TX_CAPACIDAD - inicio;
+    if (primero > ocupados)
+        primero = ocupados;
+    if (primero) {
+        iov[cant].iov_base = anillo + inicio;
+        iov[cant++].iov_len = primero;
+    }
+    if (ocupados > primero) {
+        iov[cant].iov_base = anillo;
+        iov[cant++].iov_len = ocupados - primero;
+    }
+    if (largoEstado > enviadoEstado) {
+        iov[cant].iov_base = estado + enviadoEstado;
+        iov[cant++].iov_len = largoEstado - enviadoEstado;
+    }
+
+    if (cant > 0) {
+        ssize_t n = writev(fdUart, iov, cant);
+
+        if (n > 0) {
+            size_t escrito = (size_t)n;
+            tele_sumar(&tele->interfaz.bytesSalida, escrito);
+
+            size_t delAnillo = escrito < ocupados ? escrito : ocupados;
+            inicio = (inicio + delAnillo) % UART_TX_CAPACIDAD;
+            ocupados -= delAnillo;
+            enviadoEstado += escrito - delAnillo;
+
+            if (enviadoEstado == largoEstado)
+                largoEstado = enviadoEstado = 0;
+        } else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            // UART caído: se descarta lo pendiente para no crecer sin límite
+            tele_sumar(&tele->interfaz.bytesDescartados, ocupados + (largoEstado - enviadoEstado));
+            ocupados = 0;
+            largoEstado = enviadoEstado = 0;
+        }
+    }
+
+    reactor_salidaPendiente(ocupados > 0 || largoEstado > 0);
+}
+
+// Espera (acotado) a que salga todo; solo para la salida del programa
+void uart_drenar(int timeout_ms) {
+    struct pollfd pfd = { .fd = fdUart, .events = POLLOUT };
+
+    while (fdUart >= 0 && (ocupados > 0 || largoEstado > 0)) {
+        uart_vaciar();
+        if (ocupados == 0 && largoEstado == 0)
+            break;
+        if (poll(&pfd, 1, timeout_ms) <= 0)
+            break;
+    }
+}
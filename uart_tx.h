@@ -0,0 +1,19 @@
+#ifndef UART_TX_H
+#define UART_TX_H
+
+#include <stddef.h>
+
+#define UART_TX_CAPACIDAD 8192   // bytes en cola para el UART
+
+void uart_iniciar(int fd);
+void uart_escribir(const char *datos, size_t n);
+void uart_puts(const char *s);
+void uart_putchar(char c);
+void uart_estado(const char *linea);
+void uart_vaciar(void);
+void uart_drenar(int timeout_ms);
+
+// Los contadores (bytes enviados y descartados, estados colapsados) van a
+// la telemetría del hilo de interfaz (telemetria.h)
+
+#endif